@@ -17,6 +17,14 @@
 
 #include <float.h>
 
+#if defined(_M_IX86) || defined(_M_X64)
+#include <emmintrin.h>
+#define SWAP_SSE2
+#elif defined(_M_ARM64)
+#include <arm64_neon.h>
+#define SWAP_NEON
+#endif
+
 #include "SwapAPO.h"
 
 #pragma AVRT_CODE_BEGIN
@@ -57,6 +65,38 @@ void ProcessSwap(
     ATLASSERT( IS_VALID_TYPED_READ_POINTER(pf32InputFrames) );
     ATLASSERT( IS_VALID_TYPED_WRITE_POINTER(pf32OutputFrames) );
 
+    // With an even channel count every frame is made of whole stereo pairs,
+    // so the buffer can be swapped as one run of pairs, four samples at a time.
+    if ((u32SamplesPerFrame & 1) == 0)
+    {
+        UINT32 u32SampleCount = u32ValidFrameCount * u32SamplesPerFrame;
+        UINT32 u32VectorCount = u32SampleCount & ~3;
+
+#if defined(SWAP_SSE2)
+        for (u32SampleIndex = 0; u32SampleIndex < u32VectorCount; u32SampleIndex += 4)
+        {
+            __m128 v = _mm_loadu_ps(pf32InputFrames + u32SampleIndex);
+            _mm_storeu_ps(pf32OutputFrames + u32SampleIndex, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1)));
+        }
+#elif defined(SWAP_NEON)
+        for (u32SampleIndex = 0; u32SampleIndex < u32VectorCount; u32SampleIndex += 4)
+        {
+            vst1q_f32(pf32OutputFrames + u32SampleIndex, vrev64q_f32(vld1q_f32(pf32InputFrames + u32SampleIndex)));
+        }
+#else
+        u32VectorCount = 0;
+#endif
+
+        for (u32SampleIndex = u32VectorCount; u32SampleIndex < u32SampleCount; u32SampleIndex += 2)
+        {
+            fSwap32 = pf32InputFrames[u32SampleIndex];
+            pf32OutputFrames[u32SampleIndex] = pf32InputFrames[u32SampleIndex + 1];
+            pf32OutputFrames[u32SampleIndex + 1] = fSwap32;
+        }
+
+        return;
+    }
+
     // loop through samples
     while (u32ValidFrameCount--)
     {
@@ -90,6 +130,56 @@ void ProcessSwapScale(
     ATLASSERT( IS_VALID_TYPED_READ_POINTER(pf32InputFrames) );
     ATLASSERT( IS_VALID_TYPED_READ_POINTER(pf32OutputFrames) );
 
+#if defined(SWAP_SSE2) || defined(SWAP_NEON)
+    // Stereo frames repeat the two coefficients every two samples, and channel
+    // counts that are a multiple of four line up with the vector width, so
+    // both can be done four samples at a time. Each output is still a single
+    // multiply of the same operands, so the result matches the scalar loop.
+    if (u32SamplesPerFrame == 2 || (u32SamplesPerFrame & 3) == 0)
+    {
+        UINT32 u32SampleCount = u32ValidFrameCount * u32SamplesPerFrame;
+        UINT32 u32Period = (u32SamplesPerFrame == 2) ? 4 : u32SamplesPerFrame;
+        UINT32 u32VectorCount = u32SampleCount - (u32SampleCount % u32Period);
+        UINT32 u32Offset;
+        FLOAT32 af32Pair[4];
+        const FLOAT32 *pf32Coeffs = pf32Coefficients;
+
+        if (u32SamplesPerFrame == 2)
+        {
+            af32Pair[0] = af32Pair[2] = pf32Coefficients[0];
+            af32Pair[1] = af32Pair[3] = pf32Coefficients[1];
+            pf32Coeffs = af32Pair;
+        }
+
+        for (u32SampleIndex = 0; u32SampleIndex < u32VectorCount; u32SampleIndex += u32Period)
+        {
+            for (u32Offset = 0; u32Offset < u32Period; u32Offset += 4)
+            {
+#if defined(SWAP_SSE2)
+                __m128 v = _mm_loadu_ps(pf32InputFrames + u32SampleIndex + u32Offset);
+                v = _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 3, 0, 1));
+                _mm_storeu_ps(pf32OutputFrames + u32SampleIndex + u32Offset,
+                              _mm_mul_ps(v, _mm_loadu_ps(pf32Coeffs + u32Offset)));
+#else
+                float32x4_t v = vrev64q_f32(vld1q_f32(pf32InputFrames + u32SampleIndex + u32Offset));
+                vst1q_f32(pf32OutputFrames + u32SampleIndex + u32Offset,
+                          vmulq_f32(v, vld1q_f32(pf32Coeffs + u32Offset)));
+#endif
+            }
+        }
+
+        // at most one stereo frame is left over
+        for (; u32SampleIndex < u32SampleCount; u32SampleIndex += 2)
+        {
+            fSwap32 = pf32InputFrames[u32SampleIndex];
+            pf32OutputFrames[u32SampleIndex] = pf32InputFrames[u32SampleIndex + 1] * pf32Coefficients[0];
+            pf32OutputFrames[u32SampleIndex + 1] = fSwap32 * pf32Coefficients[1];
+        }
+
+        return;
+    }
+#endif
+
     // loop through samples
     while (u32ValidFrameCount--)
     {
@@ -83,6 +83,7 @@ Abstract:
 #define TAG_IRP_CONTEXT_LITE    'lidC'      //  Irp Context lite
 #define TAG_MCB_ARRAY           'amdC'      //  Mcb array
 #define TAG_PATH_ENTRY_NAME     'nPdC'      //  CdName in path entry
+#define TAG_PATH_INDEX          'iPdC'      //  Path table index
 #define TAG_PREFIX_ENTRY        'epdC'      //  Prefix Entry
 #define TAG_PREFIX_NAME         'npdC'      //  Prefix Entry name
 #define TAG_SPANNING_PATH_TABLE 'psdC'      //  Buffer for spanning path table
@@ -556,6 +556,15 @@ typedef struct _VCB {
     struct _FCB *RootIndexFcb;
     struct _FCB *PathTableFcb;
 
+    //
+    //  Index of the path table, built on the first path table search.  This
+    //  is NULL until the index is built, or if the path table is not indexed.
+    //  PathIndexState is one of the PATH_INDEX_STATE values.
+    //
+
+    struct _PATH_INDEX *PathIndex;
+    __volatile LONG PathIndexState;
+
     //
     //  Location of current session and offset of volume descriptors.
     //
@@ -1526,6 +1535,65 @@ typedef struct _COMPOUND_PATH_ENTRY {
 } COMPOUND_PATH_ENTRY;
 typedef COMPOUND_PATH_ENTRY *PCOMPOUND_PATH_ENTRY;
 
+
+//
+//  Path table index.  This is a hash table of every entry in the path table
+//  keyed by the parent ordinal and the upcased directory name.  It is built
+//  the first time the path table is searched and lets CdFindPathEntry go
+//  straight to the few entries which could match, rather than walking the
+//  path table from the parent.  Every candidate is still checked against
+//  the path table itself.
+//
+//  The entries are stored in path table order, so the ordinal of an entry is
+//  its index plus one.  The buckets and the entries follow the header in the
+//  same pool block.
+//
+
+typedef struct _PATH_INDEX_ENTRY {
+
+    ULONG PathTableOffset;
+    ULONG ParentOrdinal;
+    ULONG NameHash;
+
+    //
+    //  Index of the next entry in this bucket, in ascending ordinal order.
+    //
+
+    ULONG Next;
+
+} PATH_INDEX_ENTRY;
+typedef PATH_INDEX_ENTRY *PPATH_INDEX_ENTRY;
+
+typedef struct _PATH_INDEX {
+
+    ULONG EntryCount;
+    ULONG BucketCount;
+
+    PULONG Buckets;
+    PPATH_INDEX_ENTRY Entries;
+
+} PATH_INDEX;
+typedef PATH_INDEX *PPATH_INDEX;
+
+#define PATH_INDEX_NIL                          ((ULONG) -1)
+
+//
+//  Path tables shorter than this are cheap enough to walk.  Path tables
+//  larger than this are not indexed, to bound the memory used by the index.
+//
+
+#define PATH_INDEX_MINIMUM_SIZE                 (2 * SECTOR_SIZE)
+#define PATH_INDEX_MAXIMUM_SIZE                 (0x80000)
+
+//
+//  States of the path table index in the Vcb.
+//
+
+#define PATH_INDEX_STATE_NOT_BUILT              (0)
+#define PATH_INDEX_STATE_BUILDING               (1)
+#define PATH_INDEX_STATE_BUILT                  (2)
+#define PATH_INDEX_STATE_UNAVAILABLE            (3)
+
 
 //
 //  The following is used for enumerating through a directory via the
@@ -90,6 +90,8 @@ main (argc, argv)
         doit( VCB, VolumeDasdFcb );
         doit( VCB, RootIndexFcb );
         doit( VCB, PathTableFcb );
+        doit( VCB, PathIndex );
+        doit( VCB, PathIndexState );
         doit( VCB, BaseSector );
         doit( VCB, VdSectorOffset );
         doit( VCB, PrimaryVdSectorOffset );
@@ -70,6 +70,14 @@ Abstract:
             to convert to little endian.  We assume that directories
             don't have version numbers.
 
+    Path Table Index:
+
+        The first search of the path table walks the whole table once and
+        builds a hash table of the entries keyed by parent ordinal and
+        upcased name.  Later searches only look at the path table entries
+        whose key matches the name being looked for.  If the index can't be
+        built we fall back to walking the path table from the parent.
+
 
 --*/
 
@@ -118,8 +126,45 @@ CdUpdatePathEntryFromRawPathEntry (
     _Out_ PPATH_ENTRY PathEntry
     );
 
+VOID
+CdBuildPathIndex (
+    _In_ PIRP_CONTEXT IrpContext,
+    _Inout_ PVCB Vcb
+    );
+
+_Success_(return != FALSE)
+BOOLEAN
+CdFindPathEntryInIndex (
+    _In_ PIRP_CONTEXT IrpContext,
+    _In_ PPATH_INDEX PathIndex,
+    _In_ PFCB ParentFcb,
+    _In_ PCD_NAME DirName,
+    _In_ BOOLEAN IgnoreCase,
+    _Inout_ PCOMPOUND_PATH_ENTRY CompoundPathEntry
+    );
+
+ULONG
+CdHashPathIndexName (
+    _In_ PUNICODE_STRING Name
+    );
+
+//
+//  ULONG
+//  CdPathIndexBucket (
+//      _In_ PPATH_INDEX PathIndex,
+//      _In_ ULONG ParentOrdinal,
+//      _In_ ULONG NameHash
+//      );
+//
+
+#define CdPathIndexBucket(PI, PO, NH)   \
+    ((((PO) * 0x9e3779b1) ^ (NH)) & ((PI)->BucketCount - 1))
+
 #ifdef ALLOC_PRAGMA
+#pragma alloc_text(PAGE, CdBuildPathIndex)
 #pragma alloc_text(PAGE, CdFindPathEntry)
+#pragma alloc_text(PAGE, CdFindPathEntryInIndex)
+#pragma alloc_text(PAGE, CdHashPathIndexName)
 #pragma alloc_text(PAGE, CdLookupPathEntry)
 #pragma alloc_text(PAGE, CdLookupNextPathEntry)
 #pragma alloc_text(PAGE, CdMapPathTableBlock)
@@ -341,6 +386,9 @@ Return Value:
     ULONG StartingOffset;
     ULONG StartingOrdinal;
 
+    PVCB Vcb = ParentFcb->Vcb;
+    PPATH_INDEX PathIndex;
+
     PAGED_CODE();
 
     //
@@ -367,6 +415,29 @@ Return Value:
 		CdRaiseStatus( IrpContext, STATUS_DISK_CORRUPT_ERROR );
 	}
 
+    //
+    //  Build the path table index if nobody has tried yet, and use it if
+    //  we have one.
+    //
+
+    if ((Vcb->PathIndex == NULL) &&
+        (Vcb->PathIndexState == PATH_INDEX_STATE_NOT_BUILT)) {
+
+        CdBuildPathIndex( IrpContext, Vcb );
+    }
+
+    PathIndex = Vcb->PathIndex;
+
+    if (PathIndex != NULL) {
+
+        return CdFindPathEntryInIndex( IrpContext,
+                                       PathIndex,
+                                       ParentFcb,
+                                       DirName,
+                                       IgnoreCase,
+                                       CompoundPathEntry );
+    }
+
     CdLockFcb( IrpContext, ParentFcb );
 
     if (ParentFcb->ChildPathTableOffset != 0) {
@@ -475,6 +546,350 @@ Return Value:
     return Found;
 }
 
+
+//
+//  Local support routine
+//
+
+VOID
+CdBuildPathIndex (
+    _In_ PIRP_CONTEXT IrpContext,
+    _Inout_ PVCB Vcb
+    )
+
+/*++
+
+Routine Description:
+
+    This routine is called to build the path table index for a volume.  We
+    walk the entire path table once and hash the parent ordinal and upcased
+    name of every entry.  Only one thread builds the index, any other thread
+    searching the path table meanwhile walks it as before.
+
+    The index is optional.  If the path table is too small or too large to
+    be worth indexing, or we can't allocate the pool, or the path table is
+    corrupt, we mark the index unavailable and leave it to the path table
+    walk to find (or fail to find) the entries.
+
+Arguments:
+
+    Vcb - Vcb for the volume.
+
+Return Value:
+
+    None.  This routine may raise if reading the path table fails, in which
+    case we will try again on the next search.
+
+--*/
+
+{
+    COMPOUND_PATH_ENTRY CompoundPathEntry;
+    PPATH_INDEX PathIndex = NULL;
+    PPATH_INDEX_ENTRY IndexEntry;
+
+    ULONG PathTableLength;
+    ULONG MaximumEntries;
+    ULONG BucketCount;
+    ULONG Entry;
+    ULONG Bucket;
+
+    LONG NewState = PATH_INDEX_STATE_UNAVAILABLE;
+
+    PAGED_CODE();
+
+    //
+    //  Claim the right to build the index.
+    //
+
+    if (InterlockedCompareExchange( &Vcb->PathIndexState,
+                                    PATH_INDEX_STATE_BUILDING,
+                                    PATH_INDEX_STATE_NOT_BUILT ) != PATH_INDEX_STATE_NOT_BUILT) {
+
+        return;
+    }
+
+    CdInitializeCompoundPathEntry( IrpContext, &CompoundPathEntry );
+
+    try {
+
+        try {
+
+            PathTableLength = (ULONG) (Vcb->PathTableFcb->FileSize.QuadPart -
+                                       Vcb->PathTableFcb->StreamOffset);
+
+            if ((PathTableLength < PATH_INDEX_MINIMUM_SIZE) ||
+                (PathTableLength > PATH_INDEX_MAXIMUM_SIZE)) {
+
+                leave;
+            }
+
+            //
+            //  Every path table entry is at least MIN_RAW_PATH_ENTRY_LEN bytes
+            //  long, which bounds the number of entries.  We want about two
+            //  buckets per entry for typical names.
+            //
+
+            MaximumEntries = PathTableLength / MIN_RAW_PATH_ENTRY_LEN + 1;
+
+            for (BucketCount = 64;
+                 BucketCount < MaximumEntries;
+                 BucketCount *= 2) {
+
+                NOTHING;
+            }
+
+            PathIndex = ExAllocatePoolWithTag( CdPagedPool,
+                                               sizeof( PATH_INDEX ) +
+                                               BucketCount * sizeof( ULONG ) +
+                                               MaximumEntries * sizeof( PATH_INDEX_ENTRY ),
+                                               TAG_PATH_INDEX );
+
+            if (PathIndex == NULL) {
+
+                leave;
+            }
+
+            PathIndex->EntryCount = 0;
+            PathIndex->BucketCount = BucketCount;
+            PathIndex->Buckets = Add2Ptr( PathIndex, sizeof( PATH_INDEX ), PULONG );
+            PathIndex->Entries = Add2Ptr( PathIndex->Buckets,
+                                          BucketCount * sizeof( ULONG ),
+                                          PPATH_INDEX_ENTRY );
+
+            //
+            //  Walk the path table from the root, remembering the offset, parent
+            //  and name hash of each entry.
+            //
+
+            CdLookupPathEntry( IrpContext,
+                               Vcb->PathTableFcb->StreamOffset,
+                               1,
+                               FALSE,
+                               &CompoundPathEntry );
+
+            do {
+
+                if (PathIndex->EntryCount == MaximumEntries) {
+
+                    CdFreePool( &PathIndex );
+                    leave;
+                }
+
+                CdUpdatePathEntryName( IrpContext, &CompoundPathEntry.PathEntry, FALSE );
+
+                IndexEntry = &PathIndex->Entries[PathIndex->EntryCount];
+
+                IndexEntry->PathTableOffset = CompoundPathEntry.PathEntry.PathTableOffset;
+                IndexEntry->ParentOrdinal = CompoundPathEntry.PathEntry.ParentOrdinal;
+                IndexEntry->NameHash = CdHashPathIndexName( &CompoundPathEntry.PathEntry.CdDirName.FileName );
+
+                PathIndex->EntryCount += 1;
+
+            } while (CdLookupNextPathEntry( IrpContext,
+                                            &CompoundPathEntry.PathContext,
+                                            &CompoundPathEntry.PathEntry ));
+
+            //
+            //  Now hash the entries.  We insert at the head of each bucket from
+            //  the end of the path table, so each bucket is in ordinal order and
+            //  the first match is the one a path table walk would find.
+            //
+
+            RtlFillMemory( PathIndex->Buckets, BucketCount * sizeof( ULONG ), 0xff );
+
+            for (Entry = PathIndex->EntryCount; Entry-- != 0; ) {
+
+                IndexEntry = &PathIndex->Entries[Entry];
+
+                Bucket = CdPathIndexBucket( PathIndex,
+                                            IndexEntry->ParentOrdinal,
+                                            IndexEntry->NameHash );
+
+                IndexEntry->Next = PathIndex->Buckets[Bucket];
+                PathIndex->Buckets[Bucket] = Entry;
+            }
+
+            //
+            //  Let everyone else see the index.
+            //
+
+            InterlockedExchangePointer( (PVOID *) &Vcb->PathIndex, PathIndex );
+            PathIndex = NULL;
+
+            NewState = PATH_INDEX_STATE_BUILT;
+
+        } finally {
+
+            CdCleanupCompoundPathEntry( IrpContext, &CompoundPathEntry );
+
+            CdFreePool( &PathIndex );
+
+            //
+            //  If we raised then let the next search try again, unless we
+            //  decide below that the path table is corrupt.
+            //
+
+            if (AbnormalTermination()) {
+
+                NewState = PATH_INDEX_STATE_NOT_BUILT;
+            }
+
+            InterlockedExchange( &Vcb->PathIndexState, NewState );
+        }
+
+#pragma warning(suppress: 6320)
+    } except ((GetExceptionCode() == STATUS_DISK_CORRUPT_ERROR) ?
+              EXCEPTION_EXECUTE_HANDLER :
+              EXCEPTION_CONTINUE_SEARCH) {
+
+        //
+        //  A corrupt entry somewhere in the path table only fails the searches
+        //  which reach it.  Don't index this path table, so that searches of
+        //  the rest of it keep working.
+        //
+
+        IrpContext->ExceptionStatus = STATUS_SUCCESS;
+
+        InterlockedExchange( &Vcb->PathIndexState, PATH_INDEX_STATE_UNAVAILABLE );
+    }
+}
+
+
+//
+//  Local support routine
+//
+
+_Success_(return != FALSE)
+BOOLEAN
+CdFindPathEntryInIndex (
+    _In_ PIRP_CONTEXT IrpContext,
+    _In_ PPATH_INDEX PathIndex,
+    _In_ PFCB ParentFcb,
+    _In_ PCD_NAME DirName,
+    _In_ BOOLEAN IgnoreCase,
+    _Inout_ PCOMPOUND_PATH_ENTRY CompoundPathEntry
+    )
+
+/*++
+
+Routine Description:
+
+    This routine is the path table index version of CdFindPathEntry.  We look
+    at each path table entry in the bucket for this parent and name, and
+    check the names exactly as the path table walk does.
+
+Arguments:
+
+    PathIndex - The path table index for this volume.
+
+    ParentFcb - This is the directory we are examining.
+
+    DirName - This is the name we are searching for.  This name will not contain wildcard
+        characters.  The name will also not have a version string.
+
+    IgnoreCase - Indicates if this search is exact or ignore case.
+
+    CompoundPathEntry - Complete path table enumeration structure.  We will have initialized
+        it for the search on entry.  This will be positioned at the matching name if found.
+
+Return Value:
+
+    BOOLEAN - TRUE if matching entry found, FALSE otherwise.
+
+--*/
+
+{
+    PPATH_INDEX_ENTRY IndexEntry;
+    ULONG NameHash;
+    ULONG Entry;
+
+    PAGED_CODE();
+
+    NameHash = CdHashPathIndexName( &DirName->FileName );
+
+    for (Entry = PathIndex->Buckets[ CdPathIndexBucket( PathIndex, ParentFcb->Ordinal, NameHash ) ];
+         Entry != PATH_INDEX_NIL;
+         Entry = IndexEntry->Next) {
+
+        IndexEntry = &PathIndex->Entries[Entry];
+
+        if ((IndexEntry->ParentOrdinal != ParentFcb->Ordinal) ||
+            (IndexEntry->NameHash != NameHash)) {
+
+            continue;
+        }
+
+        //
+        //  Position the enumeration at this entry.  We start over with a clean
+        //  context each time since we may move backwards in the path table.
+        //
+
+        CdCleanupCompoundPathEntry( IrpContext, CompoundPathEntry );
+        CdInitializeCompoundPathEntry( IrpContext, CompoundPathEntry );
+
+        CdLookupPathEntry( IrpContext,
+                           IndexEntry->PathTableOffset,
+                           Entry + 1,
+                           FALSE,
+                           CompoundPathEntry );
+
+        CdUpdatePathEntryName( IrpContext, &CompoundPathEntry->PathEntry, IgnoreCase );
+
+        if (CdIsNameInExpression( IrpContext,
+                                  &CompoundPathEntry->PathEntry.CdCaseDirName,
+                                  DirName,
+                                  0,
+                                  FALSE )) {
+
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+
+//
+//  Local support routine
+//
+
+ULONG
+CdHashPathIndexName (
+    _In_ PUNICODE_STRING Name
+    )
+
+/*++
+
+Routine Description:
+
+    This routine computes the path table index hash of a directory name.  The
+    name is upcased as we go so an exact and an ignore case search of the same
+    name will hash alike.
+
+Arguments:
+
+    Name - The directory name.
+
+Return Value:
+
+    ULONG - The hash value.
+
+--*/
+
+{
+    ULONG Hash = 2166136261;
+    ULONG Index;
+
+    PAGED_CODE();
+
+    for (Index = 0; Index < Name->Length / sizeof( WCHAR ); Index++) {
+
+        Hash = (Hash ^ RtlUpcaseUnicodeChar( Name->Buffer[Index] )) * 16777619;
+    }
+
+    return Hash;
+}
+
 
 //
 //  Local support routine
@@ -956,6 +956,12 @@ Return Value:
 
     CdFreePool( &Vcb->CdromToc );
 
+    //
+    //  Delete the path table index if present.
+    //
+
+    CdFreePool( &Vcb->PathIndex );
+
     //
     //  Uninitialize the notify structures.
     //
@@ -28,6 +28,7 @@ Abstract:
 #define Dbg                              (DEBUG_TRACE_ALLOCSUP)
 
 #define FatMin(a, b)    ((a) < (b) ? (a) : (b))
+#define FatMax(a, b)    ((a) > (b) ? (a) : (b))
 
 //
 //  Define prefetch page count for the FAT
@@ -62,6 +63,11 @@ FatLogOf(
     IN ULONG Value
     );
 
+VOID
+FatBuildWindowSummary (
+    IN PVCB Vcb
+    );
+
 //
 //  Note that the KdPrint below will ONLY fire when the assert does. Leave it
 //  alone.
@@ -255,6 +261,7 @@ FatLogOf(
 #ifdef ALLOC_PRAGMA
 #pragma alloc_text(PAGE, FatAddFileAllocation)
 #pragma alloc_text(PAGE, FatAllocateDiskSpace)
+#pragma alloc_text(PAGE, FatBuildWindowSummary)
 #pragma alloc_text(PAGE, FatDeallocateDiskSpace)
 #pragma alloc_text(PAGE, FatExamineFatEntries)
 #pragma alloc_text(PAGE, FatInterpretClusterType)
@@ -272,10 +279,186 @@ FatLogOf(
 #endif
 
 
+INLINE
+VOID
+FatUpdateWindowSummary (
+    IN PVCB Vcb,
+    IN PFAT_WINDOW Window,
+    IN BOOLEAN ClustersFreed
+    )
+
+/*++
+
+Routine Description:
+
+    This routine propagates a change in a window's free cluster count up
+    the window summary tree.  Allocation can only shrink the longest free
+    run of a window, so the run hint is clipped to the new free count.
+    Freeing clusters may join runs we know nothing about, so in that case
+    the hint falls back to the free count, which is always a safe bound.
+
+    The caller must hold the free cluster bitmap mutex.
+
+Arguments:
+
+    Vcb - Supplies the Vcb for the volume
+
+    Window - Supplies the window whose ClustersFree has just changed
+
+    ClustersFreed - Indicates if clusters were returned to the window
+
+Return Value:
+
+    None
+
+--*/
+
+{
+    PFAT_WINDOW_SUMMARY Summary = Vcb->WindowSummary;
+    PFAT_WINDOW_SUMMARY Node;
+    ULONG Index;
+
+    if (ClustersFreed ||
+        (Window->LongestRunHint > Window->ClustersFree)) {
+
+        Window->LongestRunHint = Window->ClustersFree;
+    }
+
+    if (Summary == NULL) {
+
+        return;
+    }
+
+    Index = Vcb->WindowSummaryLeaves + (ULONG)(Window - Vcb->Windows);
+    Node = &Summary[Index];
+
+    if (Window->ClustersFree == MAX_CLUSTER_BITMAP_SIZE) {
+
+        Node->MaxClustersFree = 0;
+        Node->MaxRunHint = 0;
+        Node->EmptyWindows = 1;
+
+    } else {
+
+        Node->MaxClustersFree = Window->ClustersFree;
+        Node->MaxRunHint = Window->LongestRunHint;
+        Node->EmptyWindows = 0;
+    }
+
+    for (Index >>= 1; Index != 0; Index >>= 1) {
+
+        PFAT_WINDOW_SUMMARY Left = &Summary[Index * 2];
+        PFAT_WINDOW_SUMMARY Right = Left + 1;
+
+        Node = &Summary[Index];
+
+        Node->MaxClustersFree = FatMax( Left->MaxClustersFree, Right->MaxClustersFree );
+        Node->MaxRunHint = FatMax( Left->MaxRunHint, Right->MaxRunHint );
+        Node->EmptyWindows = Left->EmptyWindows + Right->EmptyWindows;
+    }
+}
+
+
+VOID
+FatBuildWindowSummary (
+    IN PVCB Vcb
+    )
+
+/*++
+
+Routine Description:
+
+    This routine (re)builds the window summary tree from the window array.
+    It is called once the initial FAT32 scan has filled in the free counts.
+
+Arguments:
+
+    Vcb - Supplies the Vcb for the volume
+
+Return Value:
+
+    None
+
+--*/
+
+{
+    ULONG Index;
+
+    PAGED_CODE();
+
+    NT_ASSERT( Vcb->WindowSummary != NULL );
+
+    RtlZeroMemory( Vcb->WindowSummary,
+                   2 * Vcb->WindowSummaryLeaves * sizeof(FAT_WINDOW_SUMMARY) );
+
+    for (Index = 0; Index < Vcb->NumberOfWindows; Index++) {
+
+        FatUpdateWindowSummary( Vcb, &Vcb->Windows[Index], FALSE );
+    }
+}
+
+
+INLINE
+ULONG
+FatFindFirstWindow (
+    IN PVCB Vcb,
+    IN ULONG FieldOffset,
+    IN ULONG Threshold
+    )
+
+/*++
+
+Routine Description:
+
+    This routine descends the window summary tree to find the first (lowest
+    numbered) window whose summary field at FieldOffset is at least Threshold.
+
+Arguments:
+
+    Vcb - Supplies the Vcb for the volume
+
+    FieldOffset - Supplies the offset of the ULONG field in FAT_WINDOW_SUMMARY
+
+    Threshold - Supplies the value the field must reach
+
+Return Value:
+
+    The window number, or -1 if no window qualifies.
+
+--*/
+
+{
+    PFAT_WINDOW_SUMMARY Summary = Vcb->WindowSummary;
+    ULONG Node = 1;
+
+#define SummaryField(N) (*(PULONG)((PUCHAR)&Summary[(N)] + FieldOffset))
+
+    if (SummaryField( 1 ) < Threshold) {
+
+        return (ULONG)-1;
+    }
+
+    while (Node < Vcb->WindowSummaryLeaves) {
+
+        Node *= 2;
+
+        if (SummaryField( Node ) < Threshold) {
+
+            Node += 1;
+        }
+    }
+
+#undef SummaryField
+
+    return Node - Vcb->WindowSummaryLeaves;
+}
+
+
 INLINE
 ULONG
 FatSelectBestWindow( 
-    IN PVCB Vcb
+    IN PVCB Vcb,
+    IN ULONG ClustersNeeded
     )
 /*++
 
@@ -284,58 +467,57 @@ Routine Description:
     Choose a window to allocate clusters from.   Order of preference is:
 
     1.  First window with >50% free clusters
-    2.  First empty window
-    3.  Window with greatest number of free clusters.
+    2.  First window which may hold a run of ClustersNeeded clusters
+    3.  First empty window
+    4.  Window with greatest number of free clusters.
+
+    Each step is a single descent of the window summary tree, so the cost
+    is logarithmic in the number of windows.
         
 Arguments:
 
     Vcb - Supplies the Vcb for the volume
 
+    ClustersNeeded - Supplies the size of the run the caller is looking for,
+        zero if there is no preference.
+
 Return Value:
 
     'Best window' number (index into Vcb->Windows[])
 
 --*/
 {
-    ULONG i, Fave = 0;
-    ULONG MaxFree = 0;
-    ULONG FirstEmpty = (ULONG)-1;
+    ULONG Fave;
     ULONG ClustersPerWindow = MAX_CLUSTER_BITMAP_SIZE;
+    PFAT_WINDOW_SUMMARY Root = &Vcb->WindowSummary[1];
 
     NT_ASSERT( 1 != Vcb->NumberOfWindows);
-    
-    for (i = 0; i < Vcb->NumberOfWindows; i++) {
+    NT_ASSERT( Vcb->WindowSummary != NULL );
 
-        if (Vcb->Windows[i].ClustersFree == ClustersPerWindow)  {
-        
-            if (-1 == FirstEmpty)  {
-            
-                //
-                //  Keep note of the first empty window on the disc
-                //
-                
-                FirstEmpty = i;
-            }
-        }
-        else if (Vcb->Windows[i].ClustersFree > MaxFree)  {
+    //
+    //  If any partially used window has >50% free clusters, take the first
+    //  such window.
+    //
 
-            //
-            //  This window has the most free clusters,  so far
-            //
-            
-            MaxFree = Vcb->Windows[i].ClustersFree;
-            Fave = i;
+    if (Root->MaxClustersFree >= (ClustersPerWindow >> 1))  {
 
-            //
-            //  If this window has >50% free clusters,  then we will take it,
-            //  so don't bother considering more windows.
-            //
-            
-            if (MaxFree >= (ClustersPerWindow >> 1))  {
-            
-                break;
-            }
-        }
+        return FatFindFirstWindow( Vcb,
+                                   FIELD_OFFSET( FAT_WINDOW_SUMMARY, MaxClustersFree ),
+                                   ClustersPerWindow >> 1 );
+    }
+
+    //
+    //  Prefer a partially used window which may still hold the whole run
+    //  over breaking into an empty one.  The run hint is only an upper bound,
+    //  if it turns out to be wrong the allocator will simply take the longest
+    //  run it finds and the hint will be corrected when we leave the window.
+    //
+
+    if ((ClustersNeeded > 1) && (Root->MaxRunHint >= ClustersNeeded))  {
+
+        return FatFindFirstWindow( Vcb,
+                                   FIELD_OFFSET( FAT_WINDOW_SUMMARY, MaxRunHint ),
+                                   ClustersNeeded );
     }
 
     //
@@ -344,15 +526,24 @@ Return Value:
     //  the one with the most free clusters.
     //
     
-    if ((MaxFree < (ClustersPerWindow >> 1)) && (-1 != FirstEmpty))  {
+    if (Root->EmptyWindows != 0)  {
 
-        Fave = FirstEmpty;
+        Fave = FatFindFirstWindow( Vcb,
+                                   FIELD_OFFSET( FAT_WINDOW_SUMMARY, EmptyWindows ),
+                                   1 );
+    } else {
+
+        Fave = FatFindFirstWindow( Vcb,
+                                   FIELD_OFFSET( FAT_WINDOW_SUMMARY, MaxClustersFree ),
+                                   Root->MaxClustersFree );
     }
 
+    NT_ASSERT( Fave < Vcb->NumberOfWindows );
+
     return Fave;
 }
 
-
+
 VOID
 FatSetupAllocationSupport (
     IN PIRP_CONTEXT IrpContext,
@@ -464,6 +655,24 @@ Arguments:
                                                  Vcb->NumberOfWindows * sizeof(FAT_WINDOW),
                                                  TAG_FAT_WINDOW );
 
+        if (Vcb->NumberOfWindows > 1) {
+
+            //
+            //  Size the summary tree to the next power of two of windows.
+            //
+
+            Vcb->WindowSummaryLeaves = 1;
+
+            while (Vcb->WindowSummaryLeaves < Vcb->NumberOfWindows) {
+
+                Vcb->WindowSummaryLeaves <<= 1;
+            }
+
+            Vcb->WindowSummary = FsRtlAllocatePoolWithTag( PagedPool,
+                                                           2 * Vcb->WindowSummaryLeaves * sizeof(FAT_WINDOW_SUMMARY),
+                                                           TAG_FAT_WINDOW_SUMMARY );
+        }
+
         RtlInitializeBitMap( &Vcb->FreeClusterBitMap,
                              NULL,
                              0 );
@@ -486,12 +695,13 @@ Arguments:
                                   NULL,
                                   NULL);
 
+            FatBuildWindowSummary( Vcb );
 
             //
             //  Pick a window to begin allocating from
             //
 
-            Vcb->CurrentWindow = &Vcb->Windows[ FatSelectBestWindow( Vcb)];
+            Vcb->CurrentWindow = &Vcb->Windows[ FatSelectBestWindow( Vcb, 0 )];
 
         } else {
 
@@ -583,6 +793,13 @@ Return Value:
         Vcb->Windows = NULL;
     }
 
+    if ( Vcb->WindowSummary != NULL ) {
+
+        ExFreePool( Vcb->WindowSummary );
+        Vcb->WindowSummary = NULL;
+        Vcb->WindowSummaryLeaves = 0;
+    }
+
     //
     //  Free the memory associated with the free cluster bitmap.
     //
@@ -2056,6 +2273,7 @@ Arguments:
         FatReserveClusters(IrpContext, Vcb, StartingCluster, ClusterCount);
 
         Window->ClustersFree -= ClusterCount;
+        FatUpdateWindowSummary( Vcb, Window, FALSE );
 
         StartingCluster += Window->FirstCluster;
         StartingCluster -= 2;
@@ -2111,6 +2329,7 @@ Arguments:
                 }
 
                 Window->ClustersFree += ClusterCount;
+                FatUpdateWindowSummary( Vcb, Window, TRUE );
                 Vcb->AllocationSupport.NumberOfFreeClusters += ClusterCount;
 
                 FatUnlockFreeClusterBitMap( Vcb );
@@ -2389,7 +2608,7 @@ Arguments:
                         //  Select a new window to begin allocating from
                         //
                         
-                        FaveWindow = FatSelectBestWindow( Vcb);
+                        FaveWindow = FatSelectBestWindow( Vcb, ClustersRemaining );
                     }
 
                     //
@@ -2439,6 +2658,7 @@ Arguments:
                     Cluster = Index + Window->FirstCluster;
                     
                     Window->ClustersFree -= ClustersFound;
+                    FatUpdateWindowSummary( Vcb, Window, FALSE );
                     NT_ASSERT( PreviousClear - ClustersFound == Window->ClustersFree );
 
                     FatUnlockFreeClusterBitMap( Vcb );
@@ -2542,6 +2762,7 @@ Arguments:
                     //
 
                     Window->ClustersFree += ClustersFound;
+                    FatUpdateWindowSummary( Vcb, Window, TRUE );
                     Vcb->AllocationSupport.NumberOfFreeClusters += ClustersFound;
 
                     FatUnlockFreeClusterBitMap( Vcb );
@@ -3020,6 +3241,7 @@ Return Value:
 
                 count = FatMin(Window->LastCluster - MyStart + 1, MyLength);
                 Window->ClustersFree += count;
+                FatUpdateWindowSummary( Vcb, Window, TRUE );
 
                 //
                 //  If this was not the last window this allocation spanned,
@@ -4837,6 +5059,7 @@ Return Value:
         CurrentWindow = &Vcb->Windows[0];
         CurrentWindow->FirstCluster = StartIndex;
         CurrentWindow->ClustersFree = 0;
+        CurrentWindow->LongestRunHint = 0;
 
         //
         //  We always wish to calculate total free clusters when
@@ -5017,6 +5240,7 @@ Return Value:
 
                         ClustersThisRun = FatIndex - StartIndexOfThisRun;
                         CurrentWindow->ClustersFree += ClustersThisRun;
+                        CurrentWindow->LongestRunHint = FatMax( CurrentWindow->LongestRunHint, ClustersThisRun );
 
                         if (FreeClusterCount) {
                             *FreeClusterCount += ClustersThisRun;
@@ -5033,6 +5257,7 @@ Return Value:
 
                     CurrentWindow++;
                     CurrentWindow->ClustersFree = 0;
+                    CurrentWindow->LongestRunHint = 0;
                     CurrentWindow->FirstCluster = FatIndex;
                 }
 
@@ -5110,6 +5335,7 @@ Return Value:
 
                     *FreeClusterCount += ClustersThisRun;
                     CurrentWindow->ClustersFree += ClustersThisRun;
+                    CurrentWindow->LongestRunHint = FatMax( CurrentWindow->LongestRunHint, ClustersThisRun );
                 }
 
                 if (BitMap) {
@@ -5179,6 +5405,7 @@ Return Value:
 
                 *FreeClusterCount += ClustersThisRun;
                 CurrentWindow->ClustersFree += ClustersThisRun;
+                CurrentWindow->LongestRunHint = FatMax( CurrentWindow->LongestRunHint, ClustersThisRun );
             }
 
             if (BitMap) {
@@ -5217,8 +5444,25 @@ Return Value:
 
         if (SwitchToWindow) {
 
+            ULONG LongestRunIndex;
+
             if (Vcb->FreeClusterBitMap.Buffer) {
 
+                //
+                //  Leave an exact longest run behind in the window we are
+                //  switching away from, so the summary tree can steer
+                //  contiguous allocations without rescanning its FAT.
+                //
+
+                if ((Vcb->WindowSummary != NULL) &&
+                    (Vcb->CurrentWindow != SwitchToWindow)) {
+
+                    Vcb->CurrentWindow->LongestRunHint =
+                        RtlFindLongestRunClear( &Vcb->FreeClusterBitMap, &LongestRunIndex );
+
+                    FatUpdateWindowSummary( Vcb, Vcb->CurrentWindow, FALSE );
+                }
+
                 ExFreePool( Vcb->FreeClusterBitMap.Buffer );
             }
 
@@ -5237,6 +5481,11 @@ Return Value:
 
                 Vcb->CurrentWindow->ClustersFree = *FreeClusterCount;
             }
+
+            Vcb->CurrentWindow->LongestRunHint =
+                RtlFindLongestRunClear( &Vcb->FreeClusterBitMap, &LongestRunIndex );
+
+            FatUpdateWindowSummary( Vcb, Vcb->CurrentWindow, FALSE );
         }
 
         //
@@ -170,26 +170,80 @@ FatDefragDirectory (
     IN ULONG DirentsNeeded
     );
 
+_Requires_lock_held_(_Global_critical_region_)
+VOID
+FatLocateDirentInRange (
+    IN PIRP_CONTEXT IrpContext,
+    IN PDCB ParentDirectory,
+    IN PCCB Ccb,
+    IN VBO OffsetToStartSearchFrom,
+    IN VBO StopOffset,
+    OUT PDIRENT *Dirent,
+    OUT PBCB *Bcb,
+    OUT PVBO ByteOffset,
+    OUT PBOOLEAN FileNameDos OPTIONAL,
+    IN OUT PUNICODE_STRING LongFileName OPTIONAL,
+    IN OUT PUNICODE_STRING OrigLongFileName OPTIONAL,
+    OUT PVBO EndOffset OPTIONAL
+    );
+
+ULONG
+FatHashOemDirentName (
+    IN PUCHAR Name
+    );
+
+ULONG
+FatHashUnicodeDirentName (
+    IN PUNICODE_STRING Name
+    );
+
+BOOLEAN
+FatAddDirentIndexEntry (
+    IN PFAT_DIRENT_INDEX Index,
+    IN ULONG Hash,
+    IN VBO DirentOffset
+    );
+
+_Requires_lock_held_(_Global_critical_region_)
+BOOLEAN
+FatUpdateDirentIndex (
+    IN PIRP_CONTEXT IrpContext,
+    IN PDCB Dcb
+    );
+
+//
+//  Directories smaller than this are always searched sequentially.
+//
+
+#define FAT_DIRENT_INDEX_MINIMUM_SIZE   (0x8000)
+
 
 #ifdef ALLOC_PRAGMA
+#pragma alloc_text(PAGE, FatAddDirentIndexEntry)
 #pragma alloc_text(PAGE, FatComputeLfnChecksum)
 #pragma alloc_text(PAGE, FatConstructDirent)
 #pragma alloc_text(PAGE, FatConstructLabelDirent)
 #pragma alloc_text(PAGE, FatCreateNewDirent)
 #pragma alloc_text(PAGE, FatDefragDirectory)
 #pragma alloc_text(PAGE, FatDeleteDirent)
+#pragma alloc_text(PAGE, FatFreeDirentIndex)
 #pragma alloc_text(PAGE, FatGetDirentFromFcbOrDcb)
+#pragma alloc_text(PAGE, FatHashOemDirentName)
+#pragma alloc_text(PAGE, FatHashUnicodeDirentName)
 #pragma alloc_text(PAGE, FatInitializeDirectoryDirent)
 #pragma alloc_text(PAGE, FatIsDirectoryEmpty)
 #pragma alloc_text(PAGE, FatLfnDirentExists)
 #pragma alloc_text(PAGE, FatLocateDirent)
+#pragma alloc_text(PAGE, FatLocateDirentInRange)
 #pragma alloc_text(PAGE, FatLocateSimpleOemDirent)
 #pragma alloc_text(PAGE, FatLocateVolumeLabel)
 #pragma alloc_text(PAGE, FatRescanDirectory)
 #pragma alloc_text(PAGE, FatSetFileSizeInDirent)
 #pragma alloc_text(PAGE, FatSetFileSizeInDirentNoRaise)
+#pragma alloc_text(PAGE, FatTruncateDirentIndex)
 #pragma alloc_text(PAGE, FatTunnelFcbOrDcb)
 #pragma alloc_text(PAGE, FatUpdateDirentFromFcb)
+#pragma alloc_text(PAGE, FatUpdateDirentIndex)
 
 
 #endif
@@ -540,6 +594,13 @@ Return Value:
     ParentDirectory->Specific.Dcb.UnusedDirentVbo = UnusedVbo;
     ParentDirectory->Specific.Dcb.DeletedDirentHint = DeletedHint;
 
+    //
+    //  The caller is about to put a name here, so the index no longer
+    //  describes anything from this dirent on.
+    //
+
+    FatTruncateDirentIndex( ParentDirectory, ByteOffset );
+
     DebugTrace(-1, Dbg, "FatCreateNewDirent -> (VOID)\n", 0);
 
     return ByteOffset;
@@ -1090,6 +1151,11 @@ Routine Description:
 
     This routine locates on the disk an undeleted dirent matching a given name.
 
+    An exact name lookup of a large directory goes through the directory's
+    dirent index, and only searches the dirents whose names hash like the
+    one we are looking for.  Everything else searches the directory
+    sequentially.
+
 Arguments:
 
     ParentDirectory - Supplies the DCB for the directory to search
@@ -1124,6 +1190,644 @@ Return Value:
 
 --*/
 
+{
+    PFAT_DIRENT_INDEX Index;
+    ULONG Hashes[2];
+    ULONG HashCount = 0;
+    ULONG i;
+    ULONG Entry;
+    VBO Candidate;
+    VBO PriorCandidate = 0;
+    BOOLEAN FirstCandidate = TRUE;
+
+    PAGED_CODE();
+
+    UNREFERENCED_PARAMETER( Flags ); // future use
+
+    //
+    //  Only an exact name lookup of the whole directory can use the index.
+    //
+
+    if ((OffsetToStartSearchFrom != 0) ||
+        Ccb->ContainsWildCards ||
+        FlagOn( Ccb->Flags, CCB_FLAG_MATCH_ALL | CCB_FLAG_MATCH_VOLUME_ID ) ||
+        !FatUpdateDirentIndex( IrpContext, ParentDirectory )) {
+
+        FatLocateDirentInRange( IrpContext,
+                                ParentDirectory,
+                                Ccb,
+                                OffsetToStartSearchFrom,
+                                MAXULONG,
+                                Dirent,
+                                Bcb,
+                                ByteOffset,
+                                FileNameDos,
+                                LongFileName,
+                                OrigLongFileName,
+                                NULL );
+        return;
+    }
+
+    Index = ParentDirectory->Specific.Dcb.DirentIndex;
+
+    if (!FlagOn( Ccb->Flags, CCB_FLAG_SKIP_SHORT_NAME_COMPARE )) {
+
+        Hashes[HashCount++] = FatHashOemDirentName( Ccb->OemQueryTemplate.Constant );
+    }
+
+    if (FatData.ChicagoMode && ARGUMENT_PRESENT(LongFileName)) {
+
+        Hashes[HashCount++] = FatHashUnicodeDirentName( &Ccb->UnicodeQueryTemplate );
+    }
+
+    //
+    //  Try the candidates in directory order, so that we find the same dirent
+    //  a sequential search would.  Each candidate is checked by searching up
+    //  to it from far enough back to see all of its Lfn dirents.
+    //
+
+    while (TRUE) {
+
+        Candidate = MAXULONG;
+
+        for (i = 0; i < HashCount; i++) {
+
+            for (Entry = Index->Buckets[Hashes[i] & (Index->BucketCount - 1)];
+                 Entry != FAT_DIRENT_INDEX_NIL;
+                 Entry = Index->Entries[Entry].Next) {
+
+                if ((Index->Entries[Entry].Hash == Hashes[i]) &&
+                    (FirstCandidate || (Index->Entries[Entry].DirentOffset > PriorCandidate)) &&
+                    (Index->Entries[Entry].DirentOffset < Candidate)) {
+
+                    Candidate = Index->Entries[Entry].DirentOffset;
+                }
+            }
+        }
+
+        if (Candidate == MAXULONG) {
+
+            break;
+        }
+
+        FatLocateDirentInRange( IrpContext,
+                                ParentDirectory,
+                                Ccb,
+                                (Candidate > MAX_LFN_DIRENTS * sizeof(DIRENT)) ?
+                                    Candidate - MAX_LFN_DIRENTS * sizeof(DIRENT) : 0,
+                                Candidate,
+                                Dirent,
+                                Bcb,
+                                ByteOffset,
+                                FileNameDos,
+                                LongFileName,
+                                OrigLongFileName,
+                                NULL );
+
+        if (*Dirent != NULL) {
+
+            return;
+        }
+
+        PriorCandidate = Candidate;
+        FirstCandidate = FALSE;
+    }
+
+    //
+    //  The index now covers the whole directory, so the name is not there.
+    //  Searching from the end sets up the out parameters for a miss.
+    //
+
+    FatLocateDirentInRange( IrpContext,
+                            ParentDirectory,
+                            Ccb,
+                            Index->IndexedEnd,
+                            MAXULONG,
+                            Dirent,
+                            Bcb,
+                            ByteOffset,
+                            FileNameDos,
+                            LongFileName,
+                            OrigLongFileName,
+                            NULL );
+}
+
+
+VOID
+FatTruncateDirentIndex (
+    IN PDCB Dcb,
+    IN VBO Vbo
+    )
+
+/*++
+
+Routine Description:
+
+    This routine is called when a dirent at Vbo is about to be given a new
+    name, or moved.  The dirent index of the directory, if any, will no
+    longer be trusted from Vbo on and is brought up to date the next time
+    it is used.
+
+Arguments:
+
+    Dcb - Supplies the directory.
+
+    Vbo - Supplies the offset of the first dirent which changes.
+
+Return Value:
+
+    None.
+
+--*/
+
+{
+    PAGED_CODE();
+
+    if ((Dcb->Specific.Dcb.DirentIndex != NULL) &&
+        (Vbo < Dcb->Specific.Dcb.DirentIndex->IndexedEnd)) {
+
+        Dcb->Specific.Dcb.DirentIndex->IndexedEnd = Vbo;
+    }
+}
+
+
+VOID
+FatFreeDirentIndex (
+    IN PDCB Dcb
+    )
+
+/*++
+
+Routine Description:
+
+    This routine frees the dirent index of a directory, if it has one.
+
+Arguments:
+
+    Dcb - Supplies the directory.
+
+Return Value:
+
+    None.
+
+--*/
+
+{
+    PFAT_DIRENT_INDEX Index = Dcb->Specific.Dcb.DirentIndex;
+
+    PAGED_CODE();
+
+    if (Index != NULL) {
+
+        ExFreePool( Index->Buckets );
+        ExFreePool( Index->Entries );
+        ExFreePool( Index );
+
+        Dcb->Specific.Dcb.DirentIndex = NULL;
+    }
+}
+
+
+//
+//  Internal support routine
+//
+
+ULONG
+FatHashOemDirentName (
+    IN PUCHAR Name
+    )
+
+/*++
+
+Routine Description:
+
+    This routine computes the dirent index hash of an 8.3 name, exactly as
+    it is stored in a dirent.
+
+Arguments:
+
+    Name - Supplies the 11 bytes of the name.
+
+Return Value:
+
+    The hash.
+
+--*/
+
+{
+    ULONG Hash = 2166136261;
+    ULONG i;
+
+    PAGED_CODE();
+
+    for (i = 0; i < 11; i++) {
+
+        Hash = (Hash ^ Name[i]) * 16777619;
+    }
+
+    return Hash;
+}
+
+
+//
+//  Internal support routine
+//
+
+ULONG
+FatHashUnicodeDirentName (
+    IN PUNICODE_STRING Name
+    )
+
+/*++
+
+Routine Description:
+
+    This routine computes the dirent index hash of a long name.  The name is
+    upcased as it is hashed, so all the case variants of a name hash alike.
+
+Arguments:
+
+    Name - Supplies the name.
+
+Return Value:
+
+    The hash.
+
+--*/
+
+{
+    ULONG Hash = 2166136261;
+    ULONG i;
+
+    PAGED_CODE();
+
+    for (i = 0; i < Name->Length / sizeof(WCHAR); i++) {
+
+        Hash = (Hash ^ RtlUpcaseUnicodeChar( Name->Buffer[i] )) * 16777619;
+    }
+
+    return Hash;
+}
+
+
+//
+//  Internal support routine
+//
+
+BOOLEAN
+FatAddDirentIndexEntry (
+    IN PFAT_DIRENT_INDEX Index,
+    IN ULONG Hash,
+    IN VBO DirentOffset
+    )
+
+/*++
+
+Routine Description:
+
+    This routine adds a name hash to the dirent index, growing the entry
+    array if it is full.  Entries must be added in ascending offset order.
+
+Arguments:
+
+    Index - Supplies the dirent index.
+
+    Hash - Supplies the hash of the name.
+
+    DirentOffset - Supplies the offset of the short dirent of the name.
+
+Return Value:
+
+    FALSE if we could not allocate the pool to grow the index.
+
+--*/
+
+{
+    PFAT_DIRENT_INDEX_ENTRY Entries;
+    ULONG Bucket;
+
+    PAGED_CODE();
+
+    NT_ASSERT( (Index->EntryCount == 0) ||
+               (Index->Entries[Index->EntryCount - 1].DirentOffset <= DirentOffset) );
+
+    if (Index->EntryCount == Index->MaximumEntries) {
+
+        Entries = ExAllocatePoolWithTag( PagedPool,
+                                         Index->MaximumEntries * 2 * sizeof(FAT_DIRENT_INDEX_ENTRY),
+                                         TAG_DIRENT_INDEX );
+
+        if (Entries == NULL) {
+
+            return FALSE;
+        }
+
+        RtlCopyMemory( Entries,
+                       Index->Entries,
+                       Index->EntryCount * sizeof(FAT_DIRENT_INDEX_ENTRY) );
+
+        ExFreePool( Index->Entries );
+
+        Index->Entries = Entries;
+        Index->MaximumEntries *= 2;
+    }
+
+    Bucket = Hash & (Index->BucketCount - 1);
+
+    Index->Entries[Index->EntryCount].Hash = Hash;
+    Index->Entries[Index->EntryCount].DirentOffset = DirentOffset;
+    Index->Entries[Index->EntryCount].Next = Index->Buckets[Bucket];
+
+    Index->Buckets[Bucket] = Index->EntryCount;
+    Index->EntryCount += 1;
+
+    return TRUE;
+}
+
+
+//
+//  Internal support routine
+//
+
+_Requires_lock_held_(_Global_critical_region_)
+BOOLEAN
+FatUpdateDirentIndex (
+    IN PIRP_CONTEXT IrpContext,
+    IN PDCB Dcb
+    )
+
+/*++
+
+Routine Description:
+
+    This routine makes sure the dirent index of a directory describes all of
+    it, building the index on the first call for a large directory.  Only
+    the part of the directory past IndexedEnd has to be read.
+
+Arguments:
+
+    Dcb - Supplies the directory.
+
+Return Value:
+
+    TRUE if the index can be used for a lookup, FALSE if the directory must
+    be searched sequentially.
+
+--*/
+
+{
+    PFAT_DIRENT_INDEX Index = Dcb->Specific.Dcb.DirentIndex;
+    PFAT_DIRENT_INDEX_ENTRY LastEntry;
+    ULONG Dirents;
+
+    CCB LocalCcb;
+    UNICODE_STRING Lfn;
+    WCHAR LfnBuffer[FAT_CREATE_INITIAL_NAME_BUF_SIZE];
+
+    PDIRENT Dirent = NULL;
+    PBCB Bcb = NULL;
+    VBO ByteOffset = 0;
+    VBO Offset;
+    VBO EndOffset = 0;
+    BOOLEAN Result = FALSE;
+
+    PAGED_CODE();
+
+    //
+    //  Holding the Vcb exclusive is what keeps the index stable.
+    //
+
+    if (!ExIsResourceAcquiredExclusiveLite( &Dcb->Vcb->Resource )) {
+
+        return FALSE;
+    }
+
+    if (Index == NULL) {
+
+        if ((Dcb->Header.AllocationSize.QuadPart == FCB_LOOKUP_ALLOCATIONSIZE_HINT) ||
+            (Dcb->Header.AllocationSize.LowPart < FAT_DIRENT_INDEX_MINIMUM_SIZE)) {
+
+            return FALSE;
+        }
+
+        Index = ExAllocatePoolWithTag( PagedPool,
+                                       sizeof(FAT_DIRENT_INDEX),
+                                       TAG_DIRENT_INDEX );
+
+        if (Index == NULL) {
+
+            return FALSE;
+        }
+
+        //
+        //  Size the index for every dirent having a short name, with about
+        //  two names per bucket.
+        //
+
+        Dirents = Dcb->Header.AllocationSize.LowPart / sizeof(DIRENT);
+
+        Index->IndexedEnd = 0;
+        Index->EntryCount = 0;
+        Index->MaximumEntries = Dirents;
+
+        for (Index->BucketCount = 64;
+             (Index->BucketCount < Dirents / 2) && (Index->BucketCount < 0x10000);
+             Index->BucketCount *= 2) {
+
+            NOTHING;
+        }
+
+        Index->Buckets = ExAllocatePoolWithTag( PagedPool,
+                                                Index->BucketCount * sizeof(ULONG),
+                                                TAG_DIRENT_INDEX );
+
+        Index->Entries = ExAllocatePoolWithTag( PagedPool,
+                                                Index->MaximumEntries * sizeof(FAT_DIRENT_INDEX_ENTRY),
+                                                TAG_DIRENT_INDEX );
+
+        if ((Index->Buckets == NULL) || (Index->Entries == NULL)) {
+
+            if (Index->Buckets != NULL) {
+
+                ExFreePool( Index->Buckets );
+            }
+
+            if (Index->Entries != NULL) {
+
+                ExFreePool( Index->Entries );
+            }
+
+            ExFreePool( Index );
+            return FALSE;
+        }
+
+        RtlFillMemory( Index->Buckets, Index->BucketCount * sizeof(ULONG), 0xff );
+
+        Dcb->Specific.Dcb.DirentIndex = Index;
+    }
+
+    //
+    //  Drop the entries at or past IndexedEnd.  They were the last ones
+    //  added, so each of them is at the head of its bucket.
+    //
+
+    while ((Index->EntryCount != 0) &&
+           (Index->Entries[Index->EntryCount - 1].DirentOffset >= Index->IndexedEnd)) {
+
+        LastEntry = &Index->Entries[Index->EntryCount - 1];
+
+        NT_ASSERT( Index->Buckets[LastEntry->Hash & (Index->BucketCount - 1)] == Index->EntryCount - 1 );
+
+        Index->Buckets[LastEntry->Hash & (Index->BucketCount - 1)] = LastEntry->Next;
+        Index->EntryCount -= 1;
+    }
+
+    //
+    //  Now add the names of the rest of the directory.  Walking it with a
+    //  match all search means the index sees exactly the names, short and
+    //  long, which a sequential search would compare against.
+    //
+
+    RtlZeroMemory( &LocalCcb, sizeof(CCB) );
+    LocalCcb.Flags = CCB_FLAG_MATCH_ALL;
+
+    Lfn.Length = 0;
+    Lfn.MaximumLength = sizeof(LfnBuffer);
+    Lfn.Buffer = LfnBuffer;
+
+    Offset = Index->IndexedEnd;
+
+    try {
+
+        while (TRUE) {
+
+            FatLocateDirentInRange( IrpContext,
+                                    Dcb,
+                                    &LocalCcb,
+                                    Offset,
+                                    MAXULONG,
+                                    &Dirent,
+                                    &Bcb,
+                                    &ByteOffset,
+                                    NULL,
+                                    &Lfn,
+                                    NULL,
+                                    &EndOffset );
+
+            if (Dirent == NULL) {
+
+                Index->IndexedEnd = EndOffset;
+                Result = TRUE;
+                break;
+            }
+
+            if (!FatAddDirentIndexEntry( Index,
+                                         FatHashOemDirentName( Dirent->FileName ),
+                                         ByteOffset ) ||
+                ((Lfn.Length != 0) &&
+                 !FatAddDirentIndexEntry( Index,
+                                          FatHashUnicodeDirentName( &Lfn ),
+                                          ByteOffset ))) {
+
+                break;
+            }
+
+            Offset = ByteOffset + sizeof(DIRENT);
+        }
+
+    } finally {
+
+        FatUnpinBcb( IrpContext, Bcb );
+        FatFreeStringBuffer( &Lfn );
+    }
+
+    //
+    //  If the directory has grown a lot since the index was built, start
+    //  over with more buckets.
+    //
+
+    if (Result &&
+        (Index->EntryCount > Index->BucketCount * 4) &&
+        (Index->BucketCount < 0x10000)) {
+
+        FatFreeDirentIndex( Dcb );
+
+        Result = FatUpdateDirentIndex( IrpContext, Dcb );
+    }
+
+    return Result;
+}
+
+
+//
+//  Internal support routine
+//
+
+_Requires_lock_held_(_Global_critical_region_)
+VOID
+FatLocateDirentInRange (
+    IN PIRP_CONTEXT IrpContext,
+    IN PDCB ParentDirectory,
+    IN PCCB Ccb,
+    IN VBO OffsetToStartSearchFrom,
+    IN VBO StopOffset,
+    OUT PDIRENT *Dirent,
+    OUT PBCB *Bcb,
+    OUT PVBO ByteOffset,
+    OUT PBOOLEAN FileNameDos OPTIONAL,
+    IN OUT PUNICODE_STRING LongFileName OPTIONAL,
+    IN OUT PUNICODE_STRING OrigLongFileName OPTIONAL,
+    OUT PVBO EndOffset OPTIONAL
+    )
+
+/*++
+
+Routine Description:
+
+    This routine locates on the disk an undeleted dirent matching a given
+    name, by walking the directory from OffsetToStartSearchFrom.  It is the
+    body of FatLocateDirent.
+
+Arguments:
+
+    ParentDirectory - Supplies the DCB for the directory to search
+
+    Ccb - Contains a context control block with all matching information.
+
+    OffsetToStartSearchFrom - Supplies the VBO within the parent directory
+        from which to start looking for another real dirent.
+
+    StopOffset - Supplies the VBO of the last dirent to look at.  The
+        search fails if no dirent up to and including this one matches.
+
+    Dirent - Receives a pointer to the located dirent if one was found
+        or NULL otherwise.
+
+    Bcb - Receives the Bcb for the located dirent if one was found or
+        NULL otherwise.
+
+    ByteOffset - Receives the VBO within the Parent directory for
+        the located dirent if one was found, or 0 otherwise.
+
+    FileNameDos - Receives TRUE if the element of the dirent we hit on
+        was the short (non LFN) side
+
+    LongFileName - If specified, this parameter returns the long file name
+        associated with the returned dirent.  Note that it is the caller's
+        responsibility to provide the buffer (and set MaximumLength
+        accordingly) for this unicode string.  The Length field is reset
+        to 0 by this routine on invocation.  If the supplied buffer is not
+        large enough,  a new one will be allocated from pool.
+
+    EndOffset - If specified, receives the VBO of the end of the directory
+        if the search reached it.
+
+Return Value:
+
+    None.
+
+--*/
+
 {
     NTSTATUS Status = STATUS_SUCCESS;
 
@@ -1146,7 +1850,7 @@ Return Value:
 
     PAGED_CODE();
 
-    DebugTrace(+1, Dbg, "FatLocateDirent\n", 0);
+    DebugTrace(+1, Dbg, "FatLocateDirentInRange\n", 0);
 
     DebugTrace( 0, Dbg, "  ParentDirectory         = %p\n", ParentDirectory);
     DebugTrace( 0, Dbg, "  OffsetToStartSearchFrom = %08lx\n", OffsetToStartSearchFrom);
@@ -1185,8 +1889,6 @@ Return Value:
     //  In the first case we found it, in the latter three cases we did not.
     //
  
-    UNREFERENCED_PARAMETER( Flags ); // future use
-
 
     Name.MaximumLength = 12;
     Name.Buffer = (PCHAR)NameBuffer;
@@ -1252,6 +1954,18 @@ Return Value:
 
             UpcasedLfnValid = FALSE;
 
+            //
+            //  Stop once we have looked at the dirent at StopOffset.
+            //
+
+            if (*ByteOffset > StopOffset) {
+
+                FatUnpinBcb( IrpContext, *Bcb );
+
+                *Dirent = NULL;
+                *ByteOffset = 0;
+                break;
+            }
 
             //
             //  Try to read in the dirent
@@ -1278,6 +1992,11 @@ Return Value:
 
                 DebugTrace( 0, Dbg, "End of directory: entry not found.\n", 0);
 
+                if (ARGUMENT_PRESENT(EndOffset)) {
+
+                    *EndOffset = *ByteOffset;
+                }
+
                 //
                 //  If there is a Bcb, unpin it and set it to null
                 //
@@ -1704,9 +2423,9 @@ GetNextDirent:
         
     }
 
-    DebugTrace(-1, Dbg, "FatLocateDirent -> (VOID)\n", 0);
+    DebugTrace(-1, Dbg, "FatLocateDirentInRange -> (VOID)\n", 0);
 
-    TimerStop(Dbg,"FatLocateDirent");
+    TimerStop(Dbg,"FatLocateDirentInRange");
 
     return;
 }
@@ -3361,6 +4080,12 @@ Return Value:
 
     NT_ASSERT( FatVcbAcquiredExclusive(IrpContext, Dcb->Vcb) );
 
+    //
+    //  Every dirent may move, so nothing in the index can be trusted.
+    //
+
+    FatTruncateDirentIndex( Dcb, 0 );
+
     //
     //  We will only attempt this on directories less than 0x40000 bytes
     //  long (by default on DOS the root directory is only 0x2000 long).
@@ -705,6 +705,17 @@ FatLocateDirent (
     IN OUT PUNICODE_STRING OrigLfn OPTIONAL        
     );
 
+VOID
+FatTruncateDirentIndex (
+    IN PDCB Dcb,
+    IN VBO Vbo
+    );
+
+VOID
+FatFreeDirentIndex (
+    IN PDCB Dcb
+    );
+
 _Requires_lock_held_(_Global_critical_region_)
 VOID
 FatLocateSimpleOemDirent (
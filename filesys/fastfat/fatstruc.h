@@ -169,10 +169,30 @@ typedef struct _FAT_WINDOW {
     ULONG FirstCluster;       // The first cluster in this window.
     ULONG LastCluster;        // The last cluster in this window.
     ULONG ClustersFree;       // The number of clusters free in this window.
+    ULONG LongestRunHint;     // Upper bound on the longest free run in this window.
 
 } FAT_WINDOW;
 typedef FAT_WINDOW *PFAT_WINDOW;
 
+//
+//  FAT32 volumes with more than one window also keep a summary tree over the
+//  window array so that picking a window to allocate from does not require
+//  walking every window.  The tree is a complete binary tree stored in an
+//  array, node 1 is the root and the leaves start at WindowSummaryLeaves.
+//  Each node describes the windows beneath it.  Full (completely free)
+//  windows are only counted in EmptyWindows, so MaxClustersFree and
+//  MaxRunHint only reflect partially used windows.
+//
+
+typedef struct _FAT_WINDOW_SUMMARY {
+
+    ULONG MaxClustersFree;    // Greatest ClustersFree of a partially used window.
+    ULONG MaxRunHint;         // Greatest LongestRunHint of a partially used window.
+    ULONG EmptyWindows;       // The number of completely free windows.
+
+} FAT_WINDOW_SUMMARY;
+typedef FAT_WINDOW_SUMMARY *PFAT_WINDOW_SUMMARY;
+
 //
 //  Forward reference some circular referenced structures.
 //
@@ -288,6 +308,14 @@ typedef struct _VCB {
     PFAT_WINDOW Windows;
     PFAT_WINDOW CurrentWindow;
 
+    //
+    //  Summary tree over the windows, protected by the free cluster bitmap
+    //  mutex.  Only allocated for volumes with NumberOfWindows > 1.
+    //
+
+    ULONG WindowSummaryLeaves;
+    PFAT_WINDOW_SUMMARY WindowSummary;
+
     //
     //  A count of the number of file objects that have opened the volume
     //  for direct access, and their share access state.
@@ -748,6 +776,45 @@ typedef struct _NON_PAGED_FCB {
 
 typedef NON_PAGED_FCB *PNON_PAGED_FCB;
 
+//
+//  The dirent index speeds up looking up a name in a large directory.  It
+//  maps a hash of the 8.3 name and of the upcased long name of each dirent
+//  to the offset of its short dirent, so FatLocateDirent only has to look
+//  at the dirents which could match.  A hit is always checked against the
+//  dirent itself, so stale entries for deleted dirents are harmless.
+//
+//  Only the dirents below IndexedEnd are described by the index.  New
+//  dirents created past it are added the next time the index is used, and
+//  creating a dirent below it moves IndexedEnd down.  The entries are kept
+//  in ascending offset order, so the entries at or past IndexedEnd are
+//  always the tail of the array and the heads of their buckets.
+//
+//  The index is only used or changed with the Vcb held exclusive.
+//
+
+#define FAT_DIRENT_INDEX_NIL            ((ULONG)-1)
+
+typedef struct _FAT_DIRENT_INDEX_ENTRY {
+
+    ULONG Hash;
+    VBO DirentOffset;
+    ULONG Next;
+
+} FAT_DIRENT_INDEX_ENTRY, *PFAT_DIRENT_INDEX_ENTRY;
+
+typedef struct _FAT_DIRENT_INDEX {
+
+    VBO IndexedEnd;
+
+    ULONG BucketCount;
+    PULONG Buckets;
+
+    ULONG EntryCount;
+    ULONG MaximumEntries;
+    PFAT_DIRENT_INDEX_ENTRY Entries;
+
+} FAT_DIRENT_INDEX, *PFAT_DIRENT_INDEX;
+
 //
 //  The Fcb/Dcb record corresponds to every open file and directory, and to
 //  every directory on an opened path.  They are ordered in two queues, one
@@ -1041,6 +1108,13 @@ typedef struct _FCB {
 
             RTL_BITMAP FreeDirentBitmap;
 
+            //
+            //  The name index of a large directory, built on the first
+            //  lookup in it.  NULL if there is none.
+            //
+
+            PFAT_DIRENT_INDEX DirentIndex;
+
             //
             //  Since the FCB specific part of this union is larger, use
             //  the slack here for an initial bitmap buffer.  Currently
@@ -3419,6 +3419,13 @@ Return Value:
         } else {
 
             NewOffset = Fcb->LfnOffsetWithinDirectory;
+
+            //
+            //  The new name goes over the old one, so the dirent index of
+            //  the directory is stale from here on.
+            //
+
+            FatTruncateDirentIndex( TargetDcb, NewOffset );
         }
 
         ContinueWithRename = TRUE;
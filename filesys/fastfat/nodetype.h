@@ -164,6 +164,7 @@ typedef CSHORT NODE_BYTE_SIZE;
 #define TAG_FAT_CLOSE_CONTEXT           'xtaF'
 #define TAG_FAT_IO_CONTEXT              'XtaF'
 #define TAG_FAT_WINDOW                  'WtaF'
+#define TAG_FAT_WINDOW_SUMMARY          'wtaF'
 #define TAG_FILENAME_BUFFER             'ntaF'
 #define TAG_IO_RUNS                     'itaF'
 #define TAG_REPINNED_BCB                'RtaF'
@@ -187,6 +188,8 @@ typedef CSHORT NODE_BYTE_SIZE;
 
 #define TAG_DEFRAG_BUFFER               'GtaF'
 
+#define TAG_DIRENT_INDEX                'HtaF'
+
 #endif
 
 #endif // _NODETYPE_
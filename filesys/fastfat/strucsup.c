@@ -1981,6 +1981,12 @@ Return Value:
             ExFreePool(Fcb->Specific.Dcb.FreeDirentBitmap.Buffer);
         }
 
+        //
+        //  Free the dirent index, if we built one.
+        //
+
+        FatFreeDirentIndex( Fcb );
+
 #if (NTDDI_VERSION >= NTDDI_WIN8)
         //
         //  Uninitialize the oplock.
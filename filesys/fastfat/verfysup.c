@@ -1469,6 +1469,8 @@ Return Value:
 
         Fcb->Specific.Dcb.UnusedDirentVbo = 0xffffffff;
         Fcb->Specific.Dcb.DeletedDirentHint = 0xffffffff;
+
+        FatTruncateDirentIndex( Fcb, 0 );
     }
 }
 
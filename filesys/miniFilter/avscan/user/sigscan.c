@@ -0,0 +1,503 @@
+/*++
+
+Copyright (c) 2011  Microsoft Corporation
+
+Module Name:
+
+    sigscan.c
+
+Abstract:
+
+    The implementation of the signature matching engine, please see sigscan.h.
+
+    SigScanCompile builds a trie of all the patterns and then walks it breadth
+    first to compute the failure links. Every missing transition is replaced
+    by the transition of the failure state, which turns the trie into a
+    deterministic automaton: scanning is a single table lookup per byte and
+    never backtracks, so a signature split across two chunks is found as
+    long as the caller keeps passing the same SIG_SCAN_STREAM.
+
+Environment:
+
+    User mode
+
+--*/
+
+#include "sigscan.h"
+
+#define SIG_SCAN_ROOT_STATE         0
+#define SIG_SCAN_NO_STATE           ((ULONG)-1)
+#define SIG_SCAN_INITIAL_PATTERNS   16
+
+#define SigScanNext(Engine, State, Byte) \
+    ((Engine)->Transitions[((SIZE_T)(State) << 8) + (Byte)])
+
+HRESULT
+SigScanInitializeEngine (
+    _Out_ PSIG_SCAN_ENGINE Engine
+    )
+/*++
+
+Routine Description:
+
+    This routine initializes an empty signature engine.
+
+Arguments:
+
+    Engine  - The engine to initialize.
+
+Return Value:
+
+    S_OK.
+
+--*/
+{
+    ZeroMemory( Engine, sizeof(SIG_SCAN_ENGINE) );
+
+    return S_OK;
+}
+
+HRESULT
+SigScanAddPattern (
+    _Inout_ PSIG_SCAN_ENGINE Engine,
+    _In_reads_bytes_(Length) const UCHAR *Pattern,
+    _In_ ULONG Length,
+    _In_ ULONG SignatureId
+    )
+/*++
+
+Routine Description:
+
+    This routine adds a signature to the engine. The pattern is copied, so
+    the caller may release its buffer afterwards. Patterns can only be added
+    before the engine is compiled.
+
+Arguments:
+
+    Engine  - The signature engine.
+
+    Pattern  - The signature bytes.
+
+    Length  - The length of the signature in bytes.
+
+    SignatureId  - The identifier reported when this signature matches.
+
+Return Value:
+
+    S_OK if successful. Otherwise, it returns a HRESULT error value.
+
+--*/
+{
+    PSIG_SCAN_PATTERN patterns;
+    PUCHAR bytes;
+
+    if (Engine->Compiled || SignatureId == MAXULONG) {
+
+        return E_INVALIDARG;
+    }
+
+    if (Length == 0) {
+
+        return E_INVALIDARG;
+    }
+
+    if (Engine->PatternCount == Engine->PatternCapacity) {
+
+        ULONG capacity = Engine->PatternCapacity ?
+                         Engine->PatternCapacity * 2 :
+                         SIG_SCAN_INITIAL_PATTERNS;
+
+        if (Engine->Patterns == NULL) {
+
+            patterns = HeapAlloc( GetProcessHeap(),
+                                  0,
+                                  capacity * sizeof(SIG_SCAN_PATTERN) );
+        } else {
+
+            patterns = HeapReAlloc( GetProcessHeap(),
+                                    0,
+                                    Engine->Patterns,
+                                    capacity * sizeof(SIG_SCAN_PATTERN) );
+        }
+
+        if (NULL == patterns) {
+
+            return E_OUTOFMEMORY;
+        }
+
+        Engine->Patterns = patterns;
+        Engine->PatternCapacity = capacity;
+    }
+
+    bytes = HeapAlloc( GetProcessHeap(), 0, Length );
+
+    if (NULL == bytes) {
+
+        return E_OUTOFMEMORY;
+    }
+
+    CopyMemory( bytes, Pattern, Length );
+
+    Engine->Patterns[Engine->PatternCount].Bytes = bytes;
+    Engine->Patterns[Engine->PatternCount].Length = Length;
+    Engine->Patterns[Engine->PatternCount].SignatureId = SignatureId;
+    Engine->PatternCount++;
+
+    return S_OK;
+}
+
+HRESULT
+SigScanCompile (
+    _Inout_ PSIG_SCAN_ENGINE Engine
+    )
+/*++
+
+Routine Description:
+
+    This routine builds the automaton from the patterns added so far.
+
+Arguments:
+
+    Engine  - The signature engine.
+
+Return Value:
+
+    S_OK if successful. Otherwise, it returns a HRESULT error value.
+
+--*/
+{
+    HRESULT hr = S_OK;
+    ULONG maxStates = 1;
+    ULONG stateCount = 1;
+    PULONG fail = NULL;
+    PULONG queue = NULL;
+    ULONG head = 0;
+    ULONG tail = 0;
+    ULONG i, j;
+    ULONG state, next;
+
+    if (Engine->Compiled) {
+
+        return E_UNEXPECTED;
+    }
+
+    //
+    //  The trie has at most one state per pattern byte plus the root.
+    //
+
+    for (i = 0; i < Engine->PatternCount; i++) {
+
+        if (Engine->Patterns[i].Length >= MAXULONG / 256 - maxStates) {
+
+            return E_OUTOFMEMORY;
+        }
+
+        maxStates += Engine->Patterns[i].Length;
+    }
+
+    //
+    //  The transition table size must also fit in a SIZE_T, which is only
+    //  32 bits wide on x86.
+    //
+
+    if (maxStates > MAXSIZE_T / (256 * sizeof(ULONG))) {
+
+        return E_OUTOFMEMORY;
+    }
+
+    Engine->Transitions = HeapAlloc( GetProcessHeap(),
+                                     0,
+                                     (SIZE_T)maxStates * 256 * sizeof(ULONG) );
+    Engine->Match = HeapAlloc( GetProcessHeap(),
+                               HEAP_ZERO_MEMORY,
+                               (SIZE_T)maxStates * sizeof(ULONG) );
+    fail = HeapAlloc( GetProcessHeap(), 0, (SIZE_T)maxStates * sizeof(ULONG) );
+    queue = HeapAlloc( GetProcessHeap(), 0, (SIZE_T)maxStates * sizeof(ULONG) );
+
+    if (NULL == Engine->Transitions || NULL == Engine->Match ||
+        NULL == fail || NULL == queue) {
+
+        hr = E_OUTOFMEMORY;
+        goto Cleanup;
+    }
+
+    FillMemory( Engine->Transitions,
+                (SIZE_T)maxStates * 256 * sizeof(ULONG),
+                0xFF );
+
+    //
+    //  Build the trie. The first signature that ends in a state wins.
+    //
+
+    for (i = 0; i < Engine->PatternCount; i++) {
+
+        PSIG_SCAN_PATTERN pattern = &Engine->Patterns[i];
+
+        state = SIG_SCAN_ROOT_STATE;
+
+        for (j = 0; j < pattern->Length; j++) {
+
+            next = SigScanNext( Engine, state, pattern->Bytes[j] );
+
+            if (next == SIG_SCAN_NO_STATE) {
+
+                next = stateCount++;
+                SigScanNext( Engine, state, pattern->Bytes[j] ) = next;
+            }
+
+            state = next;
+        }
+
+        if (Engine->Match[state] == 0) {
+
+            Engine->Match[state] = pattern->SignatureId + 1;
+        }
+    }
+
+    //
+    //  Resolve the failure links breadth first. The root loops back to
+    //  itself on every byte which does not start a pattern.
+    //
+
+    for (i = 0; i < 256; i++) {
+
+        next = SigScanNext( Engine, SIG_SCAN_ROOT_STATE, i );
+
+        if (next == SIG_SCAN_NO_STATE) {
+
+            SigScanNext( Engine, SIG_SCAN_ROOT_STATE, i ) = SIG_SCAN_ROOT_STATE;
+            Engine->StartByte[i] = FALSE;
+
+        } else {
+
+            fail[next] = SIG_SCAN_ROOT_STATE;
+            queue[tail++] = next;
+            Engine->StartByte[i] = TRUE;
+        }
+    }
+
+    while (head < tail) {
+
+        state = queue[head++];
+
+        //
+        //  A state also matches everything its failure state matches.
+        //
+
+        if (Engine->Match[state] == 0) {
+
+            Engine->Match[state] = Engine->Match[fail[state]];
+        }
+
+        for (i = 0; i < 256; i++) {
+
+            next = SigScanNext( Engine, state, i );
+
+            if (next == SIG_SCAN_NO_STATE) {
+
+                SigScanNext( Engine, state, i ) = SigScanNext( Engine, fail[state], i );
+
+            } else {
+
+                fail[next] = SigScanNext( Engine, fail[state], i );
+                queue[tail++] = next;
+            }
+        }
+    }
+
+    Engine->StateCount = stateCount;
+    Engine->Compiled = TRUE;
+
+    //
+    //  Give back the unused tail of the transition table.
+    //
+
+    if (stateCount < maxStates) {
+
+        PULONG transitions = HeapReAlloc( GetProcessHeap(),
+                                          HEAP_REALLOC_IN_PLACE_ONLY,
+                                          Engine->Transitions,
+                                          (SIZE_T)stateCount * 256 * sizeof(ULONG) );
+
+        if (transitions != NULL) {
+
+            Engine->Transitions = transitions;
+        }
+    }
+
+Cleanup:
+
+    if (fail) {
+
+        HeapFree( GetProcessHeap(), 0, fail );
+    }
+
+    if (queue) {
+
+        HeapFree( GetProcessHeap(), 0, queue );
+    }
+
+    if (FAILED(hr)) {
+
+        if (Engine->Transitions) {
+
+            HeapFree( GetProcessHeap(), 0, Engine->Transitions );
+            Engine->Transitions = NULL;
+        }
+
+        if (Engine->Match) {
+
+            HeapFree( GetProcessHeap(), 0, Engine->Match );
+            Engine->Match = NULL;
+        }
+    }
+
+    return hr;
+}
+
+VOID
+SigScanFreeEngine (
+    _Inout_ PSIG_SCAN_ENGINE Engine
+    )
+/*++
+
+Routine Description:
+
+    This routine releases all the memory held by the engine.
+
+Arguments:
+
+    Engine  - The signature engine.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    ULONG i;
+
+    for (i = 0; i < Engine->PatternCount; i++) {
+
+        HeapFree( GetProcessHeap(), 0, Engine->Patterns[i].Bytes );
+    }
+
+    if (Engine->Patterns) {
+
+        HeapFree( GetProcessHeap(), 0, Engine->Patterns );
+    }
+
+    if (Engine->Transitions) {
+
+        HeapFree( GetProcessHeap(), 0, Engine->Transitions );
+    }
+
+    if (Engine->Match) {
+
+        HeapFree( GetProcessHeap(), 0, Engine->Match );
+    }
+
+    ZeroMemory( Engine, sizeof(SIG_SCAN_ENGINE) );
+}
+
+VOID
+SigScanResetStream (
+    _Out_ PSIG_SCAN_STREAM Stream
+    )
+/*++
+
+Routine Description:
+
+    This routine prepares a stream for a new scan.
+
+Arguments:
+
+    Stream  - The per-scan state.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    Stream->State = SIG_SCAN_ROOT_STATE;
+}
+
+BOOLEAN
+SigScanStreamChunk (
+    _In_ const SIG_SCAN_ENGINE *Engine,
+    _Inout_ PSIG_SCAN_STREAM Stream,
+    _In_reads_bytes_(Size) const UCHAR *Buffer,
+    _In_ SIZE_T Size,
+    _Out_ PULONG SignatureId
+    )
+/*++
+
+Routine Description:
+
+    This routine feeds the next chunk of a stream through the automaton.
+
+Arguments:
+
+    Engine  - The compiled signature engine.
+
+    Stream  - The per-scan state, carried across chunks.
+
+    Buffer  - The chunk to scan.
+
+    Size  - The size of the chunk in bytes.
+
+    SignatureId  - Receives the identifier of the matching signature.
+
+Return Value:
+
+    TRUE if a signature was found, FALSE otherwise.
+
+--*/
+{
+    const UCHAR *p = Buffer;
+    const UCHAR *end = Buffer + Size;
+    ULONG state = Stream->State;
+
+    *SignatureId = 0;
+
+    if (!Engine->Compiled || Engine->PatternCount == 0) {
+
+        return FALSE;
+    }
+
+    while (p < end) {
+
+        //
+        //  Most of a clean file is spent in the root state, skip bytes
+        //  that cannot start a signature without touching the table.
+        //
+
+        if (state == SIG_SCAN_ROOT_STATE) {
+
+            while (p < end && !Engine->StartByte[*p]) {
+
+                p++;
+            }
+
+            if (p == end) {
+
+                break;
+            }
+        }
+
+        state = SigScanNext( Engine, state, *p );
+        p++;
+
+        if (Engine->Match[state] != 0) {
+
+            *SignatureId = Engine->Match[state] - 1;
+            Stream->State = state;
+            return TRUE;
+        }
+    }
+
+    Stream->State = state;
+
+    return FALSE;
+}
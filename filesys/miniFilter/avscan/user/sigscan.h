@@ -0,0 +1,127 @@
+/*++
+
+Copyright (c) 2011  Microsoft Corporation
+
+Module Name:
+
+    sigscan.h
+
+Abstract:
+
+    The signature matching engine. A set of byte patterns is compiled into
+    an Aho-Corasick automaton so that a stream can be searched for every
+    signature in the database in a single pass, independent of the number
+    of signatures.
+
+    The compiled engine is read-only and may be shared by all the scanning
+    threads. The per-scan position is kept in a SIG_SCAN_STREAM, which lets
+    the caller feed a mapped view in chunks while still catching signatures
+    that straddle two chunks.
+
+Environment:
+
+    User mode
+
+--*/
+
+#ifndef __SIGSCAN_H__
+#define __SIGSCAN_H__
+
+#include <windows.h>
+
+typedef struct _SIG_SCAN_PATTERN {
+
+    //
+    //  The signature bytes, owned by the engine.
+    //
+
+    PUCHAR  Bytes;
+    ULONG   Length;
+
+    //
+    //  Caller supplied identifier reported on a match.
+    //
+
+    ULONG   SignatureId;
+
+} SIG_SCAN_PATTERN, *PSIG_SCAN_PATTERN;
+
+typedef struct _SIG_SCAN_ENGINE {
+
+    //
+    //  Patterns added with SigScanAddPattern, consumed by SigScanCompile.
+    //
+
+    PSIG_SCAN_PATTERN  Patterns;
+    ULONG   PatternCount;
+    ULONG   PatternCapacity;
+
+    //
+    //  The compiled automaton. Transitions is a StateCount x 256 table
+    //  with every failure link already resolved, so the scan loop does
+    //  exactly one lookup per byte. Match holds (SignatureId + 1) of a
+    //  signature ending in each state, or 0.
+    //
+
+    BOOLEAN Compiled;
+    ULONG   StateCount;
+    PULONG  Transitions;
+    PULONG  Match;
+
+    //
+    //  Bytes which move the automaton out of its root state. While in the
+    //  root we can skip every other byte without a table lookup.
+    //
+
+    BOOLEAN StartByte[256];
+
+} SIG_SCAN_ENGINE, *PSIG_SCAN_ENGINE;
+
+typedef struct _SIG_SCAN_STREAM {
+
+    //
+    //  Current automaton state, carried from one chunk to the next.
+    //
+
+    ULONG   State;
+
+} SIG_SCAN_STREAM, *PSIG_SCAN_STREAM;
+
+HRESULT
+SigScanInitializeEngine (
+    _Out_ PSIG_SCAN_ENGINE Engine
+    );
+
+HRESULT
+SigScanAddPattern (
+    _Inout_ PSIG_SCAN_ENGINE Engine,
+    _In_reads_bytes_(Length) const UCHAR *Pattern,
+    _In_ ULONG Length,
+    _In_ ULONG SignatureId
+    );
+
+HRESULT
+SigScanCompile (
+    _Inout_ PSIG_SCAN_ENGINE Engine
+    );
+
+VOID
+SigScanFreeEngine (
+    _Inout_ PSIG_SCAN_ENGINE Engine
+    );
+
+VOID
+SigScanResetStream (
+    _Out_ PSIG_SCAN_STREAM Stream
+    );
+
+BOOLEAN
+SigScanStreamChunk (
+    _In_ const SIG_SCAN_ENGINE *Engine,
+    _Inout_ PSIG_SCAN_STREAM Stream,
+    _In_reads_bytes_(Size) const UCHAR *Buffer,
+    _In_ SIZE_T Size,
+    _Out_ PULONG SignatureId
+    );
+
+#endif
@@ -28,6 +28,7 @@ Environment:
 #include "utility.h"
 
 #define  USER_SCAN_THREAD_COUNT   6      // the number of scanning worker threads.
+#define  USER_SCAN_CHUNK_SIZE     0x10000 // the number of bytes scanned between abort checks.
 
 typedef struct _SCANNER_MESSAGE {
 
@@ -78,8 +79,14 @@ typedef struct _SCANNER_REPLY_MESSAGE {
 //  Local routines
 //
 
+HRESULT
+UserScanLoadSignatures (
+    _Inout_  PSIG_SCAN_ENGINE Engine
+    );
+
 AVSCAN_RESULT
 UserScanMemoryStream(
+    _In_                      const SIG_SCAN_ENGINE *Engine,
     _In_reads_bytes_(Size)    PUCHAR   StartingAddress,
     _In_                      SIZE_T   Size,
     _Inout_                   PBOOLEAN pAbort
@@ -168,6 +175,19 @@ Return Value:
         return MAKE_HRESULT(SEVERITY_ERROR, 0, E_POINTER);
     }
     
+    //
+    //  Compile the signature database once, it is shared by all the
+    //  scanning threads.
+    //
+    
+    hr = UserScanLoadSignatures( &Context->SignatureEngine );
+    
+    if (FAILED(hr)) {
+    
+        fprintf(stderr, "[UserScanInit]: Failed to load the signature database.\n");
+        goto Cleanup;
+    }
+    
     //
     //  Create the abort listening thead.
     //  This thread is particularly listening the abortion event.
@@ -355,6 +375,8 @@ Cleanup:
         DisplayError(HRESULT_FROM_WIN32(GetLastError()));
     }
     
+    SigScanFreeEngine( &Context->SignatureEngine );
+    
     return hr;
 }
 
@@ -630,52 +652,50 @@ Return Value:
     }
     HeapFree( GetProcessHeap(), 0, scanThreadCtxes );
     Context->ScanThreadCtxes = NULL;
+    
+    SigScanFreeEngine( &Context->SignatureEngine );
     return hr;
 }
 
-AVSCAN_RESULT
-UserScanMemoryStream(
-    _In_reads_bytes_(Size)    PUCHAR   StartingAddress,
-    _In_                      SIZE_T   Size,
-    _Inout_                   PBOOLEAN pAbort
+HRESULT
+UserScanLoadSignatures (
+    _Inout_  PSIG_SCAN_ENGINE Engine
     )
 /*++
 
 Routine Description:
 
-    This routine is a naive search for virus signiture. 
-    Note that this function is by no means efficient and scalable, but 
-    this is not the focus of this example. Thus, an anti-virus 
-    vendor may want to focus on and expand this function.
-
-    It will reset the abort flag if it is aborted.
+    This routine builds the signature engine from the signature database.
+    
+    This sample only ships the single encoded default pattern, which is 
+    decoded here once instead of on every scan. An anti-virus vendor would 
+    load its own database and call SigScanAddPattern(...) for each entry; 
+    the cost of a scan does not grow with the number of signatures.
 
 Arguments:
 
-    StartingAddress  - The starting address of the memory to be searched.
-    
-    Size   -  The size of the memory.
-    
-    pAbort  -  A pointer to a boolean that notifies the scanning should be canceled..
-    
-    Infected - TRUE if this file is infected. FALSE, otherwise.
+    Engine  - The signature engine to build.
 
 Return Value:
-    
-    S_OK.
-    
+
+    S_OK if successful. Otherwise, it returns a HRESULT error value.
+
 --*/
 {
-    ULONG i;
+    HRESULT hr = S_OK;
     UCHAR targetString[AV_DEFAULT_SEARCH_PATTERN_SIZE] = {0};
-    SIZE_T searchStringLength = AV_DEFAULT_SEARCH_PATTERN_SIZE-1;
+    ULONG searchStringLength = AV_DEFAULT_SEARCH_PATTERN_SIZE-1;
     ULONG ind;
-    PUCHAR p;
-    PUCHAR start = StartingAddress;
-    PUCHAR end = start + Size - searchStringLength;
+
+    hr = SigScanInitializeEngine( Engine );
+    
+    if (FAILED(hr)) {
+    
+        return hr;
+    }
 
     //
-    //  Decode the target pattern. We could decode only once and cache it.
+    //  Decode the target pattern.
     //
     
     CopyMemory( (PVOID) targetString, 
@@ -688,16 +708,73 @@ Return Value:
          
          targetString[ind] = ((UCHAR)targetString[ind]) ^ AV_DEFAULT_PATTERN_XOR_KEY;
     }
-    targetString[searchStringLength] = '\0';
+    
+    hr = SigScanAddPattern( Engine, targetString, searchStringLength, 0 );
+    
+    if (SUCCEEDED(hr)) {
+    
+        hr = SigScanCompile( Engine );
+    }
+    
+    if (FAILED(hr)) {
+    
+        SigScanFreeEngine( Engine );
+    }
+    
+    return hr;
+}
+
+AVSCAN_RESULT
+UserScanMemoryStream(
+    _In_                      const SIG_SCAN_ENGINE *Engine,
+    _In_reads_bytes_(Size)    PUCHAR   StartingAddress,
+    _In_                      SIZE_T   Size,
+    _Inout_                   PBOOLEAN pAbort
+    )
+/*++
+
+Routine Description:
+
+    This routine searches the memory for any signature in the database.
+    
+    The memory is fed through the signature engine in chunks, the engine
+    keeps its state across chunks so signatures which straddle a chunk
+    boundary are still found. The abort flag is polled once per chunk.
+
+    It will reset the abort flag if it is aborted.
+
+Arguments:
+
+    Engine  - The compiled signature engine.
+
+    StartingAddress  - The starting address of the memory to be searched.
+    
+    Size   -  The size of the memory.
+    
+    pAbort  -  A pointer to a boolean that notifies the scanning should be canceled..
+
+Return Value:
+    
+    AvScanResultInfected if a signature is found, AvScanResultClean if not,
+    AvScanResultUndetermined if the scan was aborted.
+    
+--*/
+{
+    SIG_SCAN_STREAM stream;
+    SIZE_T offset;
+    SIZE_T chunk;
+    ULONG signatureId;
+
+    SigScanResetStream( &stream );
     
     //
-    //  Scan the memory stream for the target pattern.
+    //  Scan the memory stream for the signatures.
     //  If not cancelled.
     //
     
-    for (p = start, i = 1;
-         p <= end ;
-         p++, i++) {
+    for (offset = 0;
+         offset < Size;
+         offset += chunk) {
 
         //
         //  If (*pAbort == TRUE), then we abort the scanning in the loop.
@@ -709,7 +786,13 @@ Return Value:
             return AvScanResultUndetermined;
         }
         
-        if ( !memcmp( p, targetString, searchStringLength )) {
+        chunk = min( Size - offset, USER_SCAN_CHUNK_SIZE );
+        
+        if (SigScanStreamChunk( Engine,
+                                &stream,
+                                StartingAddress + offset,
+                                chunk,
+                                &signatureId )) {
 
             return AvScanResultInfected;
         }
@@ -814,7 +897,8 @@ Return Value:
     //  Data scan here.
     //
 
-    commandMessage.ScanResult = UserScanMemoryStream( (PUCHAR)scanAddress, 
+    commandMessage.ScanResult = UserScanMemoryStream( &Context->SignatureEngine,
+                                                       (PUCHAR)scanAddress, 
                                                        memoryInfo.RegionSize,
                                                        &ThreadCtx->Aborted );
 
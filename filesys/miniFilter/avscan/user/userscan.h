@@ -23,6 +23,7 @@ Environment:
 #include <windows.h>
 #include <fltUser.h>
 #include "avlib.h"
+#include "sigscan.h"
 
 #ifndef MAKE_HRESULT
 #define MAKE_HRESULT(sev,fac,code) \
@@ -94,6 +95,12 @@ typedef struct _USER_SCAN_CONTEXT {
     //
     
     HANDLE   Completion;
+    
+    //
+    //  Compiled signature database, shared by all the scan threads
+    //
+    
+    SIG_SCAN_ENGINE  SignatureEngine;
 
 } USER_SCAN_CONTEXT, *PUSER_SCAN_CONTEXT;
     
@@ -116,6 +116,7 @@ Return Value:
     OBJECT_ATTRIBUTES oa;
     UNICODE_STRING uniString;
     NTSTATUS status = STATUS_SUCCESS;
+    ULONG i;
 
     try {
 
@@ -130,9 +131,20 @@ Return Value:
 
         MiniSpyData.DriverObject = DriverObject;
 
+        MiniSpyData.RecordsDropped = 0;
+
         InitializeListHead( &MiniSpyData.OutputBufferList );
         KeInitializeSpinLock( &MiniSpyData.OutputBufferLock );
 
+        for (i = 0; i < SPY_OUTPUT_LIST_COUNT; i++) {
+
+            InitializeListHead( &MiniSpyData.OutputLists[i].List );
+            KeInitializeSpinLock( &MiniSpyData.OutputLists[i].Lock );
+            InitializeListHead( &MiniSpyData.CollectLists[i] );
+        }
+
+        ExInitializeFastMutex( &MiniSpyData.CollectLock );
+
         ExInitializeNPagedLookasideList( &MiniSpyData.FreeBufferList,
                                          NULL,
                                          NULL,
@@ -569,6 +581,40 @@ Return Value:
                 status = STATUS_SUCCESS;
                 break;
 
+            case GetMiniSpyStatistics:
+
+                //
+                //  Return the counters kept by the MiniSpy filter driver.
+                //  The buffer is validated the same way as for
+                //  GetMiniSpyVersion.
+                //
+
+                if ((OutputBufferSize < sizeof( MINISPY_STATISTICS )) ||
+                    (OutputBuffer == NULL)) {
+
+                    status = STATUS_INVALID_PARAMETER;
+                    break;
+                }
+
+                if (!IS_ALIGNED(OutputBuffer,sizeof(ULONG))) {
+
+                    status = STATUS_DATATYPE_MISALIGNMENT;
+                    break;
+                }
+
+                try {
+
+                    ((PMINISPY_STATISTICS)OutputBuffer)->RecordsDropped = (ULONG)MiniSpyData.RecordsDropped;
+
+                } except (SpyExceptionFilter( GetExceptionInformation(), TRUE )) {
+
+                      return GetExceptionCode();
+                }
+
+                *ReturnOutputBufferLength = sizeof( MINISPY_STATISTICS );
+                status = STATUS_SUCCESS;
+                break;
+
             default:
                 status = STATUS_INVALID_PARAMETER;
                 break;
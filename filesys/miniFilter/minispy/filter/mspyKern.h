@@ -111,6 +111,25 @@ typedef enum _ECP_TYPE {
 
 #endif
 
+//
+//  Log records are queued on one of several output lists, chosen by the
+//  processor that logs them, so that logging on different processors does
+//  not contend on a single lock.  SpyGetLog merges them back in sequence
+//  number order.  Must be a power of 2.
+//
+//  Sequence numbers are assigned under the output list lock as a record is
+//  queued, so every output list is in sequence number order.
+//
+
+#define SPY_OUTPUT_LIST_COUNT   64
+
+typedef struct DECLSPEC_CACHEALIGN _SPY_OUTPUT_LIST {
+
+    KSPIN_LOCK Lock;
+    LIST_ENTRY List;
+
+} SPY_OUTPUT_LIST, *PSPY_OUTPUT_LIST;
+
 //---------------------------------------------------------------------------
 //      Global variables
 //---------------------------------------------------------------------------
@@ -143,12 +162,29 @@ typedef struct _MINISPY_DATA {
     PFLT_PORT ClientPort;
 
     //
-    //  List of buffers with data to send to user mode.
+    //  List of buffers with data to send to user mode, in sequence number
+    //  order.  Only SpyGetLog adds to this list, new records are queued on
+    //  OutputLists first.
     //
 
     KSPIN_LOCK OutputBufferLock;
     LIST_ENTRY OutputBufferList;
 
+    //
+    //  Per-processor lists of newly logged buffers.
+    //
+
+    SPY_OUTPUT_LIST OutputLists[SPY_OUTPUT_LIST_COUNT];
+
+    //
+    //  The output lists detached by SpyCollectOutputLists, waiting to be
+    //  merged.  These are too big for the kernel stack, CollectLock
+    //  serializes their use.
+    //
+
+    FAST_MUTEX CollectLock;
+    LIST_ENTRY CollectLists[SPY_OUTPUT_LIST_COUNT];
+
     //
     //  Lookaside list used for allocating buffers.
     //
@@ -162,6 +198,13 @@ typedef struct _MINISPY_DATA {
     LONG MaxRecordsToAllocate;
     __volatile LONG RecordsAllocated;
 
+    //
+    //  Number of records which were lost because neither a buffer nor the
+    //  static buffer was available.
+    //
+
+    __volatile LONG RecordsDropped;
+
     //
     //  static buffer used for sending an "out-of-memory" message
     //  to user mode.
@@ -390,6 +433,17 @@ SpyLog (
     _In_ PRECORD_LIST RecordList
     );
 
+VOID
+SpyAppendList (
+    _Inout_ PLIST_ENTRY Destination,
+    _Inout_ PLIST_ENTRY Source
+    );
+
+VOID
+SpyCollectOutputLists (
+    VOID
+    );
+
 NTSTATUS
 SpyGetLog (
     _Out_writes_bytes_to_(OutputBufferLength,*ReturnOutputBufferLength) PUCHAR OutputBuffer,
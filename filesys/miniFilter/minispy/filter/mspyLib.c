@@ -258,6 +258,10 @@ Return Value:
 
             newRecord = (PRECORD_LIST)MiniSpyData.OutOfMemoryBuffer;
             initialRecordType |= RECORD_TYPE_FLAG_STATIC;
+
+        } else {
+
+            InterlockedIncrement( &MiniSpyData.RecordsDropped );
         }
     }
 
@@ -273,7 +277,6 @@ Return Value:
 
         newRecord->LogRecord.RecordType = initialRecordType;
         newRecord->LogRecord.Length = sizeof(LOG_RECORD);
-        newRecord->LogRecord.SequenceNumber = InterlockedIncrement( &MiniSpyData.LogSequenceNumber );
         RtlZeroMemory( &newRecord->LogRecord.Data, sizeof( RECORD_DATA ) );
     }
 
@@ -1211,14 +1214,20 @@ SpyLog (
 Routine Description:
 
     This routine inserts the given log record into the list to be sent
-    to the user mode application.
+    to the user mode application.  The record is queued on the output list
+    of the current processor, so the lock is normally only shared with
+    SpyGetLog.  If the thread moves to another processor, this still works,
+    it just shares that list's lock with the other processor.
+
+    The record's sequence number is assigned here, under the list lock, so
+    the records on each output list stay in sequence number order.
 
     NOTE:  This code must be NON-PAGED because it can be called on the
            paging path or at DPC level and uses a spin-lock
 
 Arguments:
 
-    RecordList - The record to append to the MiniSpyData.OutputBufferList
+    RecordList - The record to append to the MiniSpyData.OutputLists
 
 Return Value:
 
@@ -1228,11 +1237,163 @@ Return Value:
 
 --*/
 {
+    PSPY_OUTPUT_LIST outputList;
     KIRQL oldIrql;
 
-    KeAcquireSpinLock(&MiniSpyData.OutputBufferLock, &oldIrql);
-    InsertTailList(&MiniSpyData.OutputBufferList, &RecordList->List);
-    KeReleaseSpinLock(&MiniSpyData.OutputBufferLock, oldIrql);
+#if MINISPY_WIN7
+    outputList = &MiniSpyData.OutputLists[KeGetCurrentProcessorNumberEx( NULL ) & (SPY_OUTPUT_LIST_COUNT - 1)];
+#else
+    outputList = &MiniSpyData.OutputLists[KeGetCurrentProcessorNumber() & (SPY_OUTPUT_LIST_COUNT - 1)];
+#endif
+
+    KeAcquireSpinLock(&outputList->Lock, &oldIrql);
+    RecordList->LogRecord.SequenceNumber = InterlockedIncrement( &MiniSpyData.LogSequenceNumber );
+    InsertTailList(&outputList->List, &RecordList->List);
+    KeReleaseSpinLock(&outputList->Lock, oldIrql);
+}
+
+
+VOID
+SpyAppendList (
+    _Inout_ PLIST_ENTRY Destination,
+    _Inout_ PLIST_ENTRY Source
+    )
+/*++
+
+Routine Description:
+
+    This routine moves all the entries of Source to the tail of Destination
+    and leaves Source empty.
+
+Arguments:
+
+    Destination - The list to append to.
+
+    Source - The list to move the entries from.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    if (!IsListEmpty( Source )) {
+
+        Source->Flink->Blink = Destination->Blink;
+        Destination->Blink->Flink = Source->Flink;
+        Source->Blink->Flink = Destination;
+        Destination->Blink = Source->Blink;
+
+        InitializeListHead( Source );
+    }
+}
+
+
+VOID
+SpyCollectOutputLists (
+    VOID
+    )
+/*++
+
+Routine Description:
+
+    This routine moves the records logged on every processor to
+    MiniSpyData.OutputBufferList.  Each per-processor list is detached as a
+    whole, so its lock is only held for a few instructions, and the lists
+    are then merged by sequence number.  Each list is already in sequence
+    number order (see SpyLog), so the records collected by one call reach
+    user mode in the order they were logged.  A record that is queued while
+    the lists are being detached can still be collected by the next call,
+    after records with higher sequence numbers.
+
+    The detached lists are kept in MiniSpyData.CollectLists, so this must
+    be called below DISPATCH_LEVEL to acquire MiniSpyData.CollectLock.
+
+    NOTE:  This code must be NON-PAGED because it uses a spin-lock.
+
+Arguments:
+
+    None.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    PLIST_ENTRY pending = MiniSpyData.CollectLists;
+    LIST_ENTRY merged;
+    PRECORD_LIST pRecordList;
+    PLIST_ENTRY oldest;
+    ULONG oldestSequence;
+    KIRQL oldIrql;
+    ULONG i;
+
+    InitializeListHead( &merged );
+
+    ExAcquireFastMutex( &MiniSpyData.CollectLock );
+
+    for (i = 0; i < SPY_OUTPUT_LIST_COUNT; i++) {
+
+        FLT_ASSERT(IsListEmpty( &pending[i] ));
+
+        //
+        //  Peek without the lock, a record that is being queued right now
+        //  is picked up by the next call.
+        //
+
+        if (IsListEmpty( &MiniSpyData.OutputLists[i].List )) {
+
+            continue;
+        }
+
+        KeAcquireSpinLock( &MiniSpyData.OutputLists[i].Lock, &oldIrql );
+        SpyAppendList( &pending[i], &MiniSpyData.OutputLists[i].List );
+        KeReleaseSpinLock( &MiniSpyData.OutputLists[i].Lock, oldIrql );
+    }
+
+    for (;;) {
+
+        oldest = NULL;
+        oldestSequence = 0;
+
+        for (i = 0; i < SPY_OUTPUT_LIST_COUNT; i++) {
+
+            if (IsListEmpty( &pending[i] )) {
+
+                continue;
+            }
+
+            pRecordList = CONTAINING_RECORD( pending[i].Flink, RECORD_LIST, List );
+
+            //
+            //  Sequence numbers wrap, compare them by their difference.
+            //
+
+            if ((oldest == NULL) ||
+                ((LONG)(pRecordList->LogRecord.SequenceNumber - oldestSequence) < 0)) {
+
+                oldest = &pending[i];
+                oldestSequence = pRecordList->LogRecord.SequenceNumber;
+            }
+        }
+
+        if (oldest == NULL) {
+
+            break;
+        }
+
+        InsertTailList( &merged, RemoveHeadList( oldest ) );
+    }
+
+    if (!IsListEmpty( &merged )) {
+
+        KeAcquireSpinLock( &MiniSpyData.OutputBufferLock, &oldIrql );
+        SpyAppendList( &MiniSpyData.OutputBufferList, &merged );
+        KeReleaseSpinLock( &MiniSpyData.OutputBufferLock, oldIrql );
+    }
+
+    ExReleaseFastMutex( &MiniSpyData.CollectLock );
 }
 
 
@@ -1278,6 +1439,8 @@ Return Value:
     KIRQL oldIrql;
     BOOLEAN recordsAvailable = FALSE;
 
+    SpyCollectOutputLists();
+
     KeAcquireSpinLock( &MiniSpyData.OutputBufferLock, &oldIrql );
 
     while (!IsListEmpty( &MiniSpyData.OutputBufferList ) && (OutputBufferLength > 0)) {
@@ -1400,7 +1563,7 @@ SpyEmptyOutputBufferList (
 
 Routine Description:
 
-    This routine frees all the remaining log records in the OutputBufferList
+    This routine frees all the remaining log records in the output lists
     that are not going to get sent up to the user mode application since
     MiniSpy is shutting down.
 
@@ -1420,6 +1583,8 @@ Return Value:
     PRECORD_LIST pRecordList;
     KIRQL oldIrql;
 
+    SpyCollectOutputLists();
+
     KeAcquireSpinLock( &MiniSpyData.OutputBufferLock, &oldIrql );
 
     while (!IsListEmpty( &MiniSpyData.OutputBufferList )) {
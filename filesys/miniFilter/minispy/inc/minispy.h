@@ -183,10 +183,21 @@ typedef struct _RECORD_LIST {
 typedef enum _MINISPY_COMMAND {
 
     GetMiniSpyLog,
-    GetMiniSpyVersion
+    GetMiniSpyVersion,
+    GetMiniSpyStatistics
 
 } MINISPY_COMMAND;
 
+//
+//  Counters returned by the GetMiniSpyStatistics command.
+//
+
+typedef struct _MINISPY_STATISTICS {
+
+    ULONG RecordsDropped;   // Records lost because no buffer was available
+
+} MINISPY_STATISTICS, *PMINISPY_STATISTICS;
+
 //
 //  Defines the command structure between the utility and the filter.
 //
@@ -54,6 +54,11 @@ ListDevices (
     VOID
     );
 
+VOID
+ShowStatistics (
+    _In_ PLOG_CONTEXT Context
+    );
+
 VOID
 DisplayError (
    _In_ DWORD Code
@@ -640,6 +645,16 @@ Return Value:
                 }
                 break;
 
+            case 'c':
+            case 'C':
+
+                //
+                // Show the counters kept by the filter
+                //
+
+                ShowStatistics( Context );
+                break;
+
             case 'l':
             case 'L':
 
@@ -762,9 +777,10 @@ InterpretCommand_Exit:
     return returnValue;
 
 InterpretCommand_Usage:
-    printf("Valid switches: [/a <drive>] [/d <drive>] [/l] [/s] [/f [<file name>]]\n"
+    printf("Valid switches: [/a <drive>] [/d <drive>] [/c] [/l] [/s] [/f [<file name>]]\n"
            "    [/a <drive>] starts monitoring <drive>\n"
            "    [/d <drive> [<instance id>]] detaches filter <instance id> from <drive>\n"
+           "    [/c] shows the number of records the filter had to drop\n"
            "    [/l] lists all the drives the monitor is currently attached to\n"
            "    [/s] turns on and off showing logging output on the screen\n"
            "    [/f [<file name>]] turns on and off logging to the specified file\n"
@@ -977,3 +993,52 @@ Return Value:
     }
 }
 
+
+VOID
+ShowStatistics (
+    _In_ PLOG_CONTEXT Context
+    )
+/*++
+
+Routine Description:
+
+    Display the counters kept by the filter
+
+Arguments:
+
+    Context - The log context holding the port connected to the filter
+
+Return Value:
+
+--*/
+{
+    COMMAND_MESSAGE commandMessage;
+    MINISPY_STATISTICS statistics;
+    DWORD bytesReturned = 0;
+    HRESULT hResult;
+
+    commandMessage.Command = GetMiniSpyStatistics;
+
+    hResult = FilterSendMessage( Context->Port,
+                                 &commandMessage,
+                                 sizeof( COMMAND_MESSAGE ),
+                                 &statistics,
+                                 sizeof( statistics ),
+                                 &bytesReturned );
+
+    if (IS_ERROR( hResult )) {
+
+        printf( "    Could not get statistics: 0x%08x\n", hResult );
+        DisplayError( hResult );
+        return;
+    }
+
+    if (bytesReturned < sizeof( statistics )) {
+
+        printf( "    The filter did not return statistics\n" );
+        return;
+    }
+
+    printf( "    Records dropped: %u\n", statistics.RecordsDropped );
+}
+
@@ -47,6 +47,35 @@ PFLT_FILTER gFilterHandle;
     Local structures
 *************************************************************************/
 
+//
+//  READ and WRITE swap buffers are taken from size classed lookaside lists
+//  kept in the volume context so the common transfer sizes do not go back
+//  to pool for every operation.  Lookaside entries of a page or more are
+//  page aligned, which satisfies the alignment requirement of any device
+//  we can attach to.  Transfers larger than the biggest class are still
+//  allocated from pool.
+//
+//  The largest class is not a lookaside list.  A lookaside list picks its
+//  own depth, and at 256KB an entry that can leave tens of megabytes of
+//  nonpaged pool cached on every volume.  Instead each volume keeps at
+//  most SWAP_BUFFER_LARGE_DEPTH of these buffers.
+//
+
+#define SWAP_BUFFER_CLASS_COUNT     4
+#define SWAP_BUFFER_LOOKASIDE_COUNT (SWAP_BUFFER_CLASS_COUNT - 1)
+#define SWAP_BUFFER_CLASS_LARGE     SWAP_BUFFER_LOOKASIDE_COUNT
+#define SWAP_BUFFER_CLASS_NONE      ((ULONG)-1)
+
+#define SWAP_BUFFER_LARGE_DEPTH     2
+
+CONST ULONG SwapBufferClassSize[SWAP_BUFFER_CLASS_COUNT] = {
+
+    0x1000,                         //  4KB
+    0x4000,                         //  16KB
+    0x10000,                        //  64KB
+    0x40000                         //  256KB
+};
+
 //
 //  This is a volume context, one of these are attached to each volume
 //  we monitor.  This is used to get a "DOS" name for debug display.
@@ -66,6 +95,25 @@ typedef struct _VOLUME_CONTEXT {
 
     ULONG SectorSize;
 
+    //
+    //  Number of entries in BufferLists that have been initialized.
+    //
+
+    ULONG BufferClassCount;
+
+    //
+    //  Lookaside lists of swap buffers, one for each entry in
+    //  SwapBufferClassSize except the largest.
+    //
+
+    LOOKASIDE_LIST_EX BufferLists[SWAP_BUFFER_LOOKASIDE_COUNT];
+
+    //
+    //  Cached buffers of the largest size class.  Empty slots are NULL.
+    //
+
+    PVOID LargeBuffers[SWAP_BUFFER_LARGE_DEPTH];
+
 } VOLUME_CONTEXT, *PVOLUME_CONTEXT;
 
 #define MIN_SECTOR_SIZE 0x200
@@ -95,6 +143,13 @@ typedef struct _PRE_2_POST_CONTEXT {
 
     PVOID SwappedBuffer;
 
+    //
+    //  The size class SwappedBuffer was taken from, or SWAP_BUFFER_CLASS_NONE
+    //  if it came from pool.  This is only used for READ and WRITE.
+    //
+
+    ULONG SwappedBufferClass;
+
 } PRE_2_POST_CONTEXT, *PPRE_2_POST_CONTEXT;
 
 //
@@ -205,6 +260,22 @@ ReadDriverParameters (
     _In_ PUNICODE_STRING RegistryPath
     );
 
+PVOID
+SwapAllocateBuffer (
+    _In_ PCFLT_RELATED_OBJECTS FltObjects,
+    _In_ PVOLUME_CONTEXT VolCtx,
+    _In_ ULONG Length,
+    _Out_ PULONG BufferClass
+    );
+
+VOID
+SwapFreeBuffer (
+    _In_ PCFLT_RELATED_OBJECTS FltObjects,
+    _In_ PVOLUME_CONTEXT VolCtx,
+    _In_ PVOID Buffer,
+    _In_ ULONG BufferClass
+    );
+
 //
 //  Assign text sections for each routine.
 //
@@ -385,6 +456,15 @@ Return Value:
             leave;
         }
 
+        //
+        //  None of the swap buffer lookaside lists are set up yet and no
+        //  large buffers are cached.  The context cleanup routine relies on
+        //  both.
+        //
+
+        ctx->BufferClassCount = 0;
+        RtlZeroMemory( ctx->LargeBuffers, sizeof(ctx->LargeBuffers) );
+
         //
         //  Always get the volume properties, so I can get a sector size
         //
@@ -409,6 +489,31 @@ Return Value:
 
         ctx->SectorSize = max(volProp->SectorSize,MIN_SECTOR_SIZE);
 
+        //
+        //  Set up the swap buffer lookaside lists.  If one can not be
+        //  initialized, transfers of that size and larger simply allocate
+        //  their swap buffer from pool.
+        //
+
+        while (ctx->BufferClassCount < SWAP_BUFFER_LOOKASIDE_COUNT) {
+
+            status = ExInitializeLookasideListEx( &ctx->BufferLists[ctx->BufferClassCount],
+                                                  NULL,
+                                                  NULL,
+                                                  NonPagedPool,
+                                                  0,
+                                                  SwapBufferClassSize[ctx->BufferClassCount],
+                                                  BUFFER_SWAP_TAG,
+                                                  0 );
+
+            if (!NT_SUCCESS(status)) {
+
+                break;
+            }
+
+            ctx->BufferClassCount += 1;
+        }
+
         //
         //  Init the buffer field (which may be allocated later).
         //
@@ -571,7 +676,10 @@ CleanupVolumeContext(
 Routine Description:
 
     The given context is being freed.
-    Free the allocated name buffer if there one.
+    Free the allocated name buffer if there one and delete the swap buffer
+    lookaside lists.  Every operation that took a swap buffer holds a
+    reference to the context until it has returned it, so the lists are
+    not in use here.
 
 Arguments:
 
@@ -586,6 +694,7 @@ Return Value:
 --*/
 {
     PVOLUME_CONTEXT ctx = Context;
+    ULONG i;
 
     PAGED_CODE();
 
@@ -598,6 +707,21 @@ Return Value:
         ExFreePool(ctx->Name.Buffer);
         ctx->Name.Buffer = NULL;
     }
+
+    for (i = 0; i < SWAP_BUFFER_LARGE_DEPTH; i++) {
+
+        if (ctx->LargeBuffers[i] != NULL) {
+
+            ExFreePoolWithTag( ctx->LargeBuffers[i], BUFFER_SWAP_TAG );
+            ctx->LargeBuffers[i] = NULL;
+        }
+    }
+
+    while (ctx->BufferClassCount > 0) {
+
+        ctx->BufferClassCount -= 1;
+        ExDeleteLookasideListEx( &ctx->BufferLists[ctx->BufferClassCount] );
+    }
 }
 
 
@@ -815,6 +939,7 @@ Return Value:
     PPRE_2_POST_CONTEXT p2pCtx;
     NTSTATUS status;
     ULONG readLen = iopb->Parameters.Read.Length;
+    ULONG bufClass = SWAP_BUFFER_CLASS_NONE;
 
     try {
 
@@ -859,16 +984,16 @@ Return Value:
         }
 
         //
-        //  Allocate aligned nonPaged memory for the buffer we are swapping
-        //  to. This is really only necessary for noncached IO but we always
-        //  do it here for simplification. If we fail to get the memory, just
+        //  Get aligned nonPaged memory for the buffer we are swapping to.
+        //  This is really only necessary for noncached IO but we always do
+        //  it here for simplification. If we fail to get the memory, just
         //  don't swap buffers on this operation.
         //
 
-        newBuf = FltAllocatePoolAlignedWithTag( FltObjects->Instance, 
-                                                NonPagedPool,
-                                                (SIZE_T) readLen,
-                                                BUFFER_SWAP_TAG );
+        newBuf = SwapAllocateBuffer( FltObjects,
+                                     volCtx,
+                                     readLen,
+                                     &bufClass );
         if (newBuf == NULL) {
 
             LOG_PRINT( LOGFL_ERRORS,
@@ -958,6 +1083,7 @@ Return Value:
         //
 
         p2pCtx->SwappedBuffer = newBuf;
+        p2pCtx->SwappedBufferClass = bufClass;
         p2pCtx->VolCtx = volCtx;
 
         *CompletionContext = p2pCtx;
@@ -978,9 +1104,10 @@ Return Value:
 
             if (newBuf != NULL) {
 
-                FltFreePoolAlignedWithTag( FltObjects->Instance,
-                                           newBuf,
-                                           BUFFER_SWAP_TAG );
+                SwapFreeBuffer( FltObjects,
+                                volCtx,
+                                newBuf,
+                                bufClass );
             }
 
             if (newMdl != NULL) {
@@ -1209,9 +1336,10 @@ Return Value:
                         p2pCtx->SwappedBuffer,
                         Data->IoStatus.Information) );
 
-            FltFreePoolAlignedWithTag( FltObjects->Instance,
-                                       p2pCtx->SwappedBuffer,
-                                       BUFFER_SWAP_TAG );
+            SwapFreeBuffer( FltObjects,
+                            p2pCtx->VolCtx,
+                            p2pCtx->SwappedBuffer,
+                            p2pCtx->SwappedBufferClass );
 
             FltReleaseContext( p2pCtx->VolCtx );
 
@@ -1334,9 +1462,10 @@ Return Value:
                 p2pCtx->SwappedBuffer,
                 Data->IoStatus.Information) );
 
-    FltFreePoolAlignedWithTag( FltObjects->Instance,
-                               p2pCtx->SwappedBuffer,
-                               BUFFER_SWAP_TAG );
+    SwapFreeBuffer( FltObjects,
+                    p2pCtx->VolCtx,
+                    p2pCtx->SwappedBuffer,
+                    p2pCtx->SwappedBufferClass );
 
     FltReleaseContext( p2pCtx->VolCtx );
 
@@ -1947,6 +2076,7 @@ Return Value:
     PVOID origBuf;
     NTSTATUS status;
     ULONG writeLen = iopb->Parameters.Write.Length;
+    ULONG bufClass = SWAP_BUFFER_CLASS_NONE;
 
     try {
 
@@ -1991,16 +2121,16 @@ Return Value:
         }
 
         //
-        //  Allocate aligned nonPaged memory for the buffer we are swapping
-        //  to. This is really only necessary for noncached IO but we always
-        //  do it here for simplification. If we fail to get the memory, just
+        //  Get aligned nonPaged memory for the buffer we are swapping to.
+        //  This is really only necessary for noncached IO but we always do
+        //  it here for simplification. If we fail to get the memory, just
         //  don't swap buffers on this operation.
         //
 
-        newBuf = FltAllocatePoolAlignedWithTag( FltObjects->Instance, 
-                                                NonPagedPool,
-                                                (SIZE_T) writeLen,
-                                                BUFFER_SWAP_TAG );
+        newBuf = SwapAllocateBuffer( FltObjects,
+                                     volCtx,
+                                     writeLen,
+                                     &bufClass );
 
         if (newBuf == NULL) {
 
@@ -2160,6 +2290,7 @@ Return Value:
         //
 
         p2pCtx->SwappedBuffer = newBuf;
+        p2pCtx->SwappedBufferClass = bufClass;
         p2pCtx->VolCtx = volCtx;
 
         *CompletionContext = p2pCtx;
@@ -2181,10 +2312,10 @@ Return Value:
 
             if (newBuf != NULL) {
 
-                FltFreePoolAlignedWithTag( FltObjects->Instance,
-                                           newBuf,
-                                           BUFFER_SWAP_TAG );
-
+                SwapFreeBuffer( FltObjects,
+                                volCtx,
+                                newBuf,
+                                bufClass );
             }
 
             if (newMdl != NULL) {
@@ -2237,9 +2368,10 @@ Return Value:
     //  Free allocate POOL and volume context
     //
 
-    FltFreePoolAlignedWithTag( FltObjects->Instance,
-                               p2pCtx->SwappedBuffer,
-                               BUFFER_SWAP_TAG );
+    SwapFreeBuffer( FltObjects,
+                    p2pCtx->VolCtx,
+                    p2pCtx->SwappedBuffer,
+                    p2pCtx->SwappedBufferClass );
 
     FltReleaseContext( p2pCtx->VolCtx );
 
@@ -2250,6 +2382,164 @@ Return Value:
 }
 
 
+/*************************************************************************
+    Swap buffer support routines.
+*************************************************************************/
+
+PVOID
+SwapAllocateBuffer (
+    _In_ PCFLT_RELATED_OBJECTS FltObjects,
+    _In_ PVOLUME_CONTEXT VolCtx,
+    _In_ ULONG Length,
+    _Out_ PULONG BufferClass
+    )
+/*++
+
+Routine Description:
+
+    This routine gets a swap buffer of at least the given length for a READ
+    or WRITE operation.  The buffer is taken from the smallest lookaside
+    list on the volume that can hold it, from the volume's cache of large
+    buffers, or from pool if the length is larger than all of the size
+    classes.
+
+Arguments:
+
+    FltObjects - Pointer to the FLT_RELATED_OBJECTS data structure containing
+        opaque handles to this filter, instance and its associated volume.
+
+    VolCtx - The volume context holding the lookaside lists.
+
+    Length - The number of bytes needed.
+
+    BufferClass - Receives the size class the buffer was taken from.  This
+        must be passed to SwapFreeBuffer along with the buffer.
+
+Return Value:
+
+    The buffer, or NULL if one could not be allocated.
+
+--*/
+{
+    PVOID buffer;
+    ULONG i;
+
+    for (i = 0; i < VolCtx->BufferClassCount; i++) {
+
+        if (Length <= SwapBufferClassSize[i]) {
+
+            *BufferClass = i;
+            return ExAllocateFromLookasideListEx( &VolCtx->BufferLists[i] );
+        }
+    }
+
+    //
+    //  Only use the large class when all of the smaller classes are there,
+    //  otherwise small transfers would be given a 256KB buffer.
+    //
+
+    if ((VolCtx->BufferClassCount == SWAP_BUFFER_LOOKASIDE_COUNT) &&
+        (Length <= SwapBufferClassSize[SWAP_BUFFER_CLASS_LARGE])) {
+
+        *BufferClass = SWAP_BUFFER_CLASS_LARGE;
+
+        for (i = 0; i < SWAP_BUFFER_LARGE_DEPTH; i++) {
+
+            buffer = InterlockedExchangePointer( &VolCtx->LargeBuffers[i],
+                                                 NULL );
+
+            if (buffer != NULL) {
+
+                return buffer;
+            }
+        }
+
+        //
+        //  Pool allocations of a page or more are page aligned, the same
+        //  as the lookaside entries.
+        //
+
+        return ExAllocatePoolWithTag( NonPagedPool,
+                                      SwapBufferClassSize[SWAP_BUFFER_CLASS_LARGE],
+                                      BUFFER_SWAP_TAG );
+    }
+
+    *BufferClass = SWAP_BUFFER_CLASS_NONE;
+
+    return FltAllocatePoolAlignedWithTag( FltObjects->Instance,
+                                          NonPagedPool,
+                                          (SIZE_T) Length,
+                                          BUFFER_SWAP_TAG );
+}
+
+
+VOID
+SwapFreeBuffer (
+    _In_ PCFLT_RELATED_OBJECTS FltObjects,
+    _In_ PVOLUME_CONTEXT VolCtx,
+    _In_ PVOID Buffer,
+    _In_ ULONG BufferClass
+    )
+/*++
+
+Routine Description:
+
+    This routine returns a buffer obtained from SwapAllocateBuffer.
+
+Arguments:
+
+    FltObjects - Pointer to the FLT_RELATED_OBJECTS data structure containing
+        opaque handles to this filter, instance and its associated volume.
+
+    VolCtx - The volume context the buffer was allocated against.
+
+    Buffer - The buffer to free.
+
+    BufferClass - The size class returned when the buffer was allocated.
+
+Return Value:
+
+    None
+
+--*/
+{
+    ULONG i;
+
+    if (BufferClass == SWAP_BUFFER_CLASS_NONE) {
+
+        FltFreePoolAlignedWithTag( FltObjects->Instance,
+                                   Buffer,
+                                   BUFFER_SWAP_TAG );
+
+    } else if (BufferClass == SWAP_BUFFER_CLASS_LARGE) {
+
+        //
+        //  Keep the buffer if there is an empty slot, otherwise the volume
+        //  already caches as many large buffers as it is allowed to.
+        //
+
+        for (i = 0; i < SWAP_BUFFER_LARGE_DEPTH; i++) {
+
+            if (InterlockedCompareExchangePointer( &VolCtx->LargeBuffers[i],
+                                                   Buffer,
+                                                   NULL ) == NULL) {
+
+                return;
+            }
+        }
+
+        ExFreePoolWithTag( Buffer, BUFFER_SWAP_TAG );
+
+    } else {
+
+        FLT_ASSERT(BufferClass < VolCtx->BufferClassCount);
+
+        ExFreeToLookasideListEx( &VolCtx->BufferLists[BufferClass],
+                                 Buffer );
+    }
+}
+
+
 VOID
 ReadDriverParameters (
     _In_ PUNICODE_STRING RegistryPath
@@ -64,6 +64,9 @@ typedef struct _HID_DATA {
    ULONG       ReportID;    // ReportID for this given data structure
    BOOLEAN     IsDataSet;   // Variable to track whether a given data structure
                             //  has already been added to a report structure
+   BOOLEAN     IsCompiled;  // Set by CompileReportLayout when the position of
+                            //  this data in the report is known, so it can be
+                            //  read and written without the HidP_ functions
 
    union {
       struct {
@@ -71,6 +74,8 @@ typedef struct _HID_DATA {
          ULONG       UsageMax;       // If equal, then only a single usage
          ULONG       MaxUsageLength; // Usages buffer length.
          PUSAGE      Usages;         // list of usages (buttons ``down'' on the device.
+         PULONG      UsageBits;      // Report bit of each usage from UsageMin
+                                     //  to UsageMax, when IsCompiled
 
       } ButtonData;
       struct {
@@ -79,6 +84,13 @@ typedef struct _HID_DATA {
 
          ULONG       Value;
          LONG        ScaledValue;
+
+         ULONG       BitOffset;   // Position and size of the value in the
+         USHORT      BitSize;     //  report, when IsCompiled
+         LONG        LogicalMin;
+         LONG        LogicalMax;
+         LONG        PhysicalMin;
+         LONG        PhysicalMax;
       } ValueData;
    };
 } HID_DATA, *PHID_DATA;
@@ -187,6 +199,25 @@ PackReport (
    IN       PHIDP_PREPARSED_DATA Ppd
    );
 
+VOID
+CompileReportLayout (
+   IN       HIDP_REPORT_TYPE     ReportType,
+   IN OUT   PHID_DATA            Data,
+   IN       ULONG                DataLength,
+   IN       PHIDP_BUTTON_CAPS    ButtonCaps,
+   IN       USHORT               NumberButtonCaps,
+   IN       PHIDP_VALUE_CAPS     ValueCaps,
+   IN       USHORT               NumberValueCaps,
+   IN       USHORT               ReportBufferLength,
+   IN       PHIDP_PREPARSED_DATA Ppd
+   );
+
+VOID
+FreeReportLayout (
+   IN OUT   PHID_DATA            Data,
+   IN       ULONG                DataLength
+   );
+
 BOOLEAN
 SetFeature (
    PHID_DEVICE    HidDevice
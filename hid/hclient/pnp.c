@@ -868,6 +868,43 @@ FillDeviceInfo(
         }
     }
     
+    //
+    // Now that the HID_DATA arrays are built, work out where each item lives
+    // in its report so reads and writes do not have to look every item up
+    // in the preparsed data.  Items that cannot be compiled keep using the
+    // HidP_ functions, so failures here are not fatal.
+    //
+
+    CompileReportLayout (HidP_Input,
+                         HidDevice->InputData,
+                         HidDevice->InputDataLength,
+                         HidDevice->InputButtonCaps,
+                         HidDevice->Caps.NumberInputButtonCaps,
+                         HidDevice->InputValueCaps,
+                         HidDevice->Caps.NumberInputValueCaps,
+                         HidDevice->Caps.InputReportByteLength,
+                         HidDevice->Ppd);
+
+    CompileReportLayout (HidP_Output,
+                         HidDevice->OutputData,
+                         HidDevice->OutputDataLength,
+                         HidDevice->OutputButtonCaps,
+                         HidDevice->Caps.NumberOutputButtonCaps,
+                         HidDevice->OutputValueCaps,
+                         HidDevice->Caps.NumberOutputValueCaps,
+                         HidDevice->Caps.OutputReportByteLength,
+                         HidDevice->Ppd);
+
+    CompileReportLayout (HidP_Feature,
+                         HidDevice->FeatureData,
+                         HidDevice->FeatureDataLength,
+                         HidDevice->FeatureButtonCaps,
+                         HidDevice->Caps.NumberFeatureButtonCaps,
+                         HidDevice->FeatureValueCaps,
+                         HidDevice->Caps.NumberFeatureValueCaps,
+                         HidDevice->Caps.FeatureReportByteLength,
+                         HidDevice->Ppd);
+
     bRet = TRUE;
 
 Done:
@@ -924,6 +961,7 @@ CloseHidDevice (
 
     if (NULL != HidDevice -> InputData)
     {
+        FreeReportLayout(HidDevice -> InputData, HidDevice -> InputDataLength);
         free(HidDevice -> InputData);
         HidDevice -> InputData = NULL;
     }
@@ -948,6 +986,7 @@ CloseHidDevice (
 
     if (NULL != HidDevice -> OutputData)
     {
+        FreeReportLayout(HidDevice -> OutputData, HidDevice -> OutputDataLength);
         free(HidDevice -> OutputData);
         HidDevice -> OutputData = NULL;
     }
@@ -972,6 +1011,7 @@ CloseHidDevice (
 
     if (NULL != HidDevice -> FeatureData) 
     {
+        FreeReportLayout(HidDevice -> FeatureData, HidDevice -> FeatureDataLength);
         free(HidDevice -> FeatureData);
         HidDevice -> FeatureData = NULL;
     }
@@ -22,6 +22,27 @@ Environment:
 #include "hidsdi.h"
 #include "hid.h"
 
+//
+// Array(0)/Variable(1) bit of the main item flags in HIDP_BUTTON_CAPS.BitField
+//
+#define MAIN_ITEM_VARIABLE  0x02
+
+BOOLEAN
+UnpackCompiledData (
+   _In_reads_bytes_(ReportBufferLength)PCHAR ReportBuffer,
+   IN       USHORT               ReportBufferLength,
+   IN       HIDP_REPORT_TYPE     ReportType,
+   IN OUT   PHID_DATA            Data,
+   IN       PHIDP_PREPARSED_DATA Ppd
+   );
+
+BOOLEAN
+PackCompiledData (
+   _Inout_updates_bytes_(ReportBufferLength)PCHAR ReportBuffer,
+   IN       USHORT               ReportBufferLength,
+   IN       PHID_DATA            Data
+   );
+
 
 BOOLEAN
 Read (
@@ -376,6 +397,23 @@ Routine Description:
     {
         if (reportID == Data->ReportID) 
         {
+            /*
+            // If the layout of this data was compiled, pull it straight out
+            //    of the report.  Anything the compiled path cannot decode is
+            //    left to the HidP_ functions below.
+            */
+
+            if (Data->IsCompiled &&
+                UnpackCompiledData (ReportBuffer,
+                                    ReportBufferLength,
+                                    ReportType,
+                                    Data,
+                                    Ppd))
+            {
+                Data -> IsDataSet = TRUE;
+                continue;
+            }
+
             if (Data->IsButtonData) 
             {
                 numUsages = Data->ButtonData.MaxUsageLength;
@@ -546,6 +584,12 @@ Routine Description:
 
         if (Data -> ReportID == CurrReportID) 
         {
+            if (Data->IsCompiled &&
+                PackCompiledData (ReportBuffer, ReportBufferLength, Data))
+            {
+                continue;
+            }
+
             if (Data->IsButtonData) 
             {
                 numUsages = Data->ButtonData.MaxUsageLength;
@@ -599,3 +643,541 @@ Done:
     return result;
 }
 
+BOOLEAN
+FindReportBits (
+   _In_reads_bytes_(ReportBufferLength)PUCHAR ReportBuffer,
+   IN       USHORT               ReportBufferLength,
+   OUT      PULONG               BitOffset,
+   OUT      PULONG               BitCount
+   )
+/*++
+Routine Description:
+   Given a report that was built from a zeroed buffer by setting a single
+   data item, find the bits that item occupies.  The report ID byte is not
+   considered.  Returns FALSE unless the set bits form one contiguous run.
+--*/
+{
+    ULONG   bit;
+    ULONG   first = 0;
+    ULONG   last = 0;
+    ULONG   count = 0;
+
+    for (bit = 8; bit < (ULONG) ReportBufferLength * 8; bit++)
+    {
+        if (ReportBuffer[bit >> 3] & (1 << (bit & 7)))
+        {
+            if (0 == count)
+            {
+                first = bit;
+            }
+            last = bit;
+            count++;
+        }
+    }
+
+    if (0 == count || last - first + 1 != count)
+    {
+        return (FALSE);
+    }
+
+    *BitOffset = first;
+    *BitCount = count;
+
+    return (TRUE);
+}
+
+BOOLEAN
+CompileButtonData (
+   IN       HIDP_REPORT_TYPE     ReportType,
+   IN OUT   PHID_DATA            Data,
+   IN       PHIDP_BUTTON_CAPS    ButtonCaps,
+   _Inout_updates_bytes_(ReportBufferLength)PCHAR ProbeBuffer,
+   IN       USHORT               ReportBufferLength,
+   IN       PHIDP_PREPARSED_DATA Ppd
+   )
+/*++
+Routine Description:
+   Find the report bit of every usage in a bitmap of buttons by setting each
+   usage on its own in an empty report.  Array buttons report usage indices
+   rather than bits, so they are not compiled.
+--*/
+{
+    ULONG   numUsages;
+    ULONG   count;
+    ULONG   bitCount;
+    ULONG   Index;
+    USAGE   usage;
+    PULONG  usageBits;
+
+    if (!(ButtonCaps -> BitField & MAIN_ITEM_VARIABLE) ||
+        Data -> ButtonData.UsageMin > Data -> ButtonData.UsageMax)
+    {
+        return (FALSE);
+    }
+
+    count = Data -> ButtonData.UsageMax - Data -> ButtonData.UsageMin + 1;
+
+    usageBits = (PULONG) calloc (count, sizeof (ULONG));
+
+    if (NULL == usageBits)
+    {
+        return (FALSE);
+    }
+
+    for (Index = 0; Index < count; Index++)
+    {
+        memset (ProbeBuffer, 0, ReportBufferLength);
+
+        usage = (USAGE) (Data -> ButtonData.UsageMin + Index);
+        numUsages = 1;
+
+        if (HIDP_STATUS_SUCCESS != HidP_SetUsages (ReportType,
+                                                   Data -> UsagePage,
+                                                   0, // All collections
+                                                   &usage,
+                                                   &numUsages,
+                                                   Ppd,
+                                                   ProbeBuffer,
+                                                   ReportBufferLength))
+        {
+            break;
+        }
+
+        if (!FindReportBits ((PUCHAR) ProbeBuffer,
+                             ReportBufferLength,
+                             &usageBits[Index],
+                             &bitCount) || 1 != bitCount)
+        {
+            break;
+        }
+    }
+
+    if (Index < count)
+    {
+        free (usageBits);
+        return (FALSE);
+    }
+
+    Data -> ButtonData.UsageBits = usageBits;
+
+    return (TRUE);
+}
+
+BOOLEAN
+CompileValueData (
+   IN       HIDP_REPORT_TYPE     ReportType,
+   IN OUT   PHID_DATA            Data,
+   IN       PHIDP_VALUE_CAPS     ValueCaps,
+   _Inout_updates_bytes_(ReportBufferLength)PCHAR ProbeBuffer,
+   IN       USHORT               ReportBufferLength,
+   IN       PHIDP_PREPARSED_DATA Ppd
+   )
+/*++
+Routine Description:
+   Find the bits of a value by setting it to all ones in an empty report,
+   and keep the ranges needed to scale it.
+--*/
+{
+    ULONG   bitOffset;
+    ULONG   bitCount;
+
+    if (0 == ValueCaps -> BitSize || 32 < ValueCaps -> BitSize)
+    {
+        return (FALSE);
+    }
+
+    memset (ProbeBuffer, 0, ReportBufferLength);
+
+    if (HIDP_STATUS_SUCCESS != HidP_SetUsageValue (ReportType,
+                                                   Data -> UsagePage,
+                                                   0, // All Collections.
+                                                   Data -> ValueData.Usage,
+                                                   (ULONG) ((1ULL << ValueCaps -> BitSize) - 1),
+                                                   Ppd,
+                                                   ProbeBuffer,
+                                                   ReportBufferLength))
+    {
+        return (FALSE);
+    }
+
+    if (!FindReportBits ((PUCHAR) ProbeBuffer,
+                         ReportBufferLength,
+                         &bitOffset,
+                         &bitCount) || ValueCaps -> BitSize != bitCount)
+    {
+        return (FALSE);
+    }
+
+    Data -> ValueData.BitOffset = bitOffset;
+    Data -> ValueData.BitSize = ValueCaps -> BitSize;
+    Data -> ValueData.LogicalMin = ValueCaps -> LogicalMin;
+    Data -> ValueData.LogicalMax = ValueCaps -> LogicalMax;
+    Data -> ValueData.PhysicalMin = ValueCaps -> PhysicalMin;
+    Data -> ValueData.PhysicalMax = ValueCaps -> PhysicalMax;
+
+    return (TRUE);
+}
+
+VOID
+CompileReportLayout (
+   IN       HIDP_REPORT_TYPE     ReportType,
+   IN OUT   PHID_DATA            Data,
+   IN       ULONG                DataLength,
+   IN       PHIDP_BUTTON_CAPS    ButtonCaps,
+   IN       USHORT               NumberButtonCaps,
+   IN       PHIDP_VALUE_CAPS     ValueCaps,
+   IN       USHORT               NumberValueCaps,
+   IN       USHORT               ReportBufferLength,
+   IN       PHIDP_PREPARSED_DATA Ppd
+   )
+/*++
+Routine Description:
+   Called once after FillDeviceInfo has built the HID_DATA array for a report
+   type.  Works out where each data item lives in its report so that
+   UnpackReport and PackReport can move it with plain bit operations instead
+   of calling the HidP_ functions for every item of every report.
+
+   The preparsed data is opaque, so positions are found by having the HidP_
+   functions set each item in an empty report and looking at which bits
+   changed.  Items that cannot be described as fixed bits (array buttons,
+   value arrays, button pages shared by several caps in the same report)
+   are left uncompiled and keep using the HidP_ functions.
+
+   Data must be laid out as FillDeviceInfo builds it: one item per button
+   caps, followed by one item per value usage in value caps order.
+--*/
+{
+    PCHAR       probeBuffer;
+    PHID_DATA   pData;
+    ULONG       numValues;
+    ULONG       i;
+    ULONG       j;
+    ULONG       k;
+    BOOLEAN     shared;
+    BOOLEAN     valueArray;
+
+    if (0 == ReportBufferLength || DataLength < NumberButtonCaps)
+    {
+        return;
+    }
+
+    probeBuffer = (PCHAR) calloc (ReportBufferLength, sizeof (CHAR));
+
+    if (NULL == probeBuffer)
+    {
+        return;
+    }
+
+    for (i = 0, pData = Data; i < NumberButtonCaps; i++, pData++)
+    {
+        /*
+        // HidP_GetUsages returns every usage of the page in the report, so
+        //    if another caps shares this page and report ID, this item can
+        //    also see usages that do not come from its own bits.
+        */
+
+        shared = FALSE;
+
+        for (j = 0; j < NumberButtonCaps; j++)
+        {
+            if (j != i &&
+                ButtonCaps[j].UsagePage == ButtonCaps[i].UsagePage &&
+                ButtonCaps[j].ReportID == ButtonCaps[i].ReportID)
+            {
+                shared = TRUE;
+                break;
+            }
+        }
+
+        if (!shared)
+        {
+            pData -> IsCompiled = CompileButtonData (ReportType,
+                                                     pData,
+                                                     &ButtonCaps[i],
+                                                     probeBuffer,
+                                                     ReportBufferLength,
+                                                     Ppd);
+        }
+    }
+
+    for (i = 0; i < NumberValueCaps; i++)
+    {
+        if (ValueCaps[i].IsRange)
+        {
+            if (ValueCaps[i].Range.UsageMin > ValueCaps[i].Range.UsageMax)
+            {
+                break;
+            }
+            numValues = ValueCaps[i].Range.UsageMax - ValueCaps[i].Range.UsageMin + 1;
+        }
+        else
+        {
+            numValues = 1;
+        }
+
+        /*
+        // Only compile caps where each usage has exactly one field.
+        */
+
+        valueArray = (ValueCaps[i].ReportCount != numValues);
+
+        for (k = 0; k < numValues; k++, pData++)
+        {
+            if (pData >= Data + DataLength)
+            {
+                goto Done;
+            }
+
+            if (!valueArray &&
+                !pData -> IsButtonData &&
+                pData -> UsagePage == ValueCaps[i].UsagePage &&
+                pData -> ReportID == ValueCaps[i].ReportID)
+            {
+                pData -> IsCompiled = CompileValueData (ReportType,
+                                                        pData,
+                                                        &ValueCaps[i],
+                                                        probeBuffer,
+                                                        ReportBufferLength,
+                                                        Ppd);
+            }
+        }
+    }
+
+Done:
+    free (probeBuffer);
+
+    return;
+}
+
+VOID
+FreeReportLayout (
+   IN OUT   PHID_DATA            Data,
+   IN       ULONG                DataLength
+   )
+/*++
+Routine Description:
+   Free what CompileReportLayout allocated for a HID_DATA array.
+--*/
+{
+    ULONG   i;
+
+    for (i = 0; i < DataLength; i++, Data++)
+    {
+        if (Data -> IsButtonData && NULL != Data -> ButtonData.UsageBits)
+        {
+            free (Data -> ButtonData.UsageBits);
+            Data -> ButtonData.UsageBits = NULL;
+        }
+        Data -> IsCompiled = FALSE;
+    }
+
+    return;
+}
+
+BOOLEAN
+UnpackCompiledData (
+   _In_reads_bytes_(ReportBufferLength)PCHAR ReportBuffer,
+   IN       USHORT               ReportBufferLength,
+   IN       HIDP_REPORT_TYPE     ReportType,
+   IN OUT   PHID_DATA            Data,
+   IN       PHIDP_PREPARSED_DATA Ppd
+   )
+/*++
+Routine Description:
+   Extract a compiled data item from ReportBuffer.  Returns FALSE if the
+   item has to be read with the HidP_ functions instead.
+--*/
+{
+    PUCHAR      report = (PUCHAR) ReportBuffer;
+    ULONG       count;
+    ULONG       bit;
+    ULONG       Index;
+    ULONG       nextUsage;
+    ULONGLONG   raw;
+    ULONG       value;
+    LONG        logical;
+
+    if (Data -> IsButtonData)
+    {
+        count = Data -> ButtonData.UsageMax - Data -> ButtonData.UsageMin + 1;
+
+        for (Index = 0, nextUsage = 0; Index < count; Index++)
+        {
+            bit = Data -> ButtonData.UsageBits[Index];
+
+            if (bit >= (ULONG) ReportBufferLength * 8)
+            {
+                return (FALSE);
+            }
+
+            if (report[bit >> 3] & (1 << (bit & 7)))
+            {
+                if (nextUsage >= Data -> ButtonData.MaxUsageLength)
+                {
+                    return (FALSE);
+                }
+                Data -> ButtonData.Usages[nextUsage++] = (USAGE) (Data -> ButtonData.UsageMin + Index);
+            }
+        }
+
+        if (nextUsage < Data -> ButtonData.MaxUsageLength) 
+        {
+            Data -> ButtonData.Usages[nextUsage] = 0;
+        }
+
+        Data -> Status = HIDP_STATUS_SUCCESS;
+
+        return (TRUE);
+    }
+
+    /*
+    // A value is at most 32 bits, so it spans at most five bytes.
+    */
+
+    bit = Data -> ValueData.BitOffset;
+    count = ((bit & 7) + Data -> ValueData.BitSize + 7) >> 3;
+
+    if ((bit >> 3) + count > ReportBufferLength)
+    {
+        return (FALSE);
+    }
+
+    raw = 0;
+    for (Index = 0; Index < count; Index++)
+    {
+        raw |= (ULONGLONG) report[(bit >> 3) + Index] << (Index * 8);
+    }
+
+    value = (ULONG) ((raw >> (bit & 7)) & ((1ULL << Data -> ValueData.BitSize) - 1));
+
+    /*
+    // Scale the value the way HidP_GetScaledUsageValue does.  Values that are
+    //    out of the logical range or have unusable ranges are handed to
+    //    HidP_GetScaledUsageValue so the status it returns is preserved.
+    */
+
+    logical = (LONG) value;
+
+    if (Data -> ValueData.LogicalMin < 0 && Data -> ValueData.BitSize < 32 &&
+        (value & (1UL << (Data -> ValueData.BitSize - 1))))
+    {
+        logical = (LONG) (value | ~((1UL << Data -> ValueData.BitSize) - 1));
+    }
+
+    if (Data -> ValueData.LogicalMin < Data -> ValueData.LogicalMax &&
+        Data -> ValueData.PhysicalMin < Data -> ValueData.PhysicalMax &&
+        Data -> ValueData.LogicalMin <= logical &&
+        logical <= Data -> ValueData.LogicalMax)
+    {
+        Data -> ValueData.ScaledValue = (LONG)
+            ((((LONGLONG) logical - Data -> ValueData.LogicalMin) *
+              ((LONGLONG) Data -> ValueData.PhysicalMax - Data -> ValueData.PhysicalMin)) /
+             ((LONGLONG) Data -> ValueData.LogicalMax - Data -> ValueData.LogicalMin) +
+             Data -> ValueData.PhysicalMin);
+
+        Data -> Status = HIDP_STATUS_SUCCESS;
+    }
+    else
+    {
+        Data -> Status = HidP_GetScaledUsageValue (ReportType,
+                                                   Data -> UsagePage,
+                                                   0, // All Collections.
+                                                   Data -> ValueData.Usage,
+                                                   &Data -> ValueData.ScaledValue,
+                                                   Ppd,
+                                                   ReportBuffer,
+                                                   ReportBufferLength);
+
+        if (HIDP_STATUS_SUCCESS != Data -> Status &&
+            HIDP_STATUS_NULL != Data -> Status)
+        {
+            return (FALSE);
+        }
+    }
+
+    Data -> ValueData.Value = value;
+
+    return (TRUE);
+}
+
+BOOLEAN
+PackCompiledData (
+   _Inout_updates_bytes_(ReportBufferLength)PCHAR ReportBuffer,
+   IN       USHORT               ReportBufferLength,
+   IN       PHID_DATA            Data
+   )
+/*++
+Routine Description:
+   Set a compiled data item in ReportBuffer, which PackReport has already
+   zeroed.  Returns FALSE without touching the report if the item has to be
+   set with the HidP_ functions instead, for instance when a usage in the
+   list is outside of this item's range.
+--*/
+{
+    PUCHAR      report = (PUCHAR) ReportBuffer;
+    ULONG       count;
+    ULONG       bit;
+    ULONG       Index;
+    ULONG       value;
+    ULONGLONG   raw;
+    ULONGLONG   mask;
+    USAGE       usage;
+
+    if (Data -> IsButtonData)
+    {
+        for (Index = 0; Index < Data -> ButtonData.MaxUsageLength; Index++)
+        {
+            usage = Data -> ButtonData.Usages[Index];
+
+            if (0 != usage &&
+                (usage < Data -> ButtonData.UsageMin ||
+                 usage > Data -> ButtonData.UsageMax ||
+                 Data -> ButtonData.UsageBits[usage - Data -> ButtonData.UsageMin] >= (ULONG) ReportBufferLength * 8))
+            {
+                return (FALSE);
+            }
+        }
+
+        for (Index = 0; Index < Data -> ButtonData.MaxUsageLength; Index++)
+        {
+            usage = Data -> ButtonData.Usages[Index];
+
+            if (0 != usage)
+            {
+                bit = Data -> ButtonData.UsageBits[usage - Data -> ButtonData.UsageMin];
+                report[bit >> 3] |= (UCHAR) (1 << (bit & 7));
+            }
+        }
+    }
+    else
+    {
+        value = Data -> ValueData.Value;
+        bit = Data -> ValueData.BitOffset;
+        count = ((bit & 7) + Data -> ValueData.BitSize + 7) >> 3;
+
+        if ((bit >> 3) + count > ReportBufferLength ||
+            (Data -> ValueData.BitSize < 32 && (value >> Data -> ValueData.BitSize)))
+        {
+            return (FALSE);
+        }
+
+        raw = 0;
+        for (Index = 0; Index < count; Index++)
+        {
+            raw |= (ULONGLONG) report[(bit >> 3) + Index] << (Index * 8);
+        }
+
+        mask = ((1ULL << Data -> ValueData.BitSize) - 1) << (bit & 7);
+        raw = (raw & ~mask) | ((ULONGLONG) value << (bit & 7));
+
+        for (Index = 0; Index < count; Index++)
+        {
+            report[(bit >> 3) + Index] = (UCHAR) (raw >> (Index * 8));
+        }
+    }
+
+    report[0] = (UCHAR) Data -> ReportID;
+    Data -> Status = HIDP_STATUS_SUCCESS;
+
+    return (TRUE);
+}
@@ -1222,6 +1222,7 @@ Arguments:
         Adapter->AdapterHandle = MiniportAdapterHandle;
 
         NdisInitializeListHead(&Adapter->List);
+        NdisInitializeListHead(&Adapter->RxRouteLink);
 
         //
         // Initialize Send & Recv listheads and corresponding
@@ -1260,6 +1261,12 @@ Arguments:
             break;
         }
 
+        //
+        // A free TCB has no NET_BUFFER; ReturnTCBs relies on this to tell
+        // unused TCBs apart from ones that tracked a send.
+        //
+        NdisZeroMemory(Adapter->TcbMemoryBlock, sizeof(TCB) * NIC_MAX_BUSY_SENDS);
+
         for (index = 0; index < NIC_MAX_BUSY_SENDS; index++)
         {
             NdisInterlockedInsertTailList(
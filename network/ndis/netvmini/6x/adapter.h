@@ -105,6 +105,11 @@ typedef struct _MP_ADAPTER
 {
     LIST_ENTRY              List;
 
+    //
+    // Links the adapter into GlobalData's directed receive routes
+    //
+    LIST_ENTRY              RxRouteLink;
+
     //
     // Keep track of various device objects.
     //
@@ -1169,6 +1169,9 @@ Return Value:
 
         // Save the new packet filter value
         Adapter->PacketFilter = PacketFilter;
+
+        // Promiscuous mode changes which frames the receive routes send us
+        MPRefreshAdapterRxRoute(Adapter);
     }
 
 
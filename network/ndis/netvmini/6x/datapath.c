@@ -365,51 +365,44 @@ Return Value:
 
     if (KeTryToAcquireSpinLockAtDpcLevel(&Adapter->SendPathSpinLock))
     {
-        for (NumFramesSent = 0; NumFramesSent < NIC_MAX_SENDS_PER_DPC; NumFramesSent++)
-        {
-            PLIST_ENTRY pTcbEntry = NULL;
-            PTCB Tcb = NULL;
-            PLIST_ENTRY pQueuedSend = NULL;
-            PNET_BUFFER NetBuffer;
+        LIST_ENTRY TcbList;
+        LIST_ENTRY SendList;
+        LIST_ENTRY BusyList;
+        ULONG NumTcbs;
 
-            //
-            // Get the next available TCB.
-            //
-            pTcbEntry = NdisInterlockedRemoveHeadList(
-                    &Adapter->FreeTcbList,
-                    &Adapter->FreeTcbListLock);
-            if (!pTcbEntry)
-            {
-                //
-                // The adapter can't handle any more simultaneous transmit
-                // operations.  Keep any remaining sends in the SendWaitList and
-                // we'll come back later when there are TCBs available.
-                //
-                break;
-            }
+        NdisInitializeListHead(&TcbList);
+        NdisInitializeListHead(&SendList);
+        NdisInitializeListHead(&BusyList);
 
-            Tcb = CONTAINING_RECORD(pTcbEntry, TCB, TcbLink);
+        //
+        // Take a batch of free TCBs.  If there are none, the adapter can't
+        // handle any more simultaneous transmit operations.  Keep any
+        // remaining sends in the SendWaitList and we'll come back later when
+        // there are TCBs available.
+        //
+        NumTcbs = GetTCBs(Adapter, NIC_MAX_SENDS_PER_DPC, &TcbList);
 
-            //
-            // Get the next NB that needs sending.
-            //
-            pQueuedSend = NdisInterlockedRemoveHeadList(
-                    &Adapter->SendWaitList,
-                    &Adapter->SendWaitListLock);
-            if (!pQueuedSend)
+        //
+        // Take as many queued NBs as we have TCBs for, under a single hold
+        // of the SendWaitList lock.
+        //
+        if (NumTcbs)
+        {
+            NdisDprAcquireSpinLock(&Adapter->SendWaitListLock);
+
+            while (NumFramesSent < NumTcbs && !IsListEmpty(&Adapter->SendWaitList))
             {
-                //
-                // There's nothing left that needs sending.  We're all done.
-                //
-                NdisInterlockedInsertTailList(
-                        &Adapter->FreeTcbList,
-                        &Tcb->TcbLink,
-                        &Adapter->FreeTcbListLock);
-                break;
+                InsertTailList(&SendList, RemoveHeadList(&Adapter->SendWaitList));
+                NumFramesSent++;
             }
 
-            NetBuffer = NB_FROM_SEND_WAIT_LIST(pQueuedSend);
+            NdisDprReleaseSpinLock(&Adapter->SendWaitListLock);
+        }
 
+        while (!IsListEmpty(&SendList))
+        {
+            PTCB Tcb = CONTAINING_RECORD(RemoveHeadList(&TcbList), TCB, TcbLink);
+            PNET_BUFFER NetBuffer = NB_FROM_SEND_WAIT_LIST(RemoveHeadList(&SendList));
 
             //
             // We already packed the frame type into the net buffer before accepting
@@ -420,14 +413,29 @@ Return Value:
 
             HWProgramDmaForSend(Adapter, Tcb, NetBuffer, fAtDispatch);
 
-            NdisInterlockedInsertTailList(
-                &Adapter->BusyTcbList,
-                    &Tcb->TcbLink,
-                    &Adapter->BusyTcbListLock);
+            InsertTailList(&BusyList, &Tcb->TcbLink);
+        }
+
+        //
+        // Hand the whole batch to the hardware at once, and put back any TCBs
+        // there was nothing to send for.
+        //
+        if (NumFramesSent)
+        {
+            NdisDprAcquireSpinLock(&Adapter->BusyTcbListLock);
+
+            while (!IsListEmpty(&BusyList))
+            {
+                InsertTailList(&Adapter->BusyTcbList, RemoveHeadList(&BusyList));
+            }
+
+            NdisDprReleaseSpinLock(&Adapter->BusyTcbListLock);
 
             fScheduleTheSendCompleteDpc = TRUE;
         }
 
+        ReturnTCBs(Adapter, &TcbList);
+
         KeReleaseSpinLock(&Adapter->SendPathSpinLock, DISPATCH_LEVEL);
     }
 
@@ -567,30 +575,48 @@ Routine Description:
 
     This routine completes pending sends for the given adapter.
 
-    Each busy TCB is popped from the BusyTcbList and its corresponding NB is
-    released.  If there was an error sending the frame, the NB's NBL's status
+    Busy TCBs are popped from the BusyTcbList in a batch and their
+    corresponding NBs are released.  If there was an error sending the frame, the NB's NBL's status
     is updated.
 
 --*/
 {
     BOOLEAN fRescheduleThisDpcAgain = TRUE;
     ULONG NumFramesSent = 0;
+    LIST_ENTRY CompletedList;
+    PLIST_ENTRY pTcbEntry;
 
     DEBUGP(MP_TRACE, "[%p] ---> TXSendComplete.\n", Adapter);
 
-    for (NumFramesSent = 0; NumFramesSent < NIC_MAX_SENDS_PER_DPC; NumFramesSent++)
+    NdisInitializeListHead(&CompletedList);
+
+    //
+    // Pop a batch of busy TCBs under a single hold of the BusyTcbList lock.
+    //
+    NdisDprAcquireSpinLock(&Adapter->BusyTcbListLock);
+
+    while (NumFramesSent < NIC_MAX_SENDS_PER_DPC && !IsListEmpty(&Adapter->BusyTcbList))
+    {
+        InsertTailList(&CompletedList, RemoveHeadList(&Adapter->BusyTcbList));
+        NumFramesSent++;
+    }
+
+    NdisDprReleaseSpinLock(&Adapter->BusyTcbListLock);
+
+    if (NumFramesSent < NIC_MAX_SENDS_PER_DPC)
+    {
+        //
+        // There are no more TCBs remaining to send.  We're all done.
+        //
+        fRescheduleThisDpcAgain = FALSE;
+    }
+
+    for (pTcbEntry = CompletedList.Flink; pTcbEntry != &CompletedList; pTcbEntry = pTcbEntry->Flink)
     {
         ULONG BytesSent;
+        PTCB Tcb = CONTAINING_RECORD(pTcbEntry, TCB, TcbLink);
 
-        PTCB Tcb = TXGetNextTcbToSend(Adapter);
-        if (!Tcb)
-        {
-            //
-            // There are no more TCBs remaining to send.  We're all done.
-            //
-            fRescheduleThisDpcAgain = FALSE;
-            break;
-        }
+        ASSERT(Tcb->NetBuffer);
 
 
         //
@@ -634,14 +660,15 @@ Routine Description:
         }
 
 
-        //
-        // Now that we've finished using the TCB and its associated NET_BUFFER,
-        // we can release the NET_BUFFER back to the protocol and the TCB back
-        // to the free list.
-        //
-        ReturnTCB(Adapter, Tcb);
     }
 
+    //
+    // Now that we've finished using the TCBs and their associated NET_BUFFERs,
+    // we can release the NET_BUFFERs back to the protocol and the TCBs back
+    // to the free list.
+    //
+    ReturnTCBs(Adapter, &CompletedList);
+
     TXTransmitQueuedSends(Adapter, TRUE);
 
     if (fRescheduleThisDpcAgain)
@@ -976,6 +1003,7 @@ Return Value:
 {
     MP_LOCK_STATE  LockState;
     PLIST_ENTRY AdapterLink;
+    UCHAR DestAddress[NIC_MACADDR_SIZE];
 
 
     DEBUGP(MP_TRACE, "[%p] ---> RXDeliverFrameToEveryAdapter. Frame=0x%p\n", SendAdapter, Frame);
@@ -983,6 +1011,56 @@ Return Value:
     LOCK_ADAPTER_LIST_FOR_READ(&LockState, fAtDispatch ? NDIS_RWL_AT_DISPATCH_LEVEL:0);
     UNREFERENCED_PARAMETER(fAtDispatch);
 
+    if (Frame->ulSize >= HW_MIN_FRAME_SIZE)
+    {
+        GET_DESTINATION_OF_FRAME(DestAddress, Frame->Data);
+
+        if (NICGetFrameTypeFromDestination(DestAddress) == NDIS_PACKET_TYPE_DIRECTED)
+        {
+            PLIST_ENTRY RouteHead = &GlobalData.RxRouteHash[MP_RX_ROUTE_HASH(DestAddress)];
+
+            //
+            // A directed frame can only be accepted by the adapter that owns
+            // the destination address, or by one that accepts any directed
+            // frame. Skip every other adapter instead of letting its packet
+            // filter drop the frame.
+            //
+            for (
+                AdapterLink = RouteHead->Flink;
+                AdapterLink != RouteHead;
+                AdapterLink = AdapterLink->Flink
+                )
+            {
+                PMP_ADAPTER DestAdapter = CONTAINING_RECORD(AdapterLink, MP_ADAPTER, RxRouteLink);
+
+                if (DestAdapter != SendAdapter &&
+                    NIC_ADDR_EQUAL(DestAdapter->CurrentAddress, DestAddress))
+                {
+                    RXQueueFrameOnAdapter(DestAdapter, Nbl1QInfo, Frame);
+                }
+            }
+
+            for (
+                AdapterLink = GlobalData.RxRouteAllDirected.Flink;
+                AdapterLink != &GlobalData.RxRouteAllDirected;
+                AdapterLink = AdapterLink->Flink
+                )
+            {
+                PMP_ADAPTER DestAdapter = CONTAINING_RECORD(AdapterLink, MP_ADAPTER, RxRouteLink);
+
+                if (DestAdapter != SendAdapter)
+                {
+                    RXQueueFrameOnAdapter(DestAdapter, Nbl1QInfo, Frame);
+                }
+            }
+
+            UNLOCK_ADAPTER_LIST(&LockState);
+
+            DEBUGP(MP_TRACE, "[%p] <-- RXDeliverFrameToEveryAdapter\n", SendAdapter);
+            return;
+        }
+    }
+
     //
     // Go through the adapter list and queue packet for
     // indication on them if there are any. Otherwise
@@ -1459,12 +1537,7 @@ Return Value:
 
     DEBUGP(MP_TRACE, "[%p] ---> MPReturnNetBufferLists\n", Adapter);
 
-    while (NetBufferLists)
-    {
-        PRCB Rcb = RCB_FROM_NBL(NetBufferLists);
-        ReturnRCB(Adapter, Rcb);
-        NetBufferLists = NET_BUFFER_LIST_NEXT_NBL(NetBufferLists);
-    }
+    ReturnRCBs(Adapter, NetBufferLists);
 
     DEBUGP(MP_TRACE, "[%p] <--- MPReturnNetBufferLists\n", Adapter);
 }
@@ -100,6 +100,20 @@ Arguments:
         //
         NdisInitializeListHead(&GlobalData.AdapterList);
 
+        //
+        // The receive routes index the AdapterList by destination address.
+        //
+        {
+            ULONG Bucket;
+
+            for (Bucket = 0; Bucket < MP_RX_ROUTE_HASH_BUCKETS; Bucket++)
+            {
+                NdisInitializeListHead(&GlobalData.RxRouteHash[Bucket]);
+            }
+
+            NdisInitializeListHead(&GlobalData.RxRouteAllDirected);
+        }
+
 
         //
         // The FrameDataLookaside list is used to help emulate an Ethernet hub.
@@ -335,6 +349,63 @@ MPIsAdapterAttached(
     return FALSE;
 }
 
+static
+VOID
+MPUpdateAdapterRxRoute(
+    _In_  PMP_ADAPTER Adapter)
+/*++
+
+Routine Description:
+
+    This routine (re)inserts an attached adapter into the receive route that
+    matches its current packet filter. RXDeliverFrameToEveryAdapter uses the
+    routes to find the adapters that can accept a directed frame without
+    walking the whole AdapterList.
+
+    The caller must hold the adapter list lock for write.
+
+Arguments:
+
+    Adapter                     Pointer to our adapter
+
+Return Value:
+
+    None.
+
+--*/
+{
+    RemoveEntryList(&Adapter->RxRouteLink);
+
+    if (VMQ_ENABLED(Adapter) || (Adapter->PacketFilter & NDIS_PACKET_TYPE_PROMISCUOUS))
+    {
+        InsertTailList(&GlobalData.RxRouteAllDirected, &Adapter->RxRouteLink);
+    }
+    else
+    {
+        InsertTailList(&GlobalData.RxRouteHash[MP_RX_ROUTE_HASH(Adapter->CurrentAddress)], &Adapter->RxRouteLink);
+    }
+}
+
+VOID
+MPRefreshAdapterRxRoute(
+    _In_  PMP_ADAPTER Adapter)
+{
+    MP_LOCK_STATE LockState;
+
+    DEBUGP(MP_TRACE, "[%p] ---> MPRefreshAdapterRxRoute\n", Adapter);
+
+    LOCK_ADAPTER_LIST_FOR_WRITE(&LockState, 0);
+
+    if(MPIsAdapterAttached(Adapter))
+    {
+        MPUpdateAdapterRxRoute(Adapter);
+    }
+
+    UNLOCK_ADAPTER_LIST(&LockState);
+
+    DEBUGP(MP_TRACE, "[%p] <--- MPRefreshAdapterRxRoute\n", Adapter);
+}
+
 VOID
 MPAttachAdapter(
     _In_  PMP_ADAPTER Adapter)
@@ -348,6 +419,7 @@ MPAttachAdapter(
     if(!MPIsAdapterAttached(Adapter))
     {
         InsertTailList(&GlobalData.AdapterList, &Adapter->List);
+        MPUpdateAdapterRxRoute(Adapter);
     }
 
     UNLOCK_ADAPTER_LIST(&LockState);
@@ -367,6 +439,8 @@ MPDetachAdapter(
     if(MPIsAdapterAttached(Adapter))
     {
         RemoveEntryList(&Adapter->List);
+        RemoveEntryList(&Adapter->RxRouteLink);
+        NdisInitializeListHead(&Adapter->RxRouteLink);
     }
 
     UNLOCK_ADAPTER_LIST(&LockState);
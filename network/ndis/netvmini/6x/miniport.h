@@ -198,6 +198,15 @@ Abstract:
         NdisReleaseSpinLock(_SpinLock);\
     }
 
+//
+// Directed frames are routed to adapters by destination address, see
+// MPUpdateAdapterRxRoute.
+//
+#define MP_RX_ROUTE_HASH_BUCKETS 64
+
+#define MP_RX_ROUTE_HASH(_Address_)\
+    ((((_Address_)[3] << 8) ^ ((_Address_)[4] << 4) ^ (_Address_)[5]) % MP_RX_ROUTE_HASH_BUCKETS)
+
 //
 // The driver has exactly one instance of the MP_GLOBAL structure.  NDIS keeps
 // an opaque handle to this data, (it doesn't attempt to read or interpret this
@@ -208,6 +217,17 @@ typedef struct _MP_GLOBAL
 {
     LIST_ENTRY              AdapterList;
 
+    //
+    // Every attached adapter is on exactly one of these lists. Adapters that
+    // only accept directed frames sent to their own address are hashed on
+    // that address. Adapters that may accept any directed frame (promiscuous,
+    // or VMQ filters on other addresses) are on RxRouteAllDirected.
+    //
+    // Protected by Lock, like AdapterList.
+    //
+    LIST_ENTRY              RxRouteHash[MP_RX_ROUTE_HASH_BUCKETS];
+    LIST_ENTRY              RxRouteAllDirected;
+
     MP_RW_LOCK_TYPE         Lock;
 
     NPAGED_LOOKASIDE_LIST   FrameDataLookaside;
@@ -243,6 +263,10 @@ BOOLEAN
 MPIsAdapterAttached(
     _In_ struct _MP_ADAPTER *Adapter);
 
+VOID
+MPRefreshAdapterRxRoute(
+    _In_  struct _MP_ADAPTER *Adapter);
+
 
 VOID
 DbgPrintOidName(
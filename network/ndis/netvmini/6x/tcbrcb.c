@@ -36,6 +36,77 @@ Notes:
 #include "tcbrcb.tmh"
 
 
+static
+VOID
+SpliceTailList(
+    _Inout_ PLIST_ENTRY  ListHead,
+    _Inout_ PLIST_ENTRY  ListToAppend)
+/*++
+
+Routine Description:
+
+    Moves every entry of ListToAppend onto the tail of ListHead, leaving
+    ListToAppend empty.  The caller holds whatever lock protects ListHead.
+
+--*/
+{
+    if (!IsListEmpty(ListToAppend))
+    {
+        PLIST_ENTRY First = ListToAppend->Flink;
+        PLIST_ENTRY Last = ListToAppend->Blink;
+
+        First->Blink = ListHead->Blink;
+        ListHead->Blink->Flink = First;
+        Last->Flink = ListHead;
+        ListHead->Blink = Last;
+
+        InitializeListHead(ListToAppend);
+    }
+}
+
+
+ULONG
+GetTCBs(
+    _In_  PMP_ADAPTER  Adapter,
+    _In_  ULONG        MaxTcbs,
+    _Inout_ PLIST_ENTRY TcbList)
+/*++
+
+Routine Description:
+
+    This routine takes up to MaxTcbs unused TCBs from the pool with a single
+    acquisition of the free list lock, and appends them to TcbList.
+
+    Runs at IRQL <= DISPATCH_LEVEL
+
+Arguments:
+
+    Adapter                     The transmitting adapter
+    MaxTcbs                     The most TCBs to take
+    TcbList                     Receives the TCBs, linked through TcbLink
+
+Return Value:
+
+    The number of TCBs taken.  Zero if the pool is empty.
+
+--*/
+{
+    ULONG NumTcbs = 0;
+
+    NdisAcquireSpinLock(&Adapter->FreeTcbListLock);
+
+    while (NumTcbs < MaxTcbs && !IsListEmpty(&Adapter->FreeTcbList))
+    {
+        InsertTailList(TcbList, RemoveHeadList(&Adapter->FreeTcbList));
+        NumTcbs++;
+    }
+
+    NdisReleaseSpinLock(&Adapter->FreeTcbListLock);
+
+    return NumTcbs;
+}
+
+
 VOID
 ReturnTCB(
     _In_  PMP_ADAPTER  Adapter,
@@ -51,6 +122,56 @@ ReturnTCB(
 }
 
 
+VOID
+ReturnTCBs(
+    _In_  PMP_ADAPTER  Adapter,
+    _Inout_ PLIST_ENTRY TcbList)
+/*++
+
+Routine Description:
+
+    This routine frees a list of TCBs back to the unused pool with a single
+    acquisition of the free list lock.  The NET_BUFFER tracked by each TCB
+    is released first.  TCBs from GetTCBs that were never used for a send
+    have no NET_BUFFER and are simply put back.
+
+    Runs at IRQL <= DISPATCH_LEVEL
+
+Arguments:
+
+    Adapter                     The transmitting adapter (the one that owns the TCBs)
+    TcbList                     The TCBs to free, linked through TcbLink.  Empty on return.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    PLIST_ENTRY pEntry;
+
+    if (IsListEmpty(TcbList))
+    {
+        return;
+    }
+
+    for (pEntry = TcbList->Flink; pEntry != TcbList; pEntry = pEntry->Flink)
+    {
+        PTCB Tcb = CONTAINING_RECORD(pEntry, TCB, TcbLink);
+
+        if (Tcb->NetBuffer)
+        {
+            TXNblRelease(Adapter, NBL_FROM_SEND_NB(Tcb->NetBuffer), TRUE);
+            Tcb->NetBuffer = NULL;
+        }
+    }
+
+    NdisAcquireSpinLock(&Adapter->FreeTcbListLock);
+    SpliceTailList(&Adapter->FreeTcbList, TcbList);
+    NdisReleaseSpinLock(&Adapter->FreeTcbListLock);
+}
+
+
 
 _Must_inspect_result_
 _Success_(return != NULL)
@@ -219,3 +340,72 @@ Return Value:
 }
 
 
+
+VOID
+ReturnRCBs(
+    _In_  PMP_ADAPTER       Adapter,
+    _In_  PNET_BUFFER_LIST  NetBufferLists)
+/*++
+
+Routine Description:
+
+    This routine frees the RCBs of a chain of NBLs back to the unused pool.
+
+    RCBs going back to the global pool are collected and put on the free
+    list with a single acquisition of its lock.  The receive block references
+    are dropped only after that, so the pool is never torn down while RCBs
+    are still being put back.  RCBs owned by a VMQ queue are returned to
+    their queue one at a time, as ReturnRCB does.
+
+    Runs at IRQL <= DISPATCH_LEVEL
+
+Arguments:
+
+    Adapter         - The receiving adapter (the one that owns the RCBs).
+    NetBufferLists  - Chain of NBLs whose RCBs are to be freed.
+
+Return Value:
+
+    None.
+
+--*/
+{
+    LIST_ENTRY RcbList;
+    ULONG NumRcbs = 0;
+
+    DEBUGP(MP_TRACE, "[%p] ---> ReturnRCBs.\n", Adapter);
+
+    NdisInitializeListHead(&RcbList);
+
+    while (NetBufferLists)
+    {
+        PRCB Rcb = RCB_FROM_NBL(NetBufferLists);
+        NetBufferLists = NET_BUFFER_LIST_NEXT_NBL(NetBufferLists);
+
+        if(VMQ_ENABLED(Adapter))
+        {
+            ReturnRCB(Adapter, Rcb);
+            continue;
+        }
+
+        ASSERT(Rcb->Data);
+        HWFrameRelease((PFRAME)Rcb->Data);
+
+        InsertTailList(&RcbList, &Rcb->RcbLink);
+        NumRcbs++;
+    }
+
+    if (NumRcbs)
+    {
+        NdisAcquireSpinLock(&Adapter->FreeRcbListLock);
+        SpliceTailList(&Adapter->FreeRcbList, &RcbList);
+        NdisReleaseSpinLock(&Adapter->FreeRcbListLock);
+
+        while (NumRcbs--)
+        {
+            NICDereferenceReceiveBlock(Adapter, 0, NULL);
+        }
+    }
+
+    DEBUGP(MP_TRACE, "[%p] <--- ReturnRCBs.\n", Adapter);
+}
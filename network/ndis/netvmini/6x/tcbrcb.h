@@ -41,11 +41,22 @@ typedef struct _TCB
 
 
 
+ULONG
+GetTCBs(
+    _In_  PMP_ADAPTER  Adapter,
+    _In_  ULONG        MaxTcbs,
+    _Inout_ PLIST_ENTRY TcbList);
+
 VOID
 ReturnTCB(
     _In_  PMP_ADAPTER  Adapter,
     _In_  PTCB         Tcb);
 
+VOID
+ReturnTCBs(
+    _In_  PMP_ADAPTER  Adapter,
+    _Inout_ PLIST_ENTRY TcbList);
+
 
 //
 // RCB (Receive Control Block)
@@ -75,6 +86,11 @@ ReturnRCB(
     _In_  PMP_ADAPTER   Adapter,
     _In_  PRCB          Rcb);
 
+VOID
+ReturnRCBs(
+    _In_  PMP_ADAPTER       Adapter,
+    _In_  PNET_BUFFER_LIST  NetBufferLists);
+
 
 
 #endif // _TCBRCB_H
@@ -2375,6 +2375,20 @@ Return Value:
         //
         VMQData->RxFilters[FilterIndex].QueueId = (USHORT)FilterParams->QueueId;
 
+        //
+        // Link the filter into its hash bucket. The filter is fully written before it
+        // becomes reachable from the bucket head, so the receive path never sees a
+        // partially initialized entry.
+        //
+        {
+            UINT Bucket = MP_RX_FILTER_HASH(VMQData->RxFilters[FilterIndex].MacAddress,
+                                            VMQData->RxFilters[FilterIndex].VlanUntaggedOrZero? 0 : VMQData->RxFilters[FilterIndex].VlanId);
+
+            VMQData->RxFilters[FilterIndex].NextInBucket = VMQData->RxFilterHash[Bucket];
+            KeMemoryBarrier();
+            VMQData->RxFilterHash[Bucket] = (UCHAR)(FilterIndex + 1);
+        }
+
         //
         // Set to valid
         //
@@ -2443,10 +2457,27 @@ Return Value:
         }
         else
         {
+            PMP_ADAPTER_FILTER Filter = &VMQData->RxFilters[FilterIndex];
+            PUCHAR Link = &VMQData->RxFilterHash[MP_RX_FILTER_HASH(Filter->MacAddress, Filter->VlanUntaggedOrZero? 0 : Filter->VlanId)];
+
             //
             // Reset the filter to invalid
             //
-            VMQData->RxFilters[FilterIndex].Valid = FALSE;
+            Filter->Valid = FALSE;
+
+            //
+            // Unlink it from its hash bucket. A receive that is walking the chain
+            // right now still finds the rest of the chain through NextInBucket.
+            //
+            while(*Link != 0 && *Link != FilterIndex + 1)
+            {
+                Link = &VMQData->RxFilters[*Link - 1].NextInBucket;
+            }
+
+            if(*Link != 0)
+            {
+                *Link = Filter->NextInBucket;
+            }
         }
 
     } while(FALSE);
@@ -2568,29 +2599,43 @@ Return Value:
 --*/
 {
     USHORT index;
+    USHORT MatchIndex = NIC_MAX_HEADER_FILTERS;
+    UINT Steps;
+    PUCHAR FrameDestAddress = ((PNIC_FRAME_HEADER)Frame->Data)->DestAddress;
+    USHORT FrameVlanId = Nbl1QInfo->Value? (USHORT)Nbl1QInfo->TagHeader.VlanId : 0;
     BOOLEAN Matched=FALSE;
 
     DEBUGP(MP_TRACE, "[%p] ---> FindRxQueueRecipient\n", Adapter);
 
     //
-    // Iterate through all the filters and check whether a match exists
+    // Only the filters hashed on this frame's (MAC, VLAN) key can match. If several do,
+    // pick the lowest filter index, as a scan of the whole filter array would.
+    //
+    // The walk is bounded so that a chain being relinked by a concurrent set or clear
+    // can at worst make us miss a filter, never loop.
     //
     *QueueId = NDIS_DEFAULT_RECEIVE_QUEUE_ID;
-    for(index = 0; index < NIC_MAX_HEADER_FILTERS; index++)
+    for(index = Adapter->VMQData.RxFilterHash[MP_RX_FILTER_HASH(FrameDestAddress, FrameVlanId)], Steps = 0;
+        index != 0 && Steps < NIC_MAX_HEADER_FILTERS;
+        index = Adapter->VMQData.RxFilters[index - 1].NextInBucket, Steps++)
     {
+        PMP_ADAPTER_FILTER Filter = &Adapter->VMQData.RxFilters[index - 1];
+
         //
         // Only attempt to match a filter when it is valid and its queue has been completed
         //
-        if(Adapter->VMQData.RxFilters[index].Valid
+        if(index - 1 < MatchIndex
             &&
-            QUEUE_COMPLETE(&Adapter->VMQData.RxQueues[Adapter->VMQData.RxFilters[index].QueueId])
+            Filter->Valid
             &&
-            MatchRxFilter(Adapter, ((PNIC_FRAME_HEADER)Frame->Data)->DestAddress, Nbl1QInfo, &Adapter->VMQData.RxFilters[index]))
+            QUEUE_COMPLETE(&Adapter->VMQData.RxQueues[Filter->QueueId])
+            &&
+            MatchRxFilter(Adapter, FrameDestAddress, Nbl1QInfo, Filter))
         {
             DEBUGP(MP_TRACE, "[%p] Match Found.\n", Adapter);
             Matched = TRUE;
-            *QueueId = Adapter->VMQData.RxFilters[index].QueueId;
-            break;
+            MatchIndex = index - 1;
+            *QueueId = Filter->QueueId;
         }
     }
 
@@ -197,11 +197,25 @@ typedef struct _MP_ADAPTER_FILTER
     USHORT QueueId;
     USHORT VlanId;
     UCHAR MacAddress[NIC_MACADDR_SIZE];
+    //
+    // Next filter (index + 1, 0 terminates) in the same RxFilterHash bucket
+    //
+    UCHAR NextInBucket;
 } MP_ADAPTER_FILTER, *PMP_ADAPTER_FILTER;
 
 #define MP_ADAPTER_FILTER_INDEX(_FilterId_)\
     ((_FilterId_)-1)
 
+//
+// Receive filters are hashed on their (MAC address, VLAN ID) key so a frame
+// only has to be compared against the filters that share its bucket. Filters
+// that accept untagged frames are keyed on VLAN ID 0.
+//
+#define NIC_RX_FILTER_HASH_BUCKETS NIC_MAX_HEADER_FILTERS
+
+#define MP_RX_FILTER_HASH(_MacAddress_, _VlanId_)\
+    ((((_MacAddress_)[3] ^ (_MacAddress_)[4] ^ (_MacAddress_)[5]) ^ (_VlanId_) ^ ((_VlanId_) >> 8)) % NIC_RX_FILTER_HASH_BUCKETS)
+
 //
 // Global VMQ configuration structures
 //
@@ -253,8 +267,15 @@ typedef struct _MP_ADAPTER_VMQ_DATA
     // Filters used to match packets to Queues
     //
     MP_ADAPTER_FILTER RxFilters[NIC_MAX_HEADER_FILTERS];
+    //
+    // Heads (filter index + 1, 0 if empty) of the filter hash chains. Only the
+    // set and clear filter OIDs update the chains, and NDIS serializes those.
+    //
+    UCHAR RxFilterHash[NIC_RX_FILTER_HASH_BUCKETS];
 } MP_ADAPTER_VMQ_DATA, *PMP_ADAPTER_VMQ_DATA;
 
+C_ASSERT(NIC_MAX_HEADER_FILTERS < MAXUCHAR);
+
 NDIS_STATUS
 AllocateVMQData(
     _Inout_ struct _MP_ADAPTER *Adapter);
@@ -252,7 +252,7 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
    {
       /// Various checks and balances must be performed to modify the IP and Transport headers at this modification point.
       /// Parsing of the headers will need to occur, as well as spot checking to verify everything is as it should be.
-      /// Additionally, checksum routines will need to be written to recalculate checksums for some of the headers.
+      /// Additionally, the ICMP checksum is not recalculated (the TCP / UDP checksums are adjusted by the helpers).
       /// The following block of code is to get you started with modifying the headers with info not readily available
       /// (i.e. header parsing has not occurred so there is no relevant classifiable data nor metadata present).
 /*
@@ -335,7 +335,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
             
                      status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                tcpHeaderSize);
+                                                                tcpHeaderSize,
+                                                                FALSE,
+                                                                TRUE);
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -348,7 +350,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
             
                      status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     tcpHeaderSize);
+                                                                     tcpHeaderSize,
+                                                                     FALSE,
+                                                                     TRUE);
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -371,7 +375,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
             
                      status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                udpHeaderSize);
+                                                                udpHeaderSize,
+                                                                FALSE,
+                                                                TRUE);
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -384,7 +390,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
             
                      status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     udpHeaderSize);
+                                                                     udpHeaderSize,
+                                                                     FALSE,
+                                                                     TRUE);
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -428,8 +436,6 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
                }
             }
 
-            /// ToDo: Recalculate the Transport Checksum Here
-
             HLPR_BAIL_LABEL_2:
 
             /// return the data offset to the beginning of the IP Header
@@ -507,6 +513,8 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
+                                                         TRUE,
+                                                         FALSE,
                                                          TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
@@ -548,6 +556,8 @@ NTSTATUS PerformBasicPacketModificationAtInboundMACFrame(_In_ CLASSIFY_DATA** pp
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
+                                                              TRUE,
+                                                              FALSE,
                                                               TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
@@ -797,7 +807,7 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
    {
       /// Various checks and balances must be performed to modify the IP and Transport headers at this modification point.
       /// Parsing of the headers will need to occur, as well as spot checking to verify everything is as it should be.
-      /// Additionally, checksum routines will need to be written to recalculate checksums for some of the headers.
+      /// Additionally, the ICMP checksum is not recalculated (the TCP / UDP checksums are adjusted by the helpers).
       /// The following block of code is to get you started with modifying the headers with info not readily available.
       /// (i.e. header parsing has not occurred so there is no relevant classifiable data nor metadata present).
 /*
@@ -880,7 +890,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
             
                      status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                tcpHeaderSize);
+                                                                tcpHeaderSize,
+                                                                FALSE,
+                                                                !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -893,7 +905,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
             
                      status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     tcpHeaderSize);
+                                                                     tcpHeaderSize,
+                                                                     FALSE,
+                                                                     !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -916,7 +930,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
             
                      status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                udpHeaderSize);
+                                                                udpHeaderSize,
+                                                                FALSE,
+                                                                !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -929,7 +945,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
             
                      status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     udpHeaderSize);
+                                                                     udpHeaderSize,
+                                                                     FALSE,
+                                                                     !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -973,8 +991,6 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
                }
             }
 
-            /// ToDo: Recalculate the Transport Checksum Here
-
             HLPR_BAIL_LABEL_2:
 
             /// return the data offset to the beginning of the IP Header
@@ -1052,7 +1068,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
-                                                         TRUE);
+                                                         TRUE,
+                                                         FALSE,
+                                                         !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -1093,7 +1111,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundMACFrame(_In_ CLASSIFY_DATA** p
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
-                                                              TRUE);
+                                                              TRUE,
+                                                              FALSE,
+                                                              !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -1354,7 +1374,7 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
    {
       /// Various checks and balances must be performed to modify the IP and Transport headers at this modification point.
       /// Parsing of the headers will need to occur, as well as spot checking to verify everything is as it should be.
-      /// Additionally, checksum routines will need to be written to recalculate checksums for some of the headers.
+      /// Additionally, the ICMP checksum is not recalculated (the TCP / UDP checksums are adjusted by the helpers).
       /// The following block of code is to get you started with modifying the headers with info not readily available.
       /// (i.e. header parsing has not occurred so there is no relevant classifiable data nor metadata present).
 /*
@@ -1437,7 +1457,9 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
             
                      status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                tcpHeaderSize);
+                                                                tcpHeaderSize,
+                                                                FALSE,
+                                                                !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -1450,7 +1472,9 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
             
                      status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     tcpHeaderSize);
+                                                                     tcpHeaderSize,
+                                                                     FALSE,
+                                                                     !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -1473,7 +1497,9 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
             
                      status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                udpHeaderSize);
+                                                                udpHeaderSize,
+                                                                FALSE,
+                                                                !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -1486,7 +1512,9 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
             
                      status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     udpHeaderSize);
+                                                                     udpHeaderSize,
+                                                                     FALSE,
+                                                                     !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -1530,8 +1558,6 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
                }
             }
 
-            /// ToDo: Recalculate the Transport Checksum Here
-
             HLPR_BAIL_LABEL_2:
 
             /// return the data offset to the beginning of the IP Header
@@ -1609,7 +1635,9 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
-                                                         TRUE);
+                                                         TRUE,
+                                                         FALSE,
+                                                         !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -1650,7 +1678,9 @@ NTSTATUS PerformBasicPacketModificationAtIngressVSwitchEthernet(_In_ CLASSIFY_DA
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
-                                                              TRUE);
+                                                              TRUE,
+                                                              FALSE,
+                                                              !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -1913,7 +1943,7 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
    {
       /// Various checks and balances must be performed to modify the IP and Transport headers at this modification point.
       /// Parsing of the headers will need to occur, as well as spot checking to verify everything is as it should be.
-      /// Additionally, checksum routines will need to be written to recalculate checksums for some of the headers.
+      /// Additionally, the ICMP checksum is not recalculated (the TCP / UDP checksums are adjusted by the helpers).
       /// The following block of code is to get you started with modifying the headers with info not readily available.
       /// (i.e. header parsing has not occurred so there is no relevant classifiable data nor metadata present).
 /*
@@ -1996,7 +2026,9 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
             
                      status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                tcpHeaderSize);
+                                                                tcpHeaderSize,
+                                                                FALSE,
+                                                                !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -2009,7 +2041,9 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
             
                      status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     tcpHeaderSize);
+                                                                     tcpHeaderSize,
+                                                                     FALSE,
+                                                                     !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -2032,7 +2066,9 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
             
                      status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                                 pNetBufferList,
-                                                                udpHeaderSize);
+                                                                udpHeaderSize,
+                                                                FALSE,
+                                                                !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -2045,7 +2081,9 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
             
                      status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                      pNetBufferList,
-                                                                     udpHeaderSize);
+                                                                     udpHeaderSize,
+                                                                     FALSE,
+                                                                     !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
                      HLPR_BAIL_ON_FAILURE_2(status);
                   }
             
@@ -2089,8 +2127,6 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
                }
             }
 
-            /// ToDo: Recalculate the Transport Checksum Here
-
             HLPR_BAIL_LABEL_2:
 
             /// return the data offset to the beginning of the IP Header
@@ -2168,7 +2204,9 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
-                                                         TRUE);
+                                                         TRUE,
+                                                         FALSE,
+                                                         !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -2209,7 +2247,9 @@ NTSTATUS PerformBasicPacketModificationAtEgressVSwitchEthernet(_In_ CLASSIFY_DAT
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
-                                                              TRUE);
+                                                              TRUE,
+                                                              FALSE,
+                                                              !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket));
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -2646,7 +2686,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundNetwork(_In_ CLASSIFY_DATA** ppC
          
                   status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             tcpHeaderSize);
+                                                             tcpHeaderSize,
+                                                             FALSE,
+                                                             TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -2659,7 +2701,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundNetwork(_In_ CLASSIFY_DATA** ppC
          
                   status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  tcpHeaderSize);
+                                                                  tcpHeaderSize,
+                                                                  FALSE,
+                                                                  TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -2682,7 +2726,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundNetwork(_In_ CLASSIFY_DATA** ppC
          
                   status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             udpHeaderSize);
+                                                             udpHeaderSize,
+                                                             FALSE,
+                                                             TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -2695,7 +2741,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundNetwork(_In_ CLASSIFY_DATA** ppC
          
                   status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  udpHeaderSize);
+                                                                  udpHeaderSize,
+                                                                  FALSE,
+                                                                  TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -2796,6 +2844,8 @@ NTSTATUS PerformBasicPacketModificationAtInboundNetwork(_In_ CLASSIFY_DATA** ppC
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
+                                                         TRUE,
+                                                         FALSE,
                                                          TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
@@ -2840,6 +2890,8 @@ NTSTATUS PerformBasicPacketModificationAtInboundNetwork(_In_ CLASSIFY_DATA** ppC
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
+                                                              TRUE,
+                                                              FALSE,
                                                               TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
@@ -3023,6 +3075,7 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
    COMPARTMENT_ID                             compartmentID   = DEFAULT_COMPARTMENT_ID;
    NET_BUFFER_LIST*                           pNetBufferList  = 0;
    BASIC_PACKET_MODIFICATION_COMPLETION_DATA* pCompletionData = 0;
+   BOOLEAN                                    updateChecksum  = FALSE;
 
 #if DBG
 
@@ -3074,11 +3127,14 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
 
    pCompletionData->refCount = KrnlHlprNBLGetRequiredRefCount(pNetBufferList);
 
+   /// The Transport Checksum is complete at this layer unless it has been left for the NIC
+   updateChecksum = !KrnlHlprChecksumIsTransportOffloaded((NET_BUFFER_LIST*)pCompletionData->pClassifyData->pPacket);
+
    if(pModificationData->flags)
    {
       /// Various checks and balances must be performed to modify the Transport header at this modification point.
       /// Parsing of the headers will need to occur, as well as spot checking to verify everything is as it should be.
-      /// Additionally, checksum routines will need to be written to recalculate checksums for some of the headers.
+      /// Additionally, the ICMP checksum is not recalculated (the TCP / UDP checksums are adjusted by the helpers).
       /// The following block of code is to get you started with modifying the headers with info not readily available.
       /// (i.e. header parsing has not occurred so there is no relevant classifiable data nor metadata present).
 /*
@@ -3151,7 +3207,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
          
                   status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             tcpHeaderSize);
+                                                             tcpHeaderSize,
+                                                             FALSE,
+                                                             updateChecksum);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3164,7 +3222,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
          
                   status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  tcpHeaderSize);
+                                                                  tcpHeaderSize,
+                                                                  FALSE,
+                                                                  updateChecksum);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3187,7 +3247,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
          
                   status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             udpHeaderSize);
+                                                             udpHeaderSize,
+                                                             FALSE,
+                                                             updateChecksum);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3200,7 +3262,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
          
                   status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  udpHeaderSize);
+                                                                  udpHeaderSize,
+                                                                  FALSE,
+                                                                  updateChecksum);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3244,8 +3308,6 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
             }
          }
 
-         /// ToDo: Recalculate the Transport Checksum Here
-
          HLPR_BAIL_LABEL_2:
 
          /// return the data offset to the beginning of the IP Header
@@ -3300,7 +3362,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
-                                                         TRUE);
+                                                         TRUE,
+                                                         FALSE,
+                                                         updateChecksum);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -3344,7 +3408,9 @@ NTSTATUS PerformBasicPacketModificationAtOutboundNetwork(_In_ CLASSIFY_DATA** pp
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
-                                                              TRUE);
+                                                              TRUE,
+                                                              FALSE,
+                                                              updateChecksum);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -3604,7 +3670,7 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
    {
       /// Various checks and balances must be performed to modify the Transport header at this modification point.
       /// Parsing of the headers will need to occur, as well as spot checking to verify everything is as it should be.
-      /// Additionally, checksum routines will need to be written to recalculate checksums for some of the headers.
+      /// Additionally, the ICMP checksum is not recalculated (the TCP / UDP checksums are adjusted by the helpers).
       /// The following block of code is to get you started with modifying the headers with info not readily available.
       /// (i.e. header parsing has not occurred so there is no relevant classifiable data nor metadata present).
 /*
@@ -3677,7 +3743,9 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
          
                   status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             tcpHeaderSize);
+                                                             tcpHeaderSize,
+                                                             FALSE,
+                                                             TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3690,7 +3758,9 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
          
                   status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  tcpHeaderSize);
+                                                                  tcpHeaderSize,
+                                                                  FALSE,
+                                                                  TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3713,7 +3783,9 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
          
                   status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             udpHeaderSize);
+                                                             udpHeaderSize,
+                                                             FALSE,
+                                                             TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3726,7 +3798,9 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
          
                   status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  udpHeaderSize);
+                                                                  udpHeaderSize,
+                                                                  FALSE,
+                                                                  TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -3770,8 +3844,6 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
             }
          }
 
-         /// ToDo: Recalculate the Transport Checksum Here
-
          HLPR_BAIL_LABEL_2:
 
          /// return the data offset to the beginning of the IP Header
@@ -3829,6 +3901,8 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
+                                                         TRUE,
+                                                         FALSE,
                                                          TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
@@ -3873,6 +3947,8 @@ NTSTATUS PerformBasicPacketModificationAtForward(_In_ CLASSIFY_DATA** ppClassify
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
+                                                              TRUE,
+                                                              FALSE,
                                                               TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
@@ -4589,7 +4665,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundTransport(_In_ CLASSIFY_DATA** p
          
                   status = KrnlHlprTCPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             tcpHeaderSize);
+                                                             tcpHeaderSize,
+                                                             FALSE,
+                                                             TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -4602,7 +4680,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundTransport(_In_ CLASSIFY_DATA** p
          
                   status = KrnlHlprTCPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  tcpHeaderSize);
+                                                                  tcpHeaderSize,
+                                                                  FALSE,
+                                                                  TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -4621,7 +4701,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundTransport(_In_ CLASSIFY_DATA** p
          
                   status = KrnlHlprUDPHeaderModifySourcePort(&srcPort,
                                                              pNetBufferList,
-                                                             udpHeaderSize);
+                                                             udpHeaderSize,
+                                                             FALSE,
+                                                             TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -4634,7 +4716,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundTransport(_In_ CLASSIFY_DATA** p
          
                   status = KrnlHlprUDPHeaderModifyDestinationPort(&dstPort,
                                                                   pNetBufferList,
-                                                                  udpHeaderSize);
+                                                                  udpHeaderSize,
+                                                                  FALSE,
+                                                                  TRUE);
                   HLPR_BAIL_ON_FAILURE_2(status);
                }
          
@@ -4739,7 +4823,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundTransport(_In_ CLASSIFY_DATA** p
 
             status = KrnlHlprIPHeaderModifySourceAddress(&value,
                                                          pNetBufferList,
-                                                         FALSE);
+                                                         FALSE,
+                                                         FALSE,
+                                                         TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -4791,7 +4877,9 @@ NTSTATUS PerformBasicPacketModificationAtInboundTransport(_In_ CLASSIFY_DATA** p
 
             status = KrnlHlprIPHeaderModifyDestinationAddress(&value,
                                                               pNetBufferList,
-                                                              FALSE);
+                                                              FALSE,
+                                                              FALSE,
+                                                              TRUE);
 
             KrnlHlprFwpValuePurgeLocalCopy(&value);
 
@@ -5075,6 +5163,8 @@ NTSTATUS PerformBasicPacketModificationAtOutboundTransport(_In_ CLASSIFY_DATA**
 
 #endif
 
+         /// The Transport Checksum is not calculated until after this layer, so the port 
+         /// helpers are not asked to update it.
          switch(protocol)
          {
             case IPPROTO_ICMP:
@@ -318,7 +318,9 @@ NTSTATUS PerformProxyInjectionAtInboundNetwork(_In_ CLASSIFY_DATA** ppClassifyDa
 
                status = KrnlHlprTCPHeaderModifyDestinationPort(&localPort,
                                                                pNetBufferList,
-                                                               tcpHeaderSize);
+                                                               tcpHeaderSize,
+                                                               FALSE,
+                                                               TRUE);
                HLPR_BAIL_ON_FAILURE_2(status);
 
                break;
@@ -333,7 +335,9 @@ NTSTATUS PerformProxyInjectionAtInboundNetwork(_In_ CLASSIFY_DATA** ppClassifyDa
 
                status = KrnlHlprUDPHeaderModifyDestinationPort(&localPort,
                                                                pNetBufferList,
-                                                               udpHeaderSize);
+                                                               udpHeaderSize,
+                                                               FALSE,
+                                                               TRUE);
                HLPR_BAIL_ON_FAILURE_2(status);
 
                break;
@@ -363,7 +367,9 @@ NTSTATUS PerformProxyInjectionAtInboundNetwork(_In_ CLASSIFY_DATA** ppClassifyDa
 
                status = KrnlHlprTCPHeaderModifySourcePort(&remotePort,
                                                           pNetBufferList,
-                                                          tcpHeaderSize);
+                                                          tcpHeaderSize,
+                                                          FALSE,
+                                                          TRUE);
                HLPR_BAIL_ON_FAILURE_2(status);
 
                break;
@@ -378,7 +384,9 @@ NTSTATUS PerformProxyInjectionAtInboundNetwork(_In_ CLASSIFY_DATA** ppClassifyDa
 
                status = KrnlHlprUDPHeaderModifySourcePort(&remotePort,
                                                           pNetBufferList,
-                                                          udpHeaderSize);
+                                                          udpHeaderSize,
+                                                          FALSE,
+                                                          TRUE);
                HLPR_BAIL_ON_FAILURE_2(status);
 
                break;
@@ -439,6 +447,8 @@ NTSTATUS PerformProxyInjectionAtInboundNetwork(_In_ CLASSIFY_DATA** ppClassifyDa
 
       status = KrnlHlprIPHeaderModifyDestinationAddress(&localAddress,
                                                         pNetBufferList,
+                                                        TRUE,
+                                                        FALSE,
                                                         TRUE);
 
       KrnlHlprFwpValuePurgeLocalCopy(&localAddress);
@@ -478,6 +488,8 @@ NTSTATUS PerformProxyInjectionAtInboundNetwork(_In_ CLASSIFY_DATA** ppClassifyDa
 
       status = KrnlHlprIPHeaderModifySourceAddress(&remoteAddress,
                                                    pNetBufferList,
+                                                   TRUE,
+                                                   FALSE,
                                                    TRUE);
 
       KrnlHlprFwpValuePurgeLocalCopy(&remoteAddress);
@@ -714,6 +726,8 @@ NTSTATUS PerformProxyInjectionAtOutboundTransport(_In_ CLASSIFY_DATA** ppClassif
       HLPR_BAIL;
    }
 
+   /// The Transport Checksum is not calculated until after this layer, so the port helpers are 
+   /// not asked to update it.
    if(pProxyData->flags & PCPDF_PROXY_LOCAL_PORT)
    {
       FWP_VALUE localPort;
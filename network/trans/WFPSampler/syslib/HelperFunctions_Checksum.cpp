@@ -0,0 +1,312 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//   Copyright (c) 2014 Microsoft Corporation.  All Rights Reserved.
+//
+//   Module Name:
+//      HelperFunctions_Checksum.cpp
+//
+//   Abstract:
+//      This module contains kernel helper functions that assist with computing and updating the
+//         Internet Checksum (RFC 1071) used by the IPv4, ICMP, TCP and UDP headers.
+//
+//   Naming Convention:
+//
+//      <Module><Object><Action><Modifier>
+//
+//      i.e.
+//
+//       KrnlHlprChecksumAccumulateMDLChain
+//
+//       <Module>
+//          KrnlHlpr             -       Function is located in syslib\ and applies to kernel mode.
+//       <Object>
+//          Checksum             -       Function pertains to the Internet Checksum.
+//       <Action>
+//          {
+//             Accumulate        -       Function adds data to a running (unfolded) sum.
+//             Fold              -       Function reduces a running sum to 16 bits.
+//             Is                -       Function reports a property of the NBL's checksums.
+//             Update            -       Function adjusts an existing checksum for changed data.
+//          }
+//       <Modifier>
+//          {
+//             MDLChain          -       Function walks the MDLs rather than a flat buffer.
+//          }
+//
+//   Private Functions:
+//
+//   Public Functions:
+//      KrnlHlprChecksumAccumulate(),
+//      KrnlHlprChecksumAccumulateMDLChain(),
+//      KrnlHlprChecksumFold(),
+//      KrnlHlprChecksumIsTransportOffloaded(),
+//      KrnlHlprChecksumUpdate(),
+//
+//   Revision History:
+//
+//      [ Month ][Day] [Year] - [Revision]-[ Comments ]
+//      October   17,   2026  -     1.0   -  Creation
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#include "HelperFunctions_Include.h"   /// .
+#include "HelperFunctions_Checksum.tmh" /// $(OBJ_PATH)\$(O)\
+
+#ifndef CHECKSUM____
+#define CHECKSUM____
+
+/**
+ @kernel_helper_function="KrnlHlprChecksumAccumulate"
+
+   Purpose:  Add the contents of a buffer to a running one's complement sum.                    <br>
+                                                                                                <br>
+   Notes:    The sum is kept in 64 bits and is only folded by KrnlHlprChecksumFold(), so
+                callers may chain several buffers together.  The buffer is treated as if it
+                starts on an even offset of the checksummed data.                               <br>
+                                                                                                <br>
+             32 bits are added at a time into two independent accumulators, which can not
+                overflow for any buffer smaller than 16 GB.                                     <br>
+                                                                                                <br>
+             The result is in memory byte order, so the folded value can be stored directly
+                into the header's checksum field.                                               <br>
+                                                                                                <br>
+   MSDN_Ref:                                                                                    <br>
+*/
+_IRQL_requires_max_(HIGH_LEVEL)
+UINT64 KrnlHlprChecksumAccumulate(_In_reads_bytes_(size) const BYTE* pBuffer,
+                                  _In_ SIZE_T size,
+                                  _In_ UINT64 sum)                                /* 0 */
+{
+   const UINT32 UNALIGNED* pWords = (const UINT32 UNALIGNED*)pBuffer;
+   UINT64                  sum2   = 0;
+
+   for(;
+       size >= 16;
+       size -= 16,
+       pWords += 4)
+   {
+      sum  += pWords[0];
+      sum2 += pWords[1];
+      sum  += pWords[2];
+      sum2 += pWords[3];
+   }
+
+   sum += sum2;
+
+   for(;
+       size >= 4;
+       size -= 4,
+       pWords++)
+   {
+      sum += pWords[0];
+   }
+
+   pBuffer = (const BYTE*)pWords;
+
+   if(size >= 2)
+   {
+      sum += *((const UINT16 UNALIGNED*)pBuffer);
+
+      pBuffer += 2;
+      size    -= 2;
+   }
+
+   /// A trailing odd byte is padded with a zero byte (RFC 1071)
+   if(size)
+   {
+      UINT16 lastWord = 0;
+
+      *((BYTE*)&lastWord) = *pBuffer;
+
+      sum += lastWord;
+   }
+
+   return sum;
+}
+
+/**
+ @kernel_helper_function="KrnlHlprChecksumFold"
+
+   Purpose:  Fold a running sum from KrnlHlprChecksumAccumulate() into a 16 bit one's
+                complement sum.                                                                 <br>
+                                                                                                <br>
+   Notes:    The result is not complemented.                                                   <br>
+                                                                                                <br>
+   MSDN_Ref:                                                                                    <br>
+*/
+_IRQL_requires_max_(HIGH_LEVEL)
+UINT16 KrnlHlprChecksumFold(_In_ UINT64 sum)
+{
+   while(sum >> 16)
+   {
+      sum = (sum & 0xFFFF) + (sum >> 16);
+   }
+
+   return (UINT16)sum;
+}
+
+/**
+ @kernel_helper_function="KrnlHlprChecksumAccumulateMDLChain"
+
+   Purpose:  Add the contents of an MDL chain to a running one's complement sum.               <br>
+                                                                                                <br>
+   Notes:    Sums the data in place, so no contiguous copy of the data is needed.  Each MDL
+                which starts on an odd offset of the data has its partial sum byte swapped
+                (RFC 1071 section 2(B)).                                                        <br>
+                                                                                                <br>
+   MSDN_Ref:                                                                                    <br>
+*/
+_IRQL_requires_min_(PASSIVE_LEVEL)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_IRQL_requires_same_
+_Check_return_
+_Success_(return == STATUS_SUCCESS)
+NTSTATUS KrnlHlprChecksumAccumulateMDLChain(_In_ PMDL pMDL,
+                                            _In_ SIZE_T mdlOffset,
+                                            _In_ SIZE_T size,
+                                            _Inout_ UINT64* pSum)
+{
+   NT_ASSERT(pMDL);
+   NT_ASSERT(pSum);
+
+   NTSTATUS status         = STATUS_SUCCESS;
+   SIZE_T   remainingBytes = size;
+   BOOLEAN  oddOffset      = FALSE;
+   UINT32   noExecute      = 0;
+
+#if(NTDDI_VERSION >= NTDDI_WIN8)
+
+   noExecute = MdlMappingNoExecute;
+
+#endif /// (NTDDI_VERSION >= NTDDI_WIN8)
+
+   /// Skip over the offset in the MDL chain
+   while(pMDL &&
+         mdlOffset >= MmGetMdlByteCount(pMDL))
+   {
+      mdlOffset -= MmGetMdlByteCount(pMDL);
+
+      pMDL = pMDL->Next;
+   }
+
+   for(;
+       pMDL &&
+       remainingBytes > 0;
+       pMDL = pMDL->Next)
+   {
+      BYTE*  pSystemAddress = 0;
+      SIZE_T mdlByteCount   = MmGetMdlByteCount(pMDL);
+      SIZE_T sumSize        = 0;
+      UINT16 partialSum     = 0;
+
+      if(mdlByteCount == 0)
+         continue;
+
+      NT_ASSERT(mdlOffset < mdlByteCount);
+
+      sumSize = min(remainingBytes,
+                    mdlByteCount - mdlOffset);
+
+      pSystemAddress = (BYTE*)MmGetSystemAddressForMdlSafe(pMDL,
+                                                           LowPagePriority | noExecute);
+      if(pSystemAddress == 0)
+      {
+         status = STATUS_INSUFFICIENT_RESOURCES;
+
+         HLPR_BAIL;
+      }
+
+      partialSum = KrnlHlprChecksumFold(KrnlHlprChecksumAccumulate(pSystemAddress + mdlOffset,
+                                                                   sumSize));
+      if(oddOffset)
+         partialSum = RtlUshortByteSwap(partialSum);
+
+      *pSum += partialSum;
+
+      if(sumSize & 1)
+         oddOffset = !oddOffset;
+
+      remainingBytes -= sumSize;
+
+      mdlOffset = 0;
+   }
+
+   if(remainingBytes)
+      status = STATUS_BUFFER_TOO_SMALL;
+
+   HLPR_BAIL_LABEL:
+
+#if DBG
+
+   if(status != STATUS_SUCCESS)
+      DbgPrintEx(DPFLTR_IHVNETWORK_ID,
+                 DPFLTR_ERROR_LEVEL,
+                 " !!!! KrnlHlprChecksumAccumulateMDLChain() [status: %#x]\n",
+                 status);
+
+#endif /// DBG
+
+   return status;
+}
+
+/**
+ @kernel_helper_function="KrnlHlprChecksumUpdate"
+
+   Purpose:  Adjust an existing checksum for a field that was changed from pOldValue to
+                pNewValue, without revisiting the rest of the data.                             <br>
+                                                                                                <br>
+   Notes:    Uses HC' = ~(~HC + ~m + m') from RFC 1624, which does not suffer from the -0
+                problem of RFC 1141.                                                            <br>
+                                                                                                <br>
+             The field must start on an even offset of the checksummed data, which is the
+                case for all the address and port fields.                                       <br>
+                                                                                                <br>
+   MSDN_Ref:                                                                                    <br>
+*/
+_IRQL_requires_max_(HIGH_LEVEL)
+UINT16 KrnlHlprChecksumUpdate(_In_ UINT16 checksum,
+                              _In_reads_bytes_(size) const BYTE* pOldValue,
+                              _In_reads_bytes_(size) const BYTE* pNewValue,
+                              _In_ SIZE_T size)
+{
+   UINT64 sum = (UINT16)~checksum;
+
+   sum += (UINT16)~KrnlHlprChecksumFold(KrnlHlprChecksumAccumulate(pOldValue,
+                                                                   size));
+
+   sum = KrnlHlprChecksumAccumulate(pNewValue,
+                                    size,
+                                    sum);
+
+   return (UINT16)~KrnlHlprChecksumFold(sum);
+}
+
+/**
+ @kernel_helper_function="KrnlHlprChecksumIsTransportOffloaded"
+
+   Purpose:  Determine whether the TCP / UDP Checksum of an outbound NBL has been left for the
+                NIC to compute.                                                                 <br>
+                                                                                                <br>
+   Notes:    When offloaded, the Checksum field holds only the pseudo-header sum, so it must
+                not be adjusted with KrnlHlprChecksumUpdate.                                    <br>
+                                                                                                <br>
+             Only meaningful for NBLs on the send path, as the Receive half of the union is
+                populated for inbound NBLs.                                                     <br>
+                                                                                                <br>
+   MSDN_Ref:                                                                                    <br>
+*/
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN KrnlHlprChecksumIsTransportOffloaded(_In_ const NET_BUFFER_LIST* pNetBufferList)
+{
+   NT_ASSERT(pNetBufferList);
+
+   NDIS_TCP_IP_CHECKSUM_PACKET_INFO checksumInfo = {0};
+
+   checksumInfo.Value = (ULONG)(ULONG_PTR)NET_BUFFER_LIST_INFO(pNetBufferList,
+                                                               TcpIpChecksumNetBufferListInfo);
+
+   return (checksumInfo.Transmit.NdisPacketTcpChecksum ||
+           checksumInfo.Transmit.NdisPacketUdpChecksum) ? TRUE : FALSE;
+}
+
+#endif /// CHECKSUM____
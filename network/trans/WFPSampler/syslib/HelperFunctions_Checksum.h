@@ -0,0 +1,49 @@
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//
+//   Copyright (c) 2014 Microsoft Corporation.  All Rights Reserved.
+//
+//   Module Name:
+//      HelperFunctions_Checksum.h
+//
+//   Abstract:
+//      This module contains prototypes for kernel helper functions that assist with computing and
+//         updating the Internet Checksum (RFC 1071).
+//
+//   Revision History:
+//
+//      [ Month ][Day] [Year] - [Revision]-[ Comments ]
+//      October   17,   2026  -     1.0   -  Creation
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+
+#ifndef HELPERFUNCTIONS_CHECKSUM_H
+#define HELPERFUNCTIONS_CHECKSUM_H
+
+_IRQL_requires_max_(HIGH_LEVEL)
+UINT64 KrnlHlprChecksumAccumulate(_In_reads_bytes_(size) const BYTE* pBuffer,
+                                  _In_ SIZE_T size,
+                                  _In_ UINT64 sum = 0);
+
+_IRQL_requires_min_(PASSIVE_LEVEL)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_IRQL_requires_same_
+_Check_return_
+_Success_(return == STATUS_SUCCESS)
+NTSTATUS KrnlHlprChecksumAccumulateMDLChain(_In_ PMDL pMDL,
+                                            _In_ SIZE_T mdlOffset,
+                                            _In_ SIZE_T size,
+                                            _Inout_ UINT64* pSum);
+
+_IRQL_requires_max_(HIGH_LEVEL)
+UINT16 KrnlHlprChecksumFold(_In_ UINT64 sum);
+
+_IRQL_requires_max_(DISPATCH_LEVEL)
+BOOLEAN KrnlHlprChecksumIsTransportOffloaded(_In_ const NET_BUFFER_LIST* pNetBufferList);
+
+_IRQL_requires_max_(HIGH_LEVEL)
+UINT16 KrnlHlprChecksumUpdate(_In_ UINT16 checksum,
+                              _In_reads_bytes_(size) const BYTE* pOldValue,
+                              _In_reads_bytes_(size) const BYTE* pNewValue,
+                              _In_ SIZE_T size);
+
+#endif /// HELPERFUNCTIONS_CHECKSUM_H
@@ -44,6 +44,8 @@
 //          }
 //
 //   Private Functions:
+//      PrvKrnlHlprCopyBufferToMDL(),
+//      PrvKrnlHlprTransportHeaderUpdateChecksum(),
 //
 //   Public Functions:
 //      KrnlHlprICMPv4HeaderModifyCode(),
@@ -211,6 +213,155 @@ NTSTATUS PrvKrnlHlprCopyBufferToMDL(_In_reads_(bytesToCopy) const BYTE* pBuffer,
    return status;
 }
 
+/**
+ @private_kernel_helper_function="PrvKrnlHlprTransportHeaderUpdateChecksum"
+ 
+   Purpose:  Adjust the TCP / UDP Checksum for an IP Address that was changed from pOldAddress 
+                to pNewAddress, as the address is part of the pseudo-header.                    <br>
+                                                                                                <br>
+   Notes:    The NetBufferList parameter is expected to be offset to the start of the IP Header,
+                and is returned there.                                                          <br>
+                                                                                                <br>
+             Packets other than TCP / UDP, IPv4 fragments other than the first, and IPv6 
+                packets with Extension Headers are left untouched.                              <br>
+                                                                                                <br>
+             A UDP Checksum of 0 (none) is left alone.                                          <br>
+                                                                                                <br>
+   MSDN_Ref:                                                                                    <br>
+*/
+_IRQL_requires_min_(PASSIVE_LEVEL)
+_IRQL_requires_max_(DISPATCH_LEVEL)
+_IRQL_requires_same_
+_Check_return_
+_Success_(return == STATUS_SUCCESS)
+NTSTATUS PrvKrnlHlprTransportHeaderUpdateChecksum(_Inout_ NET_BUFFER_LIST* pNetBufferList,
+                                                  _In_ const VOID* pIPHeader,
+                                                  _In_reads_(addressSize) const BYTE* pOldAddress,
+                                                  _In_reads_(addressSize) const BYTE* pNewAddress,
+                                                  _In_ SIZE_T addressSize)
+{
+#if DBG
+   
+   DbgPrintEx(DPFLTR_IHVNETWORK_ID,
+              DPFLTR_INFO_LEVEL,
+              " ---> PrvKrnlHlprTransportHeaderUpdateChecksum()\n");
+
+#endif /// DBG
+
+   NT_ASSERT(pNetBufferList);
+   NT_ASSERT(pIPHeader);
+   NT_ASSERT(pOldAddress);
+   NT_ASSERT(pNewAddress);
+
+   NTSTATUS    status           = STATUS_SUCCESS;
+   NTSTATUS    tmpStatus        = STATUS_SUCCESS;
+   NET_BUFFER* pNetBuffer       = NET_BUFFER_LIST_FIRST_NB(pNetBufferList);
+   UINT32      ipHeaderSize     = IPV6_HEADER_MIN_SIZE;
+   UINT32      headerSize       = 0;
+   UINT8       protocol         = 0;
+   BYTE*       pTransportHeader = 0;
+   UINT16*     pChecksum        = 0;
+   BOOLEAN     needToFree       = FALSE;
+
+   if(addressSize == IPV4_ADDRESS_SIZE)
+   {
+      IP_HEADER_V4* pIPv4Header = (IP_HEADER_V4*)pIPHeader;
+
+      /// Only the first fragment carries the Transport Header
+      if(ntohs(pIPv4Header->flagsAndFragmentOffset) & 0x1FFF)
+         HLPR_BAIL;
+
+      ipHeaderSize = pIPv4Header->headerLength * 4;
+      protocol     = pIPv4Header->protocol;
+   }
+   else
+      protocol = ((IP_HEADER_V6*)pIPHeader)->nextHeader;
+
+   if(protocol == IPPROTO_TCP)
+      headerSize = TCP_HEADER_MIN_SIZE;
+   else if(protocol == IPPROTO_UDP)
+      headerSize = UDP_HEADER_MIN_SIZE;
+   else
+      HLPR_BAIL;
+
+   NdisAdvanceNetBufferDataStart(pNetBuffer,
+                                 ipHeaderSize,
+                                 FALSE,
+                                 0);
+
+   if(protocol == IPPROTO_TCP)
+   {
+      status = KrnlHlprTCPHeaderGet(pNetBufferList,
+                                    (VOID**)&pTransportHeader,
+                                    &needToFree,
+                                    headerSize);
+      if(status == STATUS_SUCCESS)
+         pChecksum = &(((TCP_HEADER*)pTransportHeader)->checksum);
+   }
+   else
+   {
+      status = KrnlHlprUDPHeaderGet(pNetBufferList,
+                                    (VOID**)&pTransportHeader,
+                                    &needToFree,
+                                    headerSize);
+      if(status == STATUS_SUCCESS &&
+         ((UDP_HEADER*)pTransportHeader)->checksum)
+         pChecksum = &(((UDP_HEADER*)pTransportHeader)->checksum);
+   }
+
+   if(pChecksum)
+   {
+      *pChecksum = KrnlHlprChecksumUpdate(*pChecksum,
+                                          pOldAddress,
+                                          pNewAddress,
+                                          addressSize);
+
+      /// A computed Checksum of 0 is transmitted as all ones (RFC 768)
+      if(protocol == IPPROTO_UDP &&
+         *pChecksum == 0)
+         *pChecksum = 0xFFFF;
+
+      /// Copy the contents of the allocated buffer to the NBL's discontiguous buffer
+      if(needToFree)
+      {
+         SIZE_T bytesCopied = 0;
+
+         status = PrvKrnlHlprCopyBufferToMDL(pTransportHeader,
+                                             NET_BUFFER_CURRENT_MDL(pNetBuffer),
+                                             NET_BUFFER_CURRENT_MDL_OFFSET(pNetBuffer),
+                                             headerSize,
+                                             &bytesCopied);
+         if(status == STATUS_SUCCESS &&
+            bytesCopied != headerSize)
+            status = STATUS_INSUFFICIENT_RESOURCES;
+      }
+   }
+
+   if(needToFree)
+      KrnlHlprTransportHeaderDestroy((VOID**)&pTransportHeader);
+
+   /// return the data offset to the beginning of the IP Header
+   tmpStatus = NdisRetreatNetBufferDataStart(pNetBuffer,
+                                             ipHeaderSize,
+                                             0,
+                                             0);
+   if(status == STATUS_SUCCESS)
+      status = tmpStatus;
+
+   HLPR_BAIL_LABEL:
+
+#if DBG
+   
+   DbgPrintEx(DPFLTR_IHVNETWORK_ID,
+              DPFLTR_INFO_LEVEL,
+              " <--- PrvKrnlHlprTransportHeaderUpdateChecksum() [status: %#x]\n",
+              status);
+
+#endif /// DBG
+
+   return status;
+}
+
 #ifndef MAC_HEADER____
 #define MAC_HEADER____
 
@@ -1520,6 +1671,9 @@ UINT8 KrnlHlprIPHeaderGetVersionField(_In_ NET_BUFFER_LIST* pNetBufferList)
                                                                                                 <br>
    Notes:    Assumes the NBL is at the start of the IPv4 Header.                                <br>
                                                                                                 <br>
+             The header is summed in place by walking the NBL's MDL chain, so no contiguous 
+                copy of the header is made even if it spans several MDLs.                       <br>
+                                                                                                <br>
    MSDN_Ref:                                                                                    <br>
 */
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -1538,65 +1692,60 @@ VOID KrnlHlprIPHeaderCalculateV4Checksum(_Inout_ NET_BUFFER_LIST* pNetBufferList
    
    NT_ASSERT(pNetBufferList);
 
-   NTSTATUS      status      = STATUS_SUCCESS;
-   IP_HEADER_V4* pIPv4Header = 0;
-   BOOLEAN       needToFree  = FALSE;
-
-   status = KrnlHlprIPHeaderGet(pNetBufferList,
-                                (VOID**)&pIPv4Header,
-                                &needToFree,
-                                ipHeaderSize);
-   if(status == STATUS_SUCCESS &&
-      ipHeaderSize >= IPV4_HEADER_MIN_SIZE)
+   NTSTATUS    status           = STATUS_SUCCESS;
+   NET_BUFFER* pFirstNetBuffer  = NET_BUFFER_LIST_FIRST_NB(pNetBufferList);
+   PMDL        pCurrentMDL      = NET_BUFFER_CURRENT_MDL(pFirstNetBuffer);
+   SIZE_T      currentMDLOffset = NET_BUFFER_CURRENT_MDL_OFFSET(pFirstNetBuffer);
+   SIZE_T      checksumOffset   = currentMDLOffset + FIELD_OFFSET(IP_HEADER_V4, checksum);
+   UINT16      checksum         = 0;
+   UINT64      sum              = 0;
+   SIZE_T      bytesCopied      = 0;
+
+   if(ipHeaderSize < IPV4_HEADER_MIN_SIZE ||
+      NET_BUFFER_DATA_LENGTH(pFirstNetBuffer) < ipHeaderSize)
    {
-      UINT32            sum    = 0;
-      UINT32            words  = ipHeaderSize / 2;
-      UINT16 UNALIGNED* pStart = (UINT16*)pIPv4Header;
+      status = STATUS_INVALID_BUFFER_SIZE;
 
-      pIPv4Header->checksum = 0;
+      HLPR_BAIL;
+   }
 
-      for(UINT8 i = 0;
-          i < words;
-          i++)
-      {
-         sum += pStart[i];
-      }
+   /// Clear the checksum field so it does not contribute to the sum
+   status = PrvKrnlHlprCopyBufferToMDL((BYTE*)&checksum,
+                                       pCurrentMDL,
+                                       checksumOffset,
+                                       sizeof(UINT16),
+                                       &bytesCopied);
+   if(status == STATUS_SUCCESS &&
+      bytesCopied != sizeof(UINT16))
+      status = STATUS_INSUFFICIENT_RESOURCES;
 
-      sum = (sum & 0x0000ffff) + (sum >> 16);
-      sum += (sum >> 16);
+   HLPR_BAIL_ON_FAILURE(status);
 
-      pIPv4Header->checksum = (UINT16)~sum;
+   status = KrnlHlprChecksumAccumulateMDLChain(pCurrentMDL,
+                                               currentMDLOffset,
+                                               ipHeaderSize,
+                                               &sum);
+   HLPR_BAIL_ON_FAILURE(status);
 
-      if(needToFree)
-      {
-         /// Copy the contents of the allocated buffer to the NBL's discontiguous buffer
-         if(status == STATUS_SUCCESS)
-         {
-            NET_BUFFER* pFirstNetBuffer  = NET_BUFFER_LIST_FIRST_NB(pNetBufferList);
-            PMDL        pCurrentMDL      = NET_BUFFER_CURRENT_MDL(pFirstNetBuffer);
-            SIZE_T      currentMDLOffset = NET_BUFFER_CURRENT_MDL_OFFSET(pFirstNetBuffer);
-            SIZE_T      headerSize       = ipHeaderSize ? ipHeaderSize : IPV4_HEADER_MIN_SIZE;
-            SIZE_T      bytesCopied      = 0;
-
-            status = PrvKrnlHlprCopyBufferToMDL((BYTE*)pIPv4Header,
-                                                pCurrentMDL,
-                                                currentMDLOffset,
-                                                headerSize,
-                                                &bytesCopied);
-            if(status == STATUS_SUCCESS &&
-               bytesCopied != headerSize)
-               status = STATUS_INSUFFICIENT_RESOURCES;
-         }
+   checksum = (UINT16)~KrnlHlprChecksumFold(sum);
 
-         KrnlHlprIPHeaderDestroy((VOID**)&pIPv4Header);
-      }
-   }
+   status = PrvKrnlHlprCopyBufferToMDL((BYTE*)&checksum,
+                                       pCurrentMDL,
+                                       checksumOffset,
+                                       sizeof(UINT16),
+                                       &bytesCopied);
+   if(status == STATUS_SUCCESS &&
+      bytesCopied != sizeof(UINT16))
+      status = STATUS_INSUFFICIENT_RESOURCES;
+
+   HLPR_BAIL_LABEL:
 
 #if DBG
    
    DbgPrintEx(DPFLTR_IHVNETWORK_ID,
               DPFLTR_INFO_LEVEL,
-              " <--- KrnlHlprIPHeaderCalculateV4Checksum()\n");
+              " <--- KrnlHlprIPHeaderCalculateV4Checksum() [status: %#x]\n",
+              status);
 
 #endif /// DBG
    
@@ -1614,6 +1763,10 @@ VOID KrnlHlprIPHeaderCalculateV4Checksum(_Inout_ NET_BUFFER_LIST* pNetBufferList
                                                                                                 <br>
              Function is IP version agnostic.                                                   <br>
                                                                                                 <br>
+             If updateTransportChecksum is TRUE, the TCP / UDP Checksum is adjusted for the new
+                address (RFC 1624).  Only request this when that Checksum is complete (i.e. not 
+                left for offload).                                                              <br>
+                                                                                                <br>
    MSDN_Ref:                                                                                    <br>
 */
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -1624,7 +1777,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprIPHeaderModifySourceAddress(_In_ const FWP_VALUE* pValue,
                                              _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                              _In_ BOOLEAN recalculateChecksum,        /* TRUE */
-                                             _In_ BOOLEAN convertByteOrder)           /* FALSE */
+                                             _In_ BOOLEAN convertByteOrder,           /* FALSE */
+                                             _In_ BOOLEAN updateTransportChecksum)    /* FALSE */
 {
 #if DBG
    
@@ -1637,9 +1791,12 @@ NTSTATUS KrnlHlprIPHeaderModifySourceAddress(_In_ const FWP_VALUE* pValue,
    NT_ASSERT(pValue);
    NT_ASSERT(pNetBufferList);
 
-   NTSTATUS status     = STATUS_SUCCESS;
-   VOID*    pIPHeader  = 0;
-   BOOLEAN  needToFree = FALSE;
+   NTSTATUS status                         = STATUS_SUCCESS;
+   VOID*    pIPHeader                      = 0;
+   BOOLEAN  needToFree                     = FALSE;
+   BYTE*    pAddress                       = 0;
+   SIZE_T   addressSize                    = 0;
+   BYTE     pOldAddress[IPV6_ADDRESS_SIZE] = {0};
 
    status = KrnlHlprIPHeaderGet(pNetBufferList,
                                 &pIPHeader,
@@ -1653,9 +1810,16 @@ NTSTATUS KrnlHlprIPHeaderModifySourceAddress(_In_ const FWP_VALUE* pValue,
          IP_HEADER_V4* pIPv4Header   = (IP_HEADER_V4*)pIPHeader;
          UINT32        sourceAddress = convertByteOrder ? htonl(pValue->uint32) : pValue->uint32;
 
-         RtlCopyMemory(pIPv4Header->pSourceAddress,
+         pAddress    = pIPv4Header->pSourceAddress;
+         addressSize = IPV4_ADDRESS_SIZE;
+
+         RtlCopyMemory(pOldAddress,
+                       pAddress,
+                       addressSize);
+
+         RtlCopyMemory(pAddress,
                        &sourceAddress,
-                       IPV4_ADDRESS_SIZE);
+                       addressSize);
 
          break;
       }
@@ -1663,14 +1827,38 @@ NTSTATUS KrnlHlprIPHeaderModifySourceAddress(_In_ const FWP_VALUE* pValue,
       {
          IP_HEADER_V6* pIPv6Header = (IP_HEADER_V6*)pIPHeader;
 
-         RtlCopyMemory(pIPv6Header->pSourceAddress,
+         pAddress    = pIPv6Header->pSourceAddress;
+         addressSize = IPV6_ADDRESS_SIZE;
+
+         RtlCopyMemory(pOldAddress,
+                       pAddress,
+                       addressSize);
+
+         RtlCopyMemory(pAddress,
                        &(pValue->byteArray16->byteArray16),
-                       IPV6_ADDRESS_SIZE);
+                       addressSize);
 
          break;
       }
    }
 
+   /// The address is part of the TCP / UDP pseudo-header.  Like the IPv4 Header Checksum, failing
+   /// to update it does not undo the address change.
+   if(updateTransportChecksum &&
+      pAddress)
+   {
+      NTSTATUS checksumStatus = PrvKrnlHlprTransportHeaderUpdateChecksum(pNetBufferList,
+                                                                         pIPHeader,
+                                                                         pOldAddress,
+                                                                         pAddress,
+                                                                         addressSize);
+      if(checksumStatus != STATUS_SUCCESS)
+         DbgPrintEx(DPFLTR_IHVNETWORK_ID,
+                    DPFLTR_ERROR_LEVEL,
+                    " !!!! KrnlHlprIPHeaderModifySourceAddress : PrvKrnlHlprTransportHeaderUpdateChecksum() [status: %#x]\n",
+                    checksumStatus);
+   }
+
    HLPR_BAIL_LABEL:
 
    if(needToFree)
@@ -1724,6 +1912,10 @@ NTSTATUS KrnlHlprIPHeaderModifySourceAddress(_In_ const FWP_VALUE* pValue,
                                                                                                 <br>
              Function is IP version agnostic.                                                   <br>
                                                                                                 <br>
+             If updateTransportChecksum is TRUE, the TCP / UDP Checksum is adjusted for the new
+                address (RFC 1624).  Only request this when that Checksum is complete (i.e. not 
+                left for offload).                                                              <br>
+                                                                                                <br>
    MSDN_Ref:                                                                                    <br>
 */
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -1734,7 +1926,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprIPHeaderModifyDestinationAddress(_In_ const FWP_VALUE* pValue,
                                                   _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                                   _In_ const BOOLEAN recalculateChecksum,  /* TRUE */
-                                                  _In_ BOOLEAN convertByteOrder)           /* FALSE */
+                                                  _In_ BOOLEAN convertByteOrder,           /* FALSE */
+                                                  _In_ BOOLEAN updateTransportChecksum)    /* FALSE */
 {
 #if DBG
    
@@ -1747,9 +1940,12 @@ NTSTATUS KrnlHlprIPHeaderModifyDestinationAddress(_In_ const FWP_VALUE* pValue,
    NT_ASSERT(pValue);
    NT_ASSERT(pNetBufferList);
 
-   NTSTATUS status     = STATUS_SUCCESS;
-   VOID*    pIPHeader  = 0;
-   BOOLEAN  needToFree = FALSE;
+   NTSTATUS status                         = STATUS_SUCCESS;
+   VOID*    pIPHeader                      = 0;
+   BOOLEAN  needToFree                     = FALSE;
+   BYTE*    pAddress                       = 0;
+   SIZE_T   addressSize                    = 0;
+   BYTE     pOldAddress[IPV6_ADDRESS_SIZE] = {0};
 
    status = KrnlHlprIPHeaderGet(pNetBufferList,
                                 &pIPHeader,
@@ -1763,9 +1959,16 @@ NTSTATUS KrnlHlprIPHeaderModifyDestinationAddress(_In_ const FWP_VALUE* pValue,
          IP_HEADER_V4* pIPv4Header        = (IP_HEADER_V4*)pIPHeader;
          UINT32        destinationAddress = convertByteOrder ? htonl(pValue->uint32) : pValue->uint32;
 
-         RtlCopyMemory(pIPv4Header->pDestinationAddress,
+         pAddress    = pIPv4Header->pDestinationAddress;
+         addressSize = IPV4_ADDRESS_SIZE;
+
+         RtlCopyMemory(pOldAddress,
+                       pAddress,
+                       addressSize);
+
+         RtlCopyMemory(pAddress,
                        &destinationAddress,
-                       IPV4_ADDRESS_SIZE);
+                       addressSize);
 
          break;
       }
@@ -1773,14 +1976,38 @@ NTSTATUS KrnlHlprIPHeaderModifyDestinationAddress(_In_ const FWP_VALUE* pValue,
       {
          IP_HEADER_V6* pIPv6Header = (IP_HEADER_V6*)pIPHeader;
 
-         RtlCopyMemory(pIPv6Header->pDestinationAddress,
+         pAddress    = pIPv6Header->pDestinationAddress;
+         addressSize = IPV6_ADDRESS_SIZE;
+
+         RtlCopyMemory(pOldAddress,
+                       pAddress,
+                       addressSize);
+
+         RtlCopyMemory(pAddress,
                        &(pValue->byteArray16->byteArray16),
-                       IPV6_ADDRESS_SIZE);
+                       addressSize);
 
          break;
       }
    }
 
+   /// The address is part of the TCP / UDP pseudo-header.  Like the IPv4 Header Checksum, failing
+   /// to update it does not undo the address change.
+   if(updateTransportChecksum &&
+      pAddress)
+   {
+      NTSTATUS checksumStatus = PrvKrnlHlprTransportHeaderUpdateChecksum(pNetBufferList,
+                                                                         pIPHeader,
+                                                                         pOldAddress,
+                                                                         pAddress,
+                                                                         addressSize);
+      if(checksumStatus != STATUS_SUCCESS)
+         DbgPrintEx(DPFLTR_IHVNETWORK_ID,
+                    DPFLTR_ERROR_LEVEL,
+                    " !!!! KrnlHlprIPHeaderModifyDestinationAddress : PrvKrnlHlprTransportHeaderUpdateChecksum() [status: %#x]\n",
+                    checksumStatus);
+   }
+
    HLPR_BAIL_LABEL:
 
    if(needToFree)
@@ -3473,6 +3700,9 @@ NTSTATUS KrnlHlprTCPHeaderGet(_In_ NET_BUFFER_LIST* pNetBufferList,
                                                                                                 <br>
              Values should be in Network Byte Order.                                            <br>
                                                                                                 <br>
+             If updateChecksum is TRUE, the TCP Checksum is adjusted incrementally (RFC 1624). 
+                Only request this when the Checksum is complete (i.e. not left for offload).    <br>
+                                                                                                <br>
    MSDN_Ref:                                                                                    <br>
 */
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -3483,7 +3713,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprTCPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                            _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                            _In_ UINT32 tcpHeaderSize,               /* 0 */
-                                           _In_ BOOLEAN convertByteOrder)           /* FALSE */
+                                           _In_ BOOLEAN convertByteOrder,           /* FALSE */
+                                           _In_ BOOLEAN updateChecksum)             /* FALSE */
 {
 #if DBG
 
@@ -3507,6 +3738,12 @@ NTSTATUS KrnlHlprTCPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                  tcpHeaderSize);
    HLPR_BAIL_ON_FAILURE(status);
 
+   if(updateChecksum)
+      pTCPHeader->checksum = KrnlHlprChecksumUpdate(pTCPHeader->checksum,
+                                                    (BYTE*)&(pTCPHeader->sourcePort),
+                                                    (BYTE*)&port,
+                                                    sizeof(UINT16));
+
    pTCPHeader->sourcePort = port;
 
    HLPR_BAIL_LABEL:
@@ -3557,6 +3794,9 @@ NTSTATUS KrnlHlprTCPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                                                                                 <br>
              Values should be in Network Byte Order.                                            <br>
                                                                                                 <br>
+             If updateChecksum is TRUE, the TCP Checksum is adjusted incrementally (RFC 1624). 
+                Only request this when the Checksum is complete (i.e. not left for offload).    <br>
+                                                                                                <br>
    MSDN_Ref:                                                                                    <br>
 */
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -3567,7 +3807,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprTCPHeaderModifyDestinationPort(_In_ const FWP_VALUE* pValue,
                                                 _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                                 _In_ UINT32 tcpHeaderSize,               /* 0 */
-                                                _In_ BOOLEAN convertByteOrder)           /* FALSE */
+                                                _In_ BOOLEAN convertByteOrder,           /* FALSE */
+                                                _In_ BOOLEAN updateChecksum)             /* FALSE */
 {
 #if DBG
    
@@ -3591,6 +3832,12 @@ NTSTATUS KrnlHlprTCPHeaderModifyDestinationPort(_In_ const FWP_VALUE* pValue,
                                  tcpHeaderSize);
    HLPR_BAIL_ON_FAILURE(status);
 
+   if(updateChecksum)
+      pTCPHeader->checksum = KrnlHlprChecksumUpdate(pTCPHeader->checksum,
+                                                    (BYTE*)&(pTCPHeader->destinationPort),
+                                                    (BYTE*)&port,
+                                                    sizeof(UINT16));
+
    pTCPHeader->destinationPort = port;
 
    HLPR_BAIL_LABEL:
@@ -3745,6 +3992,11 @@ NTSTATUS KrnlHlprUDPHeaderGet(_In_ NET_BUFFER_LIST* pNetBufferList,
                                                                                                 <br>
              Values should be in Network Byte Order.                                            <br>
                                                                                                 <br>
+             If updateChecksum is TRUE, the UDP Checksum is adjusted incrementally (RFC 1624). 
+                Only request this when the Checksum is complete (i.e. not left for offload).    <br>
+                                                                                                <br>
+             A UDP Checksum of 0 (none) is left alone.                                          <br>
+                                                                                                <br>
    MSDN_Ref:                                                                                    <br>
 */
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -3755,7 +4007,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprUDPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                            _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                            _In_ UINT32 udpHeaderSize,               /* 0 */
-                                           _In_ BOOLEAN convertByteOrder)           /* FALSE */
+                                           _In_ BOOLEAN convertByteOrder,           /* FALSE */
+                                           _In_ BOOLEAN updateChecksum)             /* FALSE */
 {
 #if DBG
    
@@ -3779,6 +4032,19 @@ NTSTATUS KrnlHlprUDPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                  udpHeaderSize);
    HLPR_BAIL_ON_FAILURE(status);
 
+   if(updateChecksum &&
+      pUDPHeader->checksum)
+   {
+      pUDPHeader->checksum = KrnlHlprChecksumUpdate(pUDPHeader->checksum,
+                                                    (BYTE*)&(pUDPHeader->sourcePort),
+                                                    (BYTE*)&port,
+                                                    sizeof(UINT16));
+
+      /// A computed Checksum of 0 is transmitted as all ones (RFC 768)
+      if(pUDPHeader->checksum == 0)
+         pUDPHeader->checksum = 0xFFFF;
+   }
+
    pUDPHeader->sourcePort = port;
 
    HLPR_BAIL_LABEL:
@@ -3829,6 +4095,11 @@ NTSTATUS KrnlHlprUDPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                                                                                 <br>
              Values should be in Network Byte Order.                                            <br>
                                                                                                 <br>
+             If updateChecksum is TRUE, the UDP Checksum is adjusted incrementally (RFC 1624). 
+                Only request this when the Checksum is complete (i.e. not left for offload).    <br>
+                                                                                                <br>
+             A UDP Checksum of 0 (none) is left alone.                                          <br>
+                                                                                                <br>
    MSDN_Ref:                                                                                    <br>
 */
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -3839,7 +4110,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprUDPHeaderModifyDestinationPort(_In_ const FWP_VALUE* pValue,
                                                 _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                                 _In_ UINT32 udpHeaderSize,               /* 0 */
-                                                _In_ BOOLEAN convertByteOrder)           /* FALSE */
+                                                _In_ BOOLEAN convertByteOrder,           /* FALSE */
+                                                _In_ BOOLEAN updateChecksum)             /* FALSE */
 {
 #if DBG
    
@@ -3863,6 +4135,19 @@ NTSTATUS KrnlHlprUDPHeaderModifyDestinationPort(_In_ const FWP_VALUE* pValue,
                                  udpHeaderSize);
    HLPR_BAIL_ON_FAILURE(status);
 
+   if(updateChecksum &&
+      pUDPHeader->checksum)
+   {
+      pUDPHeader->checksum = KrnlHlprChecksumUpdate(pUDPHeader->checksum,
+                                                    (BYTE*)&(pUDPHeader->destinationPort),
+                                                    (BYTE*)&port,
+                                                    sizeof(UINT16));
+
+      /// A computed Checksum of 0 is transmitted as all ones (RFC 768)
+      if(pUDPHeader->checksum == 0)
+         pUDPHeader->checksum = 0xFFFF;
+   }
+
    pUDPHeader->destinationPort = port;
 
    HLPR_BAIL_LABEL:
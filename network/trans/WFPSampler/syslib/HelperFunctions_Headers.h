@@ -489,7 +489,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprIPHeaderModifySourceAddress(_In_ const FWP_VALUE* pValue,
                                              _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                              _In_ const BOOLEAN recalculateChecksum = TRUE,
-                                             _In_ BOOLEAN convertByteOrder = FALSE);
+                                             _In_ BOOLEAN convertByteOrder = FALSE,
+                                             _In_ BOOLEAN updateTransportChecksum = FALSE);
 
 _IRQL_requires_min_(PASSIVE_LEVEL)
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -499,7 +500,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprIPHeaderModifyDestinationAddress(_In_ const FWP_VALUE* pValue,
                                                   _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                                   _In_ const BOOLEAN recalculateChecksum = TRUE,
-                                                  _In_ BOOLEAN convertByteOrder = FALSE);
+                                                  _In_ BOOLEAN convertByteOrder = FALSE,
+                                                  _In_ BOOLEAN updateTransportChecksum = FALSE);
 
 _IRQL_requires_min_(PASSIVE_LEVEL)
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -632,7 +634,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprTCPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                            _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                            _In_ UINT32 tcpHeaderSize = 0,
-                                           _In_ BOOLEAN convertByteOrder = FALSE);
+                                           _In_ BOOLEAN convertByteOrder = FALSE,
+                                           _In_ BOOLEAN updateChecksum = FALSE);
 
 _IRQL_requires_min_(PASSIVE_LEVEL)
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -642,7 +645,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprTCPHeaderModifyDestinationPort(_In_ const FWP_VALUE* pValue,
                                                 _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                                 _In_ UINT32 tcpHeaderSize = 0,
-                                                _In_ BOOLEAN convertByteOrder = FALSE);
+                                                _In_ BOOLEAN convertByteOrder = FALSE,
+                                                _In_ BOOLEAN updateChecksum = FALSE);
 
 _When_(return != STATUS_SUCCESS, _At_(*ppUDPHeader, _Post_ _Null_))
 _When_(return == STATUS_SUCCESS, _At_(*ppUDPHeader, _Post_ _Notnull_))
@@ -663,7 +667,8 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprUDPHeaderModifySourcePort(_In_ const FWP_VALUE* pValue,
                                            _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                            _In_ UINT32 udpHeaderSize = 0,
-                                           _In_ BOOLEAN convertByteOrder = FALSE);
+                                           _In_ BOOLEAN convertByteOrder = FALSE,
+                                           _In_ BOOLEAN updateChecksum = FALSE);
 
 _IRQL_requires_min_(PASSIVE_LEVEL)
 _IRQL_requires_max_(DISPATCH_LEVEL)
@@ -673,6 +678,7 @@ _Success_(return == STATUS_SUCCESS)
 NTSTATUS KrnlHlprUDPHeaderModifyDestinationPort(_In_ const FWP_VALUE* pValue,
                                                 _Inout_ NET_BUFFER_LIST* pNetBufferList,
                                                 _In_ UINT32 udpheaderSize = 0,
-                                                _In_ BOOLEAN convertByteOrder = FALSE);
+                                                _In_ BOOLEAN convertByteOrder = FALSE,
+                                                _In_ BOOLEAN updateChecksum = FALSE);
 
 #endif /// HELPERFUNCTIONS_HEADERS_H
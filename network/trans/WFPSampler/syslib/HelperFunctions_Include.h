@@ -26,6 +26,7 @@
 #include "HelperFunctions_Macros.h"                 /// .
 #include "HelperFunctions_NDIS.h"                   /// .
 #include "HelperFunctions_ICMPMessages.h"           /// .
+#include "HelperFunctions_Checksum.h"               /// .
 #include "HelperFunctions_Headers.h"                /// .
 #include "HelperFunctions_FwpObjects.h"             /// .
 #include "HelperFunctions_FlowContext.h"            /// .
@@ -59,6 +59,7 @@ DefragAddRFD(
 	OCTET_STRING	frame;
 	u1Byte			QosCtrlLen = 0;		// Added by Annie, 2006-01-09.
 	u1Byte			HTCLen = 0;
+	u2Byte			HomeSlot;
 	PMGNT_INFO      pMgntInfo = &Adapter->MgntInfo;
 
 	if( pRfd->Status.bIsQosData )
@@ -69,8 +70,10 @@ DefragAddRFD(
 		HTCLen = sHTCLng;
 
 	if(FragNum==0)
-	{	// First frag, find a vacancy entry
-		pEntry=DefragFindFreeEntry(Adapter->DefragArray, 	MAX_DEFRAG_PEER);
+	{	// First frag, find a vacancy entry, starting from the home slot of this MSDU
+		HomeSlot=DefragHashSlot(pSenderAddr, TID, SeqNum, MAX_DEFRAG_PEER);
+
+		pEntry=DefragFindFreeEntry(Adapter->DefragArray, 	MAX_DEFRAG_PEER, HomeSlot);
 
 		if(pEntry==NULL)
 		{
@@ -81,7 +84,7 @@ DefragAddRFD(
 				PlatformGetCurrentTime(),
 				Adapter);
 
-			pEntry=DefragFindFreeEntry(Adapter->DefragArray, 	MAX_DEFRAG_PEER);
+			pEntry=DefragFindFreeEntry(Adapter->DefragArray, 	MAX_DEFRAG_PEER, HomeSlot);
 		}
 		
 		if(pEntry==NULL)
@@ -92,7 +95,7 @@ DefragAddRFD(
 								MAX_DEFRAG_PEER,
 								Adapter);
 
-			pEntry=DefragFindFreeEntry(Adapter->DefragArray, 	MAX_DEFRAG_PEER);
+			pEntry=DefragFindFreeEntry(Adapter->DefragArray, 	MAX_DEFRAG_PEER, HomeSlot);
 
 			RT_ASSERT(pEntry!=NULL, ("DefragAddRFD(): pEntry should not be NULL.\n"));
 			
@@ -156,6 +159,33 @@ DefragAddRFD(
  *	Note:	Following functions should not be called outside Defrag.c
  *
 */
+
+//
+// Entries are placed by open addressing: the first fragment of an MSDU takes
+// the first free entry at or after the home slot of its (TA, TID, SeqNum), and
+// DefragSearch probes from the same slot. With only a few MSDUs in flight a
+// fragment is found on the first probe instead of after a scan of the array.
+// Entries are released in place without moving others, so a miss still walks
+// every slot; misses only happen for orphan fragments.
+//
+u2Byte
+DefragHashSlot(
+	pu1Byte			pSenderAddr,
+	u1Byte			TID,
+	u2Byte			SeqNum,
+	u2Byte			Size
+	)
+{
+	u4Byte	Hash;
+
+	// The low bytes of the TA differ most between stations.
+	Hash = (pSenderAddr[5] << 8) | pSenderAddr[4];
+	Hash ^= (SeqNum * 0x9E37) ^ (TID << 12);
+	Hash ^= Hash >> 7;
+
+	return (u2Byte)(Hash % Size);
+}
+
 VOID
 DefragInit(
 	PDEFRAG_ENTRY	pDefragArray,
@@ -180,9 +210,11 @@ DefragSearch(
 	u1Byte			FragNum
 	)
 {
-	u2Byte	i;
+	u2Byte	n, i;
+
+	i = DefragHashSlot(pSenderAddr, TID, SeqNum, Size);
 	
-	for(i=0;i<Size;i++)
+	for(n=0;n<Size;n++, i=(i+1 == Size) ? 0 : i+1)
 	{
 		if(!pDefragArray[i].bUsed)
 			continue;
@@ -233,12 +265,13 @@ DefragRemoveOldest(
 PDEFRAG_ENTRY
 DefragFindFreeEntry(
 	PDEFRAG_ENTRY	pDefragArray,
-	u2Byte			Size
+	u2Byte			Size,
+	u2Byte			HomeSlot
 	)
 {
-	u2Byte	i;
+	u2Byte	n, i;
 	
-	for(i=0;i<Size;i++)
+	for(n=0, i=HomeSlot;n<Size;n++, i=(i+1 == Size) ? 0 : i+1)
 	{
 		if(!pDefragArray[i].bUsed)
 			return &pDefragArray[i];
@@ -31,6 +31,14 @@ DefragReset(
  *	Note:	Following functions should not be called outside Defrag.c
  *
 */
+u2Byte
+DefragHashSlot(
+	pu1Byte			pSenderAddr,
+	u1Byte			TID,
+	u2Byte			SeqNum,
+	u2Byte			Size
+	);
+
 VOID
 DefragInit(
 	PDEFRAG_ENTRY	pDefragArray,
@@ -55,7 +63,8 @@ DefragRemoveOldest(
 PDEFRAG_ENTRY
 DefragFindFreeEntry(
 	PDEFRAG_ENTRY	pDefragArray,
-	u2Byte			Size
+	u2Byte			Size,
+	u2Byte			HomeSlot
 	);
 
 VOID
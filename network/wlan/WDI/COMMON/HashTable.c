@@ -16,6 +16,14 @@
 //		2. This implementation is not thread-safe, that is, user have to 
 //		protect related resource and the function exported here by their 
 //		own means.
+//
+//		3. Keys are placed in an open addressed slot array with linear 
+//		probing. Each slot keeps a 32-bit digest of its key, so a probe 
+//		only touches the value object when the digests match. The slot 
+//		array has at least twice as many slots as value objects, so it is 
+//		never more than half full and a probe always ends at an empty slot.
+//		Removal shifts the following entries back instead of leaving 
+//		tombstones.
 //		
 //	070606, by rcnjko.
 //-----------------------------------------------------------------------------
@@ -37,8 +45,23 @@ RtCompareKeys(
 	IN pu1Byte		Key2,
 	IN u4Byte		KeySize
 	);
+
+u4Byte
+RtDigestKey(
+	IN pu1Byte		Key,
+	IN u4Byte		KeySize
+	);
+
+u4Byte
+RtLookupSlot(
+	IN RT_HASH_TABLE_HANDLE	hHashTable,
+	IN RT_HASH_KEY			Key,
+	IN u4Byte				Digest
+	);
 //================================================================================
 
+#define RT_HASH_TABLE_SIZE(__NumSlots) (sizeof(RT_HASH_TABLE) + (((__NumSlots) - 1) * sizeof(RT_HASH_SLOT)))
+
 
 //
 // Description;
@@ -57,19 +80,20 @@ RtResetHashTable(
 		pTmpListEntry = RTRemoveHeadList(&(hHashTable->BusyValuesList));
 		pHashEntry = RT_HASH_ENTRY_FROM_BUSY_LINK( pTmpListEntry );
 
-		RTRemoveEntryList( &(pHashEntry->BucketLink) );
 		RTInsertTailSList( &(hHashTable->FreeValuesList), &(pHashEntry->FreeLink) );
 	}
 
+	PlatformZeroMemory(hHashTable->Slots, hHashTable->NumSlots * sizeof(RT_HASH_SLOT));
+
 #if DBG
 	{
 		PRT_SINGLE_LIST_ENTRY pTmpSListEntry;
 		u4Byte				idx;
 
 		RT_ASSERT( RTIsListEmpty(&(hHashTable->BusyValuesList)), ("hHashTable(%p) BusyValuesList(%p) should be empty!!!\n", hHashTable, &(hHashTable->BusyValuesList) ));
-		for(idx = 0; idx < hHashTable->Capacity; idx++)
+		for(idx = 0; idx < hHashTable->NumSlots; idx++)
 		{
-			RT_ASSERT( RTIsListEmpty(&(hHashTable->Buckets[idx])), ("hHashTable(%p) Buckets[%d]:%p should be empty!!!\n", hHashTable, idx, &(hHashTable->Buckets[idx])));
+			RT_ASSERT( hHashTable->Slots[idx].pEntry == NULL, ("hHashTable(%p) Slots[%d]:%p should be empty!!!\n", hHashTable, idx, &(hHashTable->Slots[idx])));
 		}
 
 		idx = 0;
@@ -101,7 +125,7 @@ RtResetHashTable(
 //		It will reset hash table to initial state for further operation.
 //
 //	Input:
-//		Capacity: number of bucket of the hash table to allocated.
+//		Capacity: number of value objects of the hash table to allocated.
 //		ValueSize: number of byte of a value object.
 //		KeySize: number of byte of the key. 
 //		pfHash: pointer to the hash function, see definition of RT_HT_HASH_FUNC for detail.
@@ -127,7 +151,8 @@ RtAllocateHashTable(
 	PADAPTER				pAdapter = (PADAPTER)Adapter;
 	RT_STATUS				rtStatus;
 	RT_HASH_TABLE_HANDLE	pTable = NULL;
-	u4Byte					TableSize;
+	u4Byte					TableSize = 0;
+	u4Byte					NumSlots;
 	u4Byte					NumValuesAlloc = Capacity;
 	pu1Byte					pValuesBuf = NULL;
 	u4Byte					ValuesBufSize=0;
@@ -142,9 +167,11 @@ RtAllocateHashTable(
 
 	do {
 		//
-		// Allocate memory for hash table.
+		// Allocate memory for hash table, with at least two slots per value object.
 		//
-		TableSize = sizeof(RT_HASH_TABLE) + ((Capacity - 1) * sizeof(RT_LIST_ENTRY));
+		for(NumSlots = 2; NumSlots < (Capacity * 2); NumSlots <<= 1)
+			;
+		TableSize = RT_HASH_TABLE_SIZE(NumSlots);
 		rtStatus = PlatformAllocateMemory(pAdapter, (PVOID*)(&pTable), TableSize);
 		if( RT_STATUS_SUCCESS != rtStatus )
 		{
@@ -207,10 +234,7 @@ RtAllocateHashTable(
 		pTable->pfHash = pfHash;
 		RTInitializeListHead( &(pTable->BusyValuesList) );
 		pTable->Capacity = Capacity;
-		for(idx = 0; idx < Capacity; idx++)
-		{
-			RTInitializeListHead( &(pTable->Buckets[idx]) );
-		}
+		pTable->NumSlots = NumSlots;
 
 		//
 		// Return the hash table allocated.
@@ -246,24 +270,65 @@ RtGetValueFromHashTable(
 	IN RT_HASH_KEY			Key
 	)
 {
-	PRT_HASH_ENTRY		pHashEntry = NULL;
-	PRT_LIST_ENTRY		pTmpListEntry;
 	u4Byte				idx;
 
-	idx = hHashTable->pfHash(Key);
-	for( pTmpListEntry = hHashTable->Buckets[idx].Flink;
-		 pTmpListEntry != &(hHashTable->Buckets[idx]); 
-		 pTmpListEntry = pTmpListEntry->Flink )
+	idx = RtLookupSlot(hHashTable, Key, RtDigestKey(Key, hHashTable->KeySize));
+
+	return hHashTable->Slots[idx].pEntry;
+}
+
+//
+// Description:
+//	Return the slot holding the specified key if found, otherwise the empty slot 
+//	where the probe for it ended, which is where the key is to be put.
+//
+u4Byte
+RtLookupSlot(
+	IN RT_HASH_TABLE_HANDLE	hHashTable,
+	IN RT_HASH_KEY			Key,
+	IN u4Byte				Digest
+	)
+{
+	PRT_HASH_SLOT		pSlot;
+	u4Byte				Mask = hHashTable->NumSlots - 1;
+	u4Byte				idx;
+
+	for( idx = Digest & Mask; ; idx = (idx + 1) & Mask )
 	{
-		pHashEntry = RT_HASH_ENTRY_FROM_BUCKET_LINK(pTmpListEntry);
-		// Compare the keys if they are equal.
-		if( RtCompareKeys(Key, pHashEntry->Key, hHashTable->KeySize) == 0 )
-		{ 
-			return pHashEntry;
-		}
-	}	
+		pSlot = &(hHashTable->Slots[idx]);
+		if( pSlot->pEntry == NULL )
+			break;
 
-	return NULL;
+		// Compare the keys only if the digests are equal.
+		if( pSlot->Digest == Digest && 
+			RtCompareKeys(Key, pSlot->pEntry->Key, hHashTable->KeySize) == 0 )
+			break;
+	}
+
+	return idx;
+}
+
+//
+// Description:
+//	Return a 32-bit digest of the key (FNV-1a).
+//
+u4Byte
+RtDigestKey(
+	IN pu1Byte		Key,
+	IN u4Byte		KeySize
+	)
+{
+	u4Byte		Digest = 2166136261;
+	u4Byte		idx;
+
+	for(idx = 0; idx < KeySize; idx++)
+	{
+		Digest ^= Key[idx];
+		Digest *= 16777619;
+	}
+
+	// Fold the high bits down, only the low bits select the home slot.
+	return Digest ^ (Digest >> 16);
 }
 
 //
@@ -307,21 +372,23 @@ RtPutKeyToHashTable(
 {
 	PRT_HASH_ENTRY			pHashEntry = NULL;
 	PRT_SINGLE_LIST_ENTRY	pTmpSListEntry;
+	u4Byte					Digest;
 	u4Byte					idx;
 
 	//
 	// Check if Key had existed. if yse, return previous entry.
 	//
-	if((pHashEntry = RtGetValueFromHashTable(hHashTable, Key)) != NULL)
+	Digest = RtDigestKey(Key, hHashTable->KeySize);
+	idx = RtLookupSlot(hHashTable, Key, Digest);
+	if((pHashEntry = hHashTable->Slots[idx].pEntry) != NULL)
 	{
 		return pHashEntry;
 	}
 	
 	//
 	// Retrive an value object from pool for a new Key, 
-	// and put it into hash table.
+	// and put it into the empty slot the lookup ended at.
 	//
-	idx = hHashTable->pfHash(Key);
 	if( !RTIsSListEmpty(&(hHashTable->FreeValuesList)) )
 	{
 		pTmpSListEntry = RTRemoveHeadSList(&(hHashTable->FreeValuesList));
@@ -329,7 +396,8 @@ RtPutKeyToHashTable(
 
 		PlatformMoveMemory(pHashEntry->Key, Key, hHashTable->KeySize);
 		RTInsertTailList(&(hHashTable->BusyValuesList), &(pHashEntry->BusyLink));
-		RTInsertTailList(&(hHashTable->Buckets[idx]), &(pHashEntry->BucketLink));
+		hHashTable->Slots[idx].pEntry = pHashEntry;
+		hHashTable->Slots[idx].Digest = Digest;
 	}
 
 	return pHashEntry;
@@ -367,7 +435,7 @@ RtFreeHashTable(
 			PlatformFreeMemory(hHashTable->pValuesBuf, ValuesBufSize);
 		}
 	
-		TableSize = sizeof(RT_HASH_TABLE) + ((hHashTable->Capacity - 1) * sizeof(RT_LIST_ENTRY));
+		TableSize = RT_HASH_TABLE_SIZE(hHashTable->NumSlots);
 		RT_TRACE(COMP_INIT, DBG_TRACE, ("RtFreeHashTable(): hHashTable: %p, TableSize: %d\n", hHashTable, TableSize));
 		PlatformFreeMemory(hHashTable, TableSize);
 	}
@@ -384,22 +452,36 @@ RtRemoveKeyFromVaHashTable(
 	)
 {
 	PRT_HASH_ENTRY	pHashEntry = NULL;
-	PRT_LIST_ENTRY	pTmpListEntry;
+	u4Byte			Mask = hHashTable->NumSlots - 1;
+	u4Byte			Hole;
 	u4Byte			idx;
+	u4Byte			Home;
+
+	Hole = RtLookupSlot(hHashTable, Key, RtDigestKey(Key, hHashTable->KeySize));
+	pHashEntry = hHashTable->Slots[Hole].pEntry;
+	if(pHashEntry == NULL)
+		return;
 
-	idx = hHashTable->pfHash(Key);
-	for( pTmpListEntry = hHashTable->Buckets[idx].Flink;
-		 pTmpListEntry != &(hHashTable->Buckets[idx]); 
-		 pTmpListEntry = pTmpListEntry->Flink )
+	RTRemoveEntryList( &(pHashEntry->BusyLink) );
+	RTInsertTailSList( &(hHashTable->FreeValuesList), &(pHashEntry->FreeLink) );
+
+	//
+	// Shift back the entries following the hole that can not be reached 
+	// from their home slot anymore, so a probe still never crosses an 
+	// empty slot before it finds its key.
+	//
+	for( idx = (Hole + 1) & Mask; hHashTable->Slots[idx].pEntry != NULL; idx = (idx + 1) & Mask )
 	{
-		pHashEntry = RT_HASH_ENTRY_FROM_BUCKET_LINK(pTmpListEntry);
-		if( RtCompareKeys(Key, pHashEntry->Key, hHashTable->KeySize) == 0 )
-		{ 
-			RTRemoveEntryList( &(pHashEntry->BucketLink) );
-			RTRemoveEntryList( &(pHashEntry->BusyLink) );
+		Home = hHashTable->Slots[idx].Digest & Mask;
 
-			RTInsertTailSList( &(hHashTable->FreeValuesList), &(pHashEntry->FreeLink) );
+		// Move it if the hole lies between its home slot and where it is now.
+		if( ((idx - Home) & Mask) >= ((idx - Hole) & Mask) )
+		{
+			hHashTable->Slots[Hole] = hHashTable->Slots[idx];
+			Hole = idx;
 		}
-	}	
+	}
+
+	hHashTable->Slots[Hole].pEntry = NULL;
 }
 
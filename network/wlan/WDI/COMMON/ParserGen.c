@@ -64,6 +64,14 @@ RuleMatchingProcess(
 	IN		PGENERIC_PARSER		pParser
 	);
 
+BOOLEAN
+MatchingByProtocol(
+	IN		PADAPTER			Adapter,
+	IN		PGPPARSE_TOKEN		pToken,
+	IN		PGENERIC_PARSER		pParser,
+	OUT		PGP_RULE			*ppRule
+	);
+
 BOOLEAN
 MatchingByRule(
 	IN		PADAPTER			Adapter,
@@ -226,56 +234,87 @@ RuleMatchingProcess(
 {
 	PGP_RULE	pRule = NULL;
 	BOOLEAN		bMatched = FALSE;
+
+	//
+	// Keep matching until no rule matches the current protocol or the
+	// matched rule ends the protocol chain.
+	//
+	do
+	{
+		bMatched = MatchingByProtocol(Adapter, pToken, pParser, &pRule);
+	} while (bMatched && pRule->NextProtocol != PROTO_UNKNOWN);
+
+	if (!bMatched) 
+	{
+		DbgProtocol(pToken->currProtocol);
+		if (pToken->ProtocolCount < MAX_PROTOCOL_NUM)
+			pToken->ProtocolSuite[pToken->ProtocolCount++] = pToken->currProtocol;
+	}
+	DbgProtocol(PROTO_UNKNOWN);
+}
+
+//
+//	Description:
+//		Try the rules of the current protocol in order, parser's rules
+//		first and then global rules, until one matches.
+//
+//	Note:
+//		The rules come from the table built by GPCompileRules(), so only
+//		rules of the current protocol are visited. If the rules could not
+//		be compiled or the protocol is out of the table, both rule sets
+//		are walked instead, in the same order.
+//
+BOOLEAN
+MatchingByProtocol(
+	IN		PADAPTER			Adapter,
+	IN		PGPPARSE_TOKEN		pToken,
+	IN		PGENERIC_PARSER		pParser,
+	OUT		PGP_RULE			*ppRule
+	)
+{
+	PGP_RULE	pRule;
 	PGP_RULE	pRuleSet[2];
-	u4Byte		i=0;
+	PROTO_ID	currProtocol = pToken->currProtocol;
+	u4Byte		i;
+
+	if (pParser->bRulesCompiled && currProtocol < MAX_HP_PROTOCOL_PER_PARSER)
+	{
+		for (i = pParser->RuleStart[currProtocol];
+			i < pParser->RuleStart[currProtocol + 1];
+			i ++)
+		{
+			pRule = pParser->RuleTable[i];
+			if (MatchingByRule(Adapter, pRule, pToken, pParser))
+			{
+				*ppRule = pRule;
+				return TRUE;
+			}
+		}
+
+		return FALSE;
+	}
 
 	pRuleSet[0] = pParser->pParseRules;
 	pRuleSet[1] = GPGlobalRule;
-	
-	while ( i < sizeof(pRuleSet) / sizeof(PGP_RULE) )
-	{		
-		//
-		// Go through parser's rules & global rules.
-		//
-		bMatched = FALSE;
-		
+
+	for (i = 0; i < sizeof(pRuleSet) / sizeof(PGP_RULE); i ++)
+	{
 		for (pRule = pRuleSet[i];
 			(pRule != NULL) && (pRule->CurrProtocol != 0);
 			pRule ++)
 		{
-			if (pRule->CurrProtocol == pToken->currProtocol)
+			if (pRule->CurrProtocol == currProtocol)
 			{
-				bMatched = MatchingByRule(Adapter,
-										pRule,
-										pToken,
-										pParser);
-				if (bMatched)
-					break;	
+				if (MatchingByRule(Adapter, pRule, pToken, pParser))
+				{
+					*ppRule = pRule;
+					return TRUE;
+				}
 			}
 		}
-
-		if (bMatched)
-		{
-			if (pRule->NextProtocol != PROTO_UNKNOWN)
-			{
-				i = 0;
-			}
-			else
-			{
-				break;
-			}
-		}		
-		else
-			i ++;
 	}
 
-	if (!bMatched) 
-	{
-		DbgProtocol(pToken->currProtocol);
-		if (pToken->ProtocolCount < MAX_PROTOCOL_NUM)
-			pToken->ProtocolSuite[pToken->ProtocolCount++] = pToken->currProtocol;
-	}
-	DbgProtocol(PROTO_UNKNOWN);
+	return FALSE;
 }
 
 //
@@ -860,6 +899,57 @@ GPUseHPParser(
 	pParser->bUseHP = TRUE;
 }
 
+//
+//	Description:
+//		Index parser's rules and global rules by current protocol, so
+//		MatchingByProtocol() only visits the rules that can match. The
+//		rules of a protocol keep the order the rule walker would try them
+//		in: parser's rules first, then global rules, each in table order.
+//		Called whenever rules are registered or unregistered.
+//
+VOID
+GPCompileRules(
+	IN		PGENERIC_PARSER	pParser
+	)
+{
+	PGP_RULE	pRuleSet[2];
+	PGP_RULE	pRule;
+	u4Byte		protocol, i;
+	u4Byte		count = 0;
+
+	pParser->bRulesCompiled = FALSE;
+
+	pRuleSet[0] = pParser->pParseRules;
+	pRuleSet[1] = GPGlobalRule;
+
+	for (protocol = 0; protocol < MAX_HP_PROTOCOL_PER_PARSER; protocol ++)
+	{
+		pParser->RuleStart[protocol] = (u1Byte)count;
+
+		for (i = 0; i < sizeof(pRuleSet) / sizeof(PGP_RULE); i ++)
+		{
+			for (pRule = pRuleSet[i];
+				(pRule != NULL) && (pRule->CurrProtocol != 0);
+				pRule ++)
+			{
+				if (pRule->CurrProtocol != protocol)
+					continue;
+
+				if (count == MAX_HP_RULES_PER_PARSER)
+				{
+					RT_TRACE(COMP_CCX, DBG_WARNING, ("GPCompileRules(): Too many rules (limit = %d), walk the rules instead\n", MAX_HP_RULES_PER_PARSER));
+					return;
+				}
+
+				pParser->RuleTable[count++] = pRule;
+			}
+		}
+	}
+
+	pParser->RuleStart[MAX_HP_PROTOCOL_PER_PARSER] = (u1Byte)count;
+	pParser->bRulesCompiled = TRUE;
+}
+
 //
 //	Description:
 //		This routine parse ethernet header.
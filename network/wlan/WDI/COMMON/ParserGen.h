@@ -72,10 +72,10 @@ Major Change History:
 ////////////////////////////////////////////////////////
 
 #define GP_REGISTER_RULES(_parser, _rules) \
-	(_parser)->pParseRules = (_rules)
+	((_parser)->pParseRules = (_rules), GPCompileRules(_parser))
 
 #define GP_UNREGISTER_RULES(_parser) \
-	(_parser)->pParseRules = NULL
+	((_parser)->pParseRules = NULL, GPCompileRules(_parser))
 
 #define GP_GET_CONTEXT(_parser) \
 	(_parser)->ParserContext
@@ -191,6 +191,9 @@ typedef struct _GP_HP_NODE
 //
 //	bUseHP:
 //		Use high performance parser.
+//	bRulesCompiled, RuleStart, RuleTable:
+//		Parser's rules and global rules indexed by current protocol, 
+//		see GPCompileRules().
 // By Bruce, 2008-03-11.
 //
 typedef struct _GENERIC_PARSER
@@ -203,6 +206,9 @@ typedef struct _GENERIC_PARSER
 	GPParserAction	Action;
 	PGP_HP_NODE		pParsingTree;
 	BOOLEAN			bUseHP;
+	BOOLEAN			bRulesCompiled;
+	u1Byte			RuleStart[MAX_HP_PROTOCOL_PER_PARSER + 1];
+	PGP_RULE		RuleTable[MAX_HP_RULES_PER_PARSER];
 } GENERIC_PARSER, *PGENERIC_PARSER;
 
 //
@@ -244,6 +250,11 @@ GPUseHPParser(
 	IN		PGENERIC_PARSER	pParser
 	);
 
+VOID
+GPCompileRules(
+	IN		PGENERIC_PARSER	pParser
+	);
+
 BOOLEAN
 GPParserHandlerEthernet(
 	IN		PADAPTER		Adapter,
@@ -5,6 +5,106 @@
 #endif
 
 
+#define RX_REORDER_SLOT_USED(_pTS, _Slot)	(((_pTS)->RxReorderBitmap[(_Slot) >> 5] & ((u4Byte)1 << ((_Slot) & 31))) != 0)
+#define RX_REORDER_SLOT_ENTRY(_pMgntInfo, _pTS, _Slot)	(&(_pMgntInfo)->RxReorderEntry[(_pTS)->RxReorderSlot[(_Slot)]])
+
+static u1Byte
+RxReorderHighestBit(
+	IN	u4Byte		Bits
+	)
+{
+	u1Byte	Bit = 0;
+
+	if(Bits & 0xFFFF0000)	{ Bits >>= 16;	Bit += 16; }
+	if(Bits & 0xFF00)		{ Bits >>= 8;	Bit += 8; }
+	if(Bits & 0xF0)		{ Bits >>= 4;	Bit += 4; }
+	if(Bits & 0xC)			{ Bits >>= 2;	Bit += 2; }
+	if(Bits & 0x2)			{ Bit += 1; }
+
+	return Bit;
+}
+
+//
+// Description:
+//	Find the closest used slot before *pPos in the reorder index, looking at no more than *pRemaining slots
+//	and wrapping around the ring. On success *pPos is the slot found and *pRemaining is reduced by the
+//	distance, so the caller can continue the search from there.
+//
+static BOOLEAN
+RxReorderFindPrevSlot(
+	IN		PRX_TS_RECORD	pTS,
+	IN OUT	pu2Byte			pPos,
+	IN OUT	pu2Byte			pRemaining
+	)
+{
+	u2Byte	Pos = (*pPos - 1) & RX_REORDER_RING_MASK;
+	u2Byte	Remaining = *pRemaining;
+
+	while(Remaining > 0)
+	{
+		u2Byte	Span = (Pos & 31) + 1;
+		u4Byte	Bits = pTS->RxReorderBitmap[Pos >> 5];
+
+		// Only look at the bits at or below Pos, and no further back than Remaining.
+		if(Span < 32)
+			Bits &= ((u4Byte)1 << Span) - 1;
+		if(Span > Remaining)
+		{
+			Bits &= ~(((u4Byte)1 << (Span - Remaining)) - 1);
+			Span = Remaining;
+		}
+
+		if(Bits)
+		{
+			u2Byte	Found = (Pos & ~31) + RxReorderHighestBit(Bits);
+
+			*pRemaining = Remaining - (Pos - Found) - 1;
+			*pPos = Found;
+			return TRUE;
+		}
+
+		Remaining -= Span;
+		Pos = (Pos - Span) & RX_REORDER_RING_MASK;
+	}
+
+	*pRemaining = 0;
+	return FALSE;
+}
+
+static VOID
+RxReorderUnindexEntry(
+	IN	PMGNT_INFO			pMgntInfo,
+	IN	PRX_TS_RECORD		pTS,
+	IN	PRX_REORDER_ENTRY	pReorderEntry
+	)
+{
+	u2Byte	Slot = pReorderEntry->SeqNum & RX_REORDER_RING_MASK;
+
+	if(RX_REORDER_SLOT_USED(pTS, Slot) && RX_REORDER_SLOT_ENTRY(pMgntInfo, pTS, Slot) == pReorderEntry)
+		pTS->RxReorderBitmap[Slot >> 5] &= ~((u4Byte)1 << (Slot & 31));
+}
+
+//
+// Description:
+//	Forget the reorder index of the TS. Must be called whenever RxPendingPktList is emptied without going
+//	through IndicateRxReorderList().
+//
+VOID
+RxReorderResetIndex(
+	IN	PRX_TS_RECORD			pTS
+	)
+{
+	PlatformZeroMemory(pTS->RxReorderBitmap, sizeof(pTS->RxReorderBitmap));
+}
+
+//
+// Description:
+//	Insert the packet into the pending list of the TS, which is kept sorted by SeqNum.
+//	The reorder index gives the closest buffered predecessor, so the cost does not depend on how many
+//	packets of the BlockAck window are already buffered. A packet whose slot is already held by a packet
+//	one ring apart is left out of the index; the short list walk from the predecessor still places it and
+//	catches its duplicates.
+//
 BOOLEAN
 InsertRxReorderList(
 	IN	PADAPTER		Adapter,
@@ -16,50 +116,72 @@ InsertRxReorderList(
 	PMGNT_INFO			pMgntInfo = &Adapter->MgntInfo;
 	PRX_REORDER_ENTRY 	pReorderEntry;
 	PRT_LIST_ENTRY	pList = &pTS->RxPendingPktList;
+	u2Byte			Slot = SeqNum & RX_REORDER_RING_MASK;
+	u2Byte			Pos = Slot;
+	u2Byte			Remaining = RX_REORDER_RING_SIZE - 1;
+	BOOLEAN			bIndexed = TRUE;
 
-	if(!RTIsListEmpty(&pMgntInfo->RxReorder_Unused_List))
+	if(RTIsListEmpty(&pMgntInfo->RxReorder_Unused_List))
 	{
-		pReorderEntry = (PRX_REORDER_ENTRY)RTRemoveHeadList(&pMgntInfo->RxReorder_Unused_List);
-
-		// Make a reorder entry and insert into a the packet list.
-		pReorderEntry->SeqNum = SeqNum;
-		pReorderEntry->pRfd = pRfd;
+		// This part shall be modified!! We can just indicate all the packets in buffer and get reorder entries.
+		RT_TRACE(COMP_RX_REORDER, DBG_WARNING, ("InsertRxReorderList(): There is no reorder entry!! Packet is dropped!!\n"));
+		return FALSE;
+	}
 
-		while(pList->Blink != &pTS->RxPendingPktList)
+	if(RX_REORDER_SLOT_USED(pTS, Slot))
+	{
+		if(SN_EQUAL(RX_REORDER_SLOT_ENTRY(pMgntInfo, pTS, Slot)->SeqNum, SeqNum))
 		{
-			if( SN_LESS(pReorderEntry->SeqNum, ((PRX_REORDER_ENTRY)pList->Blink)->SeqNum) )
-			{
-				// Not reach correct position yet!!
-				pList = pList->Blink;
-			}
-			else if( SN_EQUAL(pReorderEntry->SeqNum, ((PRX_REORDER_ENTRY)pList->Blink)->SeqNum) )
-			{
-				// Duplicate entry is found!! Do not insert current entry.
-				RT_TRACE(COMP_RX_REORDER, DBG_WARNING, ("InsertRxReorderList(): Duplicate packet is dropped!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
-
-				RTInsertTailList(&pMgntInfo->RxReorder_Unused_List, &pReorderEntry->List);
-				return FALSE;
-			}
-			else
-			{
-				break;
-			}
+			// Duplicate entry is found!! Do not insert current entry.
+			RT_TRACE(COMP_RX_REORDER, DBG_WARNING, ("InsertRxReorderList(): Duplicate packet is dropped!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
+			return FALSE;
 		}
 
-		pReorderEntry->List.Blink = pList->Blink;
-		pReorderEntry->List.Blink->Flink = &pReorderEntry->List;
-		pReorderEntry->List.Flink = pList;
-		pList->Blink = &pReorderEntry->List;
+		bIndexed = FALSE;
+	}
 
-		RT_TRACE(COMP_RX_REORDER, DBG_TRACE, ("InsertRxReorderList(): Pkt insert into buffer!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
-		return TRUE;
+	// Start from the closest indexed packet before the new one, or from the list head if there is none.
+	while(RxReorderFindPrevSlot(pTS, &Pos, &Remaining))
+	{
+		pReorderEntry = RX_REORDER_SLOT_ENTRY(pMgntInfo, pTS, Pos);
+
+		if(SN_LESS(pReorderEntry->SeqNum, SeqNum))
+		{
+			pList = &pReorderEntry->List;
+			break;
+		}
 	}
-	else
+
+	// Skip the packets which are not in the index.
+	pList = pList->Flink;
+	while(pList != &pTS->RxPendingPktList && SN_LESS(((PRX_REORDER_ENTRY)pList)->SeqNum, SeqNum))
+		pList = pList->Flink;
+
+	if(pList != &pTS->RxPendingPktList && SN_EQUAL(((PRX_REORDER_ENTRY)pList)->SeqNum, SeqNum))
 	{
-		// This part shall be modified!! We can just indicate all the packets in buffer and get reorder entries.
-		RT_TRACE(COMP_RX_REORDER, DBG_WARNING, ("InsertRxReorderList(): There is no reorder entry!! Packet is dropped!!\n"));
+		// Duplicate entry is found!! Do not insert current entry.
+		RT_TRACE(COMP_RX_REORDER, DBG_WARNING, ("InsertRxReorderList(): Duplicate packet is dropped!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
 		return FALSE;
 	}
+
+	// Make a reorder entry and insert it in front of pList.
+	pReorderEntry = (PRX_REORDER_ENTRY)RTRemoveHeadList(&pMgntInfo->RxReorder_Unused_List);
+	pReorderEntry->SeqNum = SeqNum;
+	pReorderEntry->pRfd = pRfd;
+
+	pReorderEntry->List.Blink = pList->Blink;
+	pReorderEntry->List.Blink->Flink = &pReorderEntry->List;
+	pReorderEntry->List.Flink = pList;
+	pList->Blink = &pReorderEntry->List;
+
+	if(bIndexed)
+	{
+		pTS->RxReorderSlot[Slot] = (u2Byte)(pReorderEntry - pMgntInfo->RxReorderEntry);
+		pTS->RxReorderBitmap[Slot >> 5] |= ((u4Byte)1 << (Slot & 31));
+	}
+
+	RT_TRACE(COMP_RX_REORDER, DBG_TRACE, ("InsertRxReorderList(): Pkt insert into buffer!! IndicateSeq: %d, NewSeq: %d\n", pTS->RxIndicateSeq, SeqNum));
+	return TRUE;
 }
 
 VOID
@@ -144,6 +266,7 @@ IndicateRxReorderList(
 				}
 			
 				pReorderEntry = (PRX_REORDER_ENTRY)RTRemoveHeadList(&pTS->RxPendingPktList);
+				RxReorderUnindexEntry(pMgntInfo, pTS, pReorderEntry);
 
 				if(SN_EQUAL(pReorderEntry->SeqNum, pTS->RxIndicateSeq))
 					pTS->RxIndicateSeq = (pTS->RxIndicateSeq + 1) % 4096;
@@ -325,6 +448,7 @@ FlushRxTsPendingPkts(
 		RfdCnt = RfdCnt + 1;
 		RTInsertTailList(&pMgntInfo->RxReorder_Unused_List, &pRxReorderEntry->List);
 	}
+	RxReorderResetIndex(pTS);
 	DrvIFIndicatePackets(Adapter, RfdArray, RfdCnt);
 
 	ReturnGenTempBuffer(Adapter, pGenBuf);
@@ -25,6 +25,11 @@ IndicateRxReorderList(
 	IN	BOOLEAN					bForced
 	);
 
+VOID
+RxReorderResetIndex(
+	IN	PRX_TS_RECORD			pTS
+	);
+
 VOID
 FlushRxTsPendingPkts(
 	IN	PADAPTER 				Adapter,
@@ -2978,9 +2978,6 @@ SecSWAESEncryption(
 		FragBufferIndexStart = BufferIndex;
 		SecBufLen = 0;
 
-		//2004/09/14, kcwu, clear the Security Coalesce Buffer
-		PlatformZeroMemory(pSec->SecBuffer, SW_ENCRYPT_BUF_SIZE);
-		
 		//2004/09/14, kcwu, to show how many buffers are there used by this fragment
 		FragBufferCount = pTcb->FragBufCount[FragIndex];
 
@@ -3027,6 +3024,12 @@ SecSWAESEncryption(
 			continue;
 		}
 
+		// The payload overwrites SecBuffer up to SecBufLen, only clear what follows it
+		// instead of the whole Security Coalesce Buffer for every fragment.
+		PlatformZeroMemory(
+			pSec->SecBuffer + SecBufLen,
+			MIN(SW_ENCRYPT_AES_TAIL_SIZE, SW_ENCRYPT_BUF_SIZE - SecBufLen));
+
 #ifdef SW_TXENCRYPTION_DBG
 		RT_TRACE(COMP_SEC, DBG_LOUD, ("\n\nKeyIndex = %d\n", SecGetTxKeyIdx(Adapter, pTcb->DestinationAddress)));
 		PRINT_DATA("AESKeyBuf===>", pSec->AESKeyBuf[SecGetTxKeyIdx(Adapter, pTcb->DestinationAddress)], 16);
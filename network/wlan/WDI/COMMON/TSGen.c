@@ -51,6 +51,7 @@ ResetRxTsEntry(
 	ResetTsCommonInfo(&pTS->TsCommonInfo);
 	pTS->RxIndicateSeq = 0xffff; // This indicate the RxIndicateSeq is not used now!!
 	pTS->RxIndicateState = 0; // Reset indicate state!!
+	RxReorderResetIndex(pTS);
 	ResetBaEntry(&pTS->RxAdmittedBARecord);	  // For BA Recepient
 
 	//Init it for avoid drop first packet. 
@@ -456,6 +457,7 @@ RemoveTsEntry(
 			ReturnRFDList(Adapter, pRxReorderEntry->pRfd);
 			RTInsertTailList(&pMgntInfo->RxReorder_Unused_List, &pRxReorderEntry->List);
 		}
+		RxReorderResetIndex(pRxTS);
 
 		if(!bInRxProgress)
 			PlatformReleaseSpinLock(Adapter, RT_RX_SPINLOCK);
@@ -17,6 +17,12 @@
 //		protect related resource and the function exported here by their 
 //		own means.
 //
+//		3. Keys are placed in an open addressed slot array with linear 
+//		probing. Each slot keeps a 32-bit digest of its key, so a probe 
+//		only touches the value object when the digests match. The slot 
+//		array has at least twice as many slots as value objects, so it is 
+//		never more than half full.
+//
 //	070606, by rcnjko.
 //-----------------------------------------------------------------------------
 
@@ -28,6 +34,7 @@
 //
 //	Description:
 //		Return a index in [0,Capacity-1] from given key.
+//		Kept for compatibility; slots are picked from the key digest.
 //
 typedef unsigned int
 (*RT_HT_HASH_FUNC)(
@@ -40,7 +47,6 @@ typedef unsigned int
 //
 typedef struct _RT_HASH_ENTRY{
 	RT_LIST_ENTRY			BusyLink; // For list of all value objects in the hash table. 
-	RT_LIST_ENTRY			BucketLink; // For list of value objects in the same bucket.
 	RT_SINGLE_LIST_ENTRY	FreeLink; // For list of free objects in the hash table.
 	RT_HASH_KEY				Key; // Key associated.
 }RT_HASH_ENTRY, *PRT_HASH_ENTRY;
@@ -55,8 +61,15 @@ typedef struct _RT_HASH_ENTRY{
 // to pointer to the RT_HASH_ENTRY object.
 //
 #define RT_HASH_ENTRY_FROM_BUSY_LINK(__pBusyLink) (PRT_HASH_ENTRY)(__pBusyLink)
-#define RT_HASH_ENTRY_FROM_BUCKET_LINK(__pBucketLink) (PRT_HASH_ENTRY)( (pu1Byte)(__pBucketLink) - sizeof(RT_LIST_ENTRY) )
-#define RT_HASH_ENTRY_FROM_FREE_LINK(__pFreeLink) (PRT_HASH_ENTRY)( (pu1Byte)(__pFreeLink) - (sizeof(RT_LIST_ENTRY)*2) )
+#define RT_HASH_ENTRY_FROM_FREE_LINK(__pFreeLink) (PRT_HASH_ENTRY)( (pu1Byte)(__pFreeLink) - sizeof(RT_LIST_ENTRY) )
+
+//
+// Definition of a slot of the hash table.
+//
+typedef struct _RT_HASH_SLOT{
+	PRT_HASH_ENTRY			pEntry; // Value object in this slot, NULL if the slot is empty.
+	unsigned int			Digest; // Digest of the key of pEntry, also selects its home slot.
+}RT_HASH_SLOT, *PRT_HASH_SLOT;
 
 //
 // Definition of the hash table.
@@ -76,9 +89,10 @@ typedef struct _RT_HASH_TABLE {
 	// Hash table stuff.
 	//
 	RT_HT_HASH_FUNC		pfHash; // Hash function. 
-	RT_LIST_ENTRY		BusyValuesList; // List of all value object put in Buckets[].
-	unsigned int 		Capacity; // Number of Buckets[] allocated.
-	RT_LIST_ENTRY 		Buckets[1]; // Each entry accommodates value objects of the same hash result. 
+	RT_LIST_ENTRY		BusyValuesList; // List of all value object put in Slots[].
+	unsigned int 		Capacity; // Capacity asked for in RtAllocateHashTable().
+	unsigned int		NumSlots; // Number of Slots[] allocated, a power of 2.
+	RT_HASH_SLOT 		Slots[1]; // Open addressed slots, probed linearly from Digest % NumSlots.
 }*RT_HASH_TABLE_HANDLE;
 
 
@@ -46,6 +46,8 @@
 #define		MAX_CCKM_IE_LEN				512
 
 #define		SW_ENCRYPT_BUF_SIZE			2400
+// Bytes after the payload in SecBuffer which the AES-CCM encoder may touch: the MIC and the padding of the last block.
+#define		SW_ENCRYPT_AES_TAIL_SIZE	(8 + 16)
 
 static u1Byte WPA_OUI[SIZE_OUI] = {0x00, 0x50, 0xf2};
 static u1Byte RSN_OUI[SIZE_OUI] = {0x00, 0x0F, 0xAC};
@@ -8,6 +8,10 @@
 #define TOTAL_TS_NUM		64
 #define TCLAS_NUM			4
 
+// Rx reorder index, must cover the largest BlockAck window (256 for 802.11ax).
+#define RX_REORDER_RING_SIZE	256
+#define RX_REORDER_RING_MASK	(RX_REORDER_RING_SIZE - 1)
+
 // This define the Tx/Rx directions
 typedef enum _TR_SELECT {
 	TX_DIR = 0, 
@@ -41,6 +45,10 @@ typedef struct _RX_TS_RECORD {
 	u2Byte				RxIndicateSeq;
 	u1Byte				RxIndicateState;
 	RT_LIST_ENTRY		RxPendingPktList;
+	// Index of RxPendingPktList by SeqNum % RX_REORDER_RING_SIZE. A set bit means the slot holds the
+	// position of a pending entry in MgntInfo.RxReorderEntry[].
+	u4Byte				RxReorderBitmap[RX_REORDER_RING_SIZE/32];
+	u2Byte				RxReorderSlot[RX_REORDER_RING_SIZE];
 	RT_TIMER			RxPktPendingTimer;
 	BA_RECORD			RxAdmittedBARecord;	 // For BA Recepient
 	u2Byte				RxLastSeqNum;
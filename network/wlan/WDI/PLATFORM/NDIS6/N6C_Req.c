@@ -6217,6 +6217,7 @@ N6CSetInformationHandleCustomized11nOids(
 							}*/ // temp mark if pass DTM
 							DrvIFIndicatePacket(pAdapter, pRxReorderEntry->pRfd);
 						}
+						RxReorderResetIndex(pRxTS);
 						pRxTS = (PRX_TS_RECORD)RTNextEntryList(&pRxTS->TsCommonInfo.List);
 					}
 
@@ -104,10 +104,104 @@ TiffStreamBitmapHandler::TiffStreamBitmapHandler(
     const IPrintWriteStream_t         &pStream
     ) : m_pWICFactory(pWICFactory),
         m_pWriter(pStream),
+        m_maxPendingBands(2),
         m_nextTiffStart(0),
         m_numTiffs(0),
         m_tiffStarts(0)
 {
+    //
+    // Encode up to one band per processor while the next band is being
+    // rasterized. Every pending band holds a full band bitmap, so cap the
+    // number to keep the memory use of the filter bounded.
+    //
+    SYSTEM_INFO systemInfo;
+    ::GetSystemInfo(&systemInfo);
+
+    m_maxPendingBands = max(m_maxPendingBands, 
+                            min(static_cast<size_t>(systemInfo.dwNumberOfProcessors), 
+                                static_cast<size_t>(ms_maxPendingBands)));
+}
+
+//
+//Routine Name:
+//
+//    TiffStreamBitmapHandler::~TiffStreamBitmapHandler
+//
+//Routine Description:
+//
+//    Wait for and discard any bands that were not written, e.g.
+//    because the job was cancelled.
+//
+//Arguments:
+//
+//    None
+//
+TiffStreamBitmapHandler::~TiffStreamBitmapHandler()
+{
+    while (!m_pendingBands.empty())
+    {
+        delete m_pendingBands.front();
+        m_pendingBands.pop_front();
+    }
+}
+
+//
+//Routine Name:
+//
+//    TiffStreamBitmapHandler::BandEncode::BandEncode
+//
+//Routine Description:
+//
+//    Prepare a band for encoding on the thread pool. The work
+//    is created here but not yet submitted.
+//
+//Arguments:
+//
+//    pWICFactory - Windows Imaging Components object factory
+//    bitmap      - bitmap of a single band
+//
+TiffStreamBitmapHandler::BandEncode::BandEncode(
+    const IWICImagingFactory_t  &pWICFactory,
+    const IWICBitmap_t          &bitmap
+    ) : m_pWICFactory(pWICFactory),
+        m_bitmap(bitmap),
+        m_cb(0),
+        m_hr(E_PENDING),
+        m_pWork(NULL)
+{
+    m_pWork = ::CreateThreadpoolWork(
+                    TiffStreamBitmapHandler::EncodeBandCallback,
+                    this,
+                    NULL // default thread pool
+                    );
+
+    if (m_pWork == NULL)
+    {
+        THROW_LAST_ERROR();
+    }
+}
+
+//
+//Routine Name:
+//
+//    TiffStreamBitmapHandler::BandEncode::~BandEncode
+//
+//Routine Description:
+//
+//    Wait for the encode callback, if it was submitted, and
+//    release the thread pool work.
+//
+//Arguments:
+//
+//    None
+//
+TiffStreamBitmapHandler::BandEncode::~BandEncode()
+{
+    if (m_pWork)
+    {
+        ::WaitForThreadpoolWorkCallbacks(m_pWork, FALSE);
+        ::CloseThreadpoolWork(m_pWork);
+    }
 }
 
 //
@@ -117,7 +211,11 @@ TiffStreamBitmapHandler::TiffStreamBitmapHandler(
 //
 //Routine Description:
 //
-//    Encode the bitmap as a TIFF and stream out of the filter.
+//    Queue the bitmap to be encoded as a TIFF on the thread pool, so
+//    that the next band can be rasterized in the meantime. Encoded
+//    bands are streamed out of the filter in the order they were
+//    queued, by this method once too many bands are pending, and by
+//    FlushBitmaps.
 //
 //Arguments:
 //
@@ -128,13 +226,131 @@ TiffStreamBitmapHandler::ProcessBitmap(
     const IWICBitmap_t &bitmap
     )
 {
+    while (m_pendingBands.size() >= m_maxPendingBands)
+    {
+        WriteOldestBand();
+    }
+
+    std::auto_ptr<BandEncode> pBand(
+                                new BandEncode(
+                                        m_pWICFactory,
+                                        bitmap
+                                        )
+                                );
+
+    m_pendingBands.push_back(pBand.get());
+
+    ::SubmitThreadpoolWork(pBand.release()->m_pWork);
+}
+
+//
+//Routine Name:
+//
+//    TiffStreamBitmapHandler::FlushBitmaps
+//
+//Routine Description:
+//
+//    Wait for all the queued bands to be encoded and
+//    stream them out of the filter.
+//
+//Arguments:
+//
+//    None
+//
+void
+TiffStreamBitmapHandler::FlushBitmaps()
+{
+    while (!m_pendingBands.empty())
+    {
+        WriteOldestBand();
+    }
+}
+
+//
+//Routine Name:
+//
+//    TiffStreamBitmapHandler::EncodeBandCallback
+//
+//Routine Description:
+//
+//    Thread pool callback that encodes a single band. Failures
+//    are recorded in the band and reported when it is written.
+//
+//Arguments:
+//
+//    pInstance   - callback instance (unused)
+//    pContext    - the BandEncode to process
+//    pWork       - thread pool work (unused)
+//
+VOID
+CALLBACK
+TiffStreamBitmapHandler::EncodeBandCallback(
+    PTP_CALLBACK_INSTANCE   pInstance,
+    PVOID                   pContext,
+    PTP_WORK                pWork
+    )
+{
+    UNREFERENCED_PARAMETER(pInstance);
+    UNREFERENCED_PARAMETER(pWork);
+
+    BandEncode *pBand = static_cast<BandEncode *>(pContext);
+    HRESULT hr = S_OK;
+
+    try
+    {
+        //
+        // WIC encoders are created through COM on this thread
+        //
+        SafeCoInit  coInit;
+
+        EncodeBitmap(
+            pBand->m_pWICFactory,
+            pBand->m_bitmap,
+            pBand->m_pHG,
+            &pBand->m_cb
+            );
+
+        //
+        // Release the band bitmap as soon as it has been encoded
+        //
+        pBand->m_bitmap.Release();
+    }
+    CATCH_VARIOUS(hr);
+
+    pBand->m_hr = hr;
+}
+
+//
+//Routine Name:
+//
+//    TiffStreamBitmapHandler::EncodeBitmap
+//
+//Routine Description:
+//
+//    Encode the bitmap as a TIFF into an in-memory HGLOBAL.
+//
+//Arguments:
+//
+//    pWICFactory - Windows Imaging Components object factory
+//    bitmap      - bitmap of a single band, to encode
+//    pHG         - receives the HGLOBAL holding the TIFF
+//    pcb         - receives the size of the TIFF in bytes
+//
+void
+TiffStreamBitmapHandler::EncodeBitmap(
+    const IWICImagingFactory_t  &pWICFactory,
+    const IWICBitmap_t          &bitmap,
+    SafeHGlobal_t               &pHG,
+    ULONG                       *pcb
+    )
+{
 
     //
     // Create an empty HGLOBAL to hold the encode cache
     //
-    SafeHGlobal_t pHG(
-                    new SafeHGlobal(GMEM_SHARE | GMEM_MOVEABLE, 0)
-                    );
+    pHG.reset(
+            new SafeHGlobal(GMEM_SHARE | GMEM_MOVEABLE, 0)
+            );
 
     //
     // Create a stream to the encode buffer so that WIC can
@@ -155,7 +371,7 @@ TiffStreamBitmapHandler::ProcessBitmap(
     //
     IWICBitmapEncoder_t pWICEncoder;
     THROW_ON_FAILED_HRESULT(
-        m_pWICFactory->CreateEncoder(GUID_ContainerFormatTiff, NULL, &pWICEncoder)
+        pWICFactory->CreateEncoder(GUID_ContainerFormatTiff, NULL, &pWICEncoder)
         );
     THROW_ON_FAILED_HRESULT(
         pWICEncoder->Initialize(pIStream, WICBitmapEncoderNoCache)
@@ -260,25 +476,48 @@ TiffStreamBitmapHandler::ProcessBitmap(
         pIStream->Seek(zero, SEEK_CUR, &tiffSize)
         );
 
-    ULONG cb;
-    
     THROW_ON_FAILED_HRESULT(
-        ::ULongLongToULong(tiffSize.QuadPart, &cb)
+        ::ULongLongToULong(tiffSize.QuadPart, pcb)
         );
+}
+
+//
+//Routine Name:
+//
+//    TiffStreamBitmapHandler::WriteOldestBand
+//
+//Routine Description:
+//
+//    Wait for the oldest queued band to be encoded and
+//    stream it out of the filter.
+//
+//Arguments:
+//
+//    None
+//
+void
+TiffStreamBitmapHandler::WriteOldestBand()
+{
+    std::auto_ptr<BandEncode> pBand(m_pendingBands.front());
+    m_pendingBands.pop_front();
+
+    ::WaitForThreadpoolWorkCallbacks(pBand->m_pWork, FALSE);
+
+    THROW_ON_FAILED_HRESULT(pBand->m_hr);
 
     //
     // Update the list of Tiff locations so that it can be written to
     // the end of the Tiff stream.
     //
     m_tiffStarts.push_back(m_nextTiffStart);
-    m_nextTiffStart += tiffSize.QuadPart;
+    m_nextTiffStart += pBand->m_cb;
     m_numTiffs++;
 
     {
         //
         // Get a pointer to the HGLOBAL memory
         //
-        HGlobalLock_t lock = pHG->Lock();
+        HGlobalLock_t lock = pBand->m_pHG->Lock();
         BYTE *pCache = lock->GetAddress();
 
         //
@@ -287,7 +526,7 @@ TiffStreamBitmapHandler::ProcessBitmap(
         ULONG written;
 
         THROW_ON_FAILED_HRESULT(
-            m_pWriter->WriteBytes(pCache, cb, &written)
+            m_pWriter->WriteBytes(pCache, pBand->m_cb, &written)
             );
     }
 }
@@ -322,6 +561,11 @@ TiffStreamBitmapHandler::WriteFooter()
 {
     ULONG written;
 
+    //
+    // All the bands must be in the stream before their locations
+    //
+    FlushBitmaps();
+
     //
     // Write the vector of Tiff starts to the stream, if any Tiffs
     // have been written to the stream.
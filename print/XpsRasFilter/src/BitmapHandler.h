@@ -31,18 +31,80 @@ public:
         const IPrintWriteStream_t &pStream
         );
 
+    ~TiffStreamBitmapHandler();
+
     void
     ProcessBitmap(
         const IWICBitmap_t &bitmap
         );
 
+    void
+    FlushBitmaps();
+
     void
     WriteFooter();
 
 private:
+
+    //
+    // A band that has been handed to the thread pool for encoding.
+    // The destructor waits for the encode to finish.
+    //
+    class BandEncode
+    {
+    public:
+        BandEncode(
+            const IWICImagingFactory_t  &pWICFactory,
+            const IWICBitmap_t          &bitmap
+            );
+
+        ~BandEncode();
+
+        IWICImagingFactory_t    m_pWICFactory;
+        IWICBitmap_t            m_bitmap;
+        SafeHGlobal_t           m_pHG;          // encoded Tiff
+        ULONG                   m_cb;           // size of the encoded Tiff
+        HRESULT                 m_hr;           // result of the encode
+        PTP_WORK                m_pWork;
+
+    private:
+        BandEncode(BandEncode const&);
+        BandEncode& operator=(BandEncode const&);
+    };
+
+    static
+    VOID
+    CALLBACK
+    EncodeBandCallback(
+        PTP_CALLBACK_INSTANCE   pInstance,
+        PVOID                   pContext,
+        PTP_WORK                pWork
+        );
+
+    static
+    void
+    EncodeBitmap(
+        const IWICImagingFactory_t  &pWICFactory,
+        const IWICBitmap_t          &bitmap,
+        SafeHGlobal_t               &pHG,
+        ULONG                       *pcb
+        );
+
+    void
+    WriteOldestBand();
+
     IWICImagingFactory_t    m_pWICFactory;
     IPrintWriteStream_t     m_pWriter;        // output stream
 
+    //
+    // Bands being encoded, in output order, and how many of
+    // them may be held in memory at once
+    //
+    std::deque<BandEncode *> m_pendingBands;
+    size_t                  m_maxPendingBands;
+
+    const static size_t     ms_maxPendingBands = 4;
+
     //
     // Members to keep track of where each Tiff
     // starts in the output stream
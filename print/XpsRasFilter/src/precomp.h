@@ -40,6 +40,7 @@ __user_driver
 
 // STL
 #include <vector>
+#include <deque>
 
 //
 // COM includes
@@ -268,7 +268,8 @@ RasterizationInterface::RasterizePage(
             );
 
         //
-        // Encode the raster data as TIFF and stream out
+        // Encode the raster data as TIFF and stream out. The encode runs
+        // on the thread pool while the next band is rasterized.
         //
         m_pBitmapHandler->ProcessBitmap(bitmap);
     }
@@ -557,6 +557,30 @@ EvtIoRead(
 }
 
 
+NTSTATUS
+QueueWriteRun(
+    _In_  PQUEUE_CONTEXT    QueueContext,
+    _In_  PUCHAR            RunStart,
+    _In_  PUCHAR            RunEnd
+    )
+/*++
+Routine Description:
+
+    Places the characters in [RunStart, RunEnd) in the read buffer with a
+    single ring buffer write.
+
+--*/
+{
+    if (RunEnd == RunStart) {
+        return STATUS_SUCCESS;
+    }
+
+    return RingBufferWrite(&QueueContext->RingBuffer,
+                            RunStart,
+                            RunEnd - RunStart);
+}
+
+
 NTSTATUS
 QueueProcessWriteBytes(
     _In_  PQUEUE_CONTEXT    QueueContext,
@@ -587,25 +611,32 @@ Arguments:
 {
     NTSTATUS                status = STATUS_SUCCESS;
     UCHAR                   currentCharacter;
+    PUCHAR                  runStart = Characters;
     UCHAR                   connectString[]  = "\r\nCONNECT\r\n";
     UCHAR                   connectStringCch = ARRAY_SIZE(connectString) - 1;
     UCHAR                   okString[]       = "\r\nOK\r\n";
     UCHAR                   okStringCch      = ARRAY_SIZE(okString) - 1;
 
+    //
+    // The characters are echoed into the read buffer in runs rather than one
+    // at a time. A run ends at a NUL, which is dropped, and at a CR that
+    // completes a command, so that the response still follows it.
+    //
     while (Length != 0) {
 
         currentCharacter = *(Characters++);
         Length--;
 
         if(currentCharacter == '\0') {
-            continue;
-        }
+            status = QueueWriteRun(QueueContext,
+                            runStart,
+                            Characters - 1);
+            if( !NT_SUCCESS(status) ) {
+                return status;
+            }
 
-        status = RingBufferWrite(&QueueContext->RingBuffer,
-                            &currentCharacter,
-                            sizeof(currentCharacter));
-        if( !NT_SUCCESS(status) ) {
-            return status;
+            runStart = Characters;
+            continue;
         }
 
         switch (QueueContext->CommandMatchState) {
@@ -660,6 +691,15 @@ Arguments:
                 //
                 QueueContext->CommandMatchState = COMMAND_MATCH_STATE_IDLE;
 
+                status = QueueWriteRun(QueueContext,
+                            runStart,
+                            Characters);
+                if( !NT_SUCCESS(status) ) {
+                    return status;
+                }
+
+                runStart = Characters;
+
                 if (QueueContext->ConnectCommand) {
                     //
                     //  place <cr><lf>CONNECT<cr><lf>  in the buffer
@@ -694,7 +734,10 @@ Arguments:
             break;
         }
     }
-    return status;
+
+    return QueueWriteRun(QueueContext,
+                            runStart,
+                            Characters);
 }
 
 
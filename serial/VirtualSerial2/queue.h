@@ -85,6 +85,13 @@ QueueProcessWriteBytes(
     _In_  size_t            Length
     );
 
+NTSTATUS
+QueueWriteRun(
+    _In_  PQUEUE_CONTEXT    QueueContext,
+    _In_  PUCHAR            RunStart,
+    _In_  PUCHAR            RunEnd
+    );
+
 NTSTATUS
 QueueProcessGetLineControl(
     _In_  PQUEUE_CONTEXT    QueueContext,
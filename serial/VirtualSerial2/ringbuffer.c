@@ -142,103 +142,168 @@ RingBufferGetAvailableData(
 }
 
 
-NTSTATUS
-RingBufferWrite(
+VOID
+RingBufferGetWriteSpan(
     _In_  PRING_BUFFER      Self,
-    _In_reads_bytes_(DataSize)
-          BYTE*             Data,
-    _In_  size_t            DataSize
+    _Outptr_result_bytebuffer_(*SpanSize)
+          BYTE**            Span,
+    _Out_ size_t            *SpanSize
     )
 {
     size_t                  availableSpace;
-    size_t                  bytesToCopy;
     size_t                  spaceFromCurrToEnd;
 
-    ASSERT(Data && (0 != DataSize));
+    ASSERT(Span && SpanSize);
 
-    if (Self->Tail >= Self->End)
+    //
+    // Only the producer moves the tail, so it can be used directly. The
+    // available space is at least what we compute here, since the consumer
+    // can only make more room.
+    //
+    RingBufferGetAvailableSpace(Self, &availableSpace);
+
+    spaceFromCurrToEnd = Self->End - Self->Tail;
+
+    *Span = Self->Tail;
+    *SpanSize = (availableSpace < spaceFromCurrToEnd) ?
+                    availableSpace : spaceFromCurrToEnd;
+}
+
+
+VOID
+RingBufferCommitWrite(
+    _In_  PRING_BUFFER      Self,
+    _In_  size_t            DataSize
+    )
+{
+    BYTE*                   newTail;
+
+    ASSERT(DataSize <= (size_t)(Self->End - Self->Tail));
+
+    newTail = Self->Tail + DataSize;
+    if (newTail == Self->End)
     {
-        return STATUS_INTERNAL_ERROR;
+        //
+        // We have exactly reached the end of the buffer. The next
+        // write should wrap around and start from the beginning.
+        //
+        newTail = Self->Base;
     }
 
     //
-    // Get the amount of space available in the buffer
+    // Make sure the data written into the span is visible before the
+    // consumer can see the new tail.
     //
-    RingBufferGetAvailableSpace(Self, &availableSpace);
+    MemoryBarrier();
+
+    Self->Tail = newTail;
+}
+
+
+VOID
+RingBufferGetReadSpan(
+    _In_  PRING_BUFFER      Self,
+    _Outptr_result_bytebuffer_(*SpanSize)
+          BYTE**            Span,
+    _Out_ size_t            *SpanSize
+    )
+{
+    size_t                  availableData;
+    size_t                  dataFromCurrToEnd;
+
+    ASSERT(Span && SpanSize);
+
+    RingBufferGetAvailableData(Self, &availableData);
 
     //
-    // If there is not enough space to fit in all the data passed in by the
-    // caller then copy as much as possible and throw away the rest
+    // Pairs with the barrier in RingBufferCommitWrite, so that we do not
+    // read the data before the tail that covers it.
     //
-    if (availableSpace < DataSize)
-    {
-        bytesToCopy = availableSpace;
-    }
-    else
-    {
-        bytesToCopy = DataSize;
-    }
+    MemoryBarrier();
+
+    dataFromCurrToEnd = Self->End - Self->Head;
+
+    *Span = Self->Head;
+    *SpanSize = (availableData < dataFromCurrToEnd) ?
+                    availableData : dataFromCurrToEnd;
+}
+
 
-    if (bytesToCopy)
+VOID
+RingBufferConsume(
+    _In_  PRING_BUFFER      Self,
+    _In_  size_t            DataSize
+    )
+{
+    BYTE*                   newHead;
+
+    ASSERT(DataSize <= (size_t)(Self->End - Self->Head));
+
+    newHead = Self->Head + DataSize;
+    if (newHead == Self->End)
     {
         //
-        // The buffer has some space at least
+        // We have exactly reached the end of the buffer. The next
+        // read should wrap around and start from the beginning.
         //
-        if ((Self->Tail + bytesToCopy) > Self->End)
-        {
-            //
-            // The data being written will wrap around the end of the buffer.
-            // So the copy has to be done in two steps -
-            // * X bytes from current position to end of the buffer
-            // * the remaining (bytesToCopy - X) from the start of the buffer
-            //
+        newHead = Self->Base;
+    }
 
-            //
-            // The first step of the copy ...
-            //
-            spaceFromCurrToEnd = Self->End - Self->Tail;
+    //
+    // Finish reading the span before the producer is allowed to reuse it.
+    //
+    MemoryBarrier();
 
-            RtlCopyMemory(Self->Tail, Data, spaceFromCurrToEnd);
+    Self->Head = newHead;
+}
 
-            Data += spaceFromCurrToEnd;
 
-            bytesToCopy -= spaceFromCurrToEnd;
+NTSTATUS
+RingBufferWrite(
+    _In_  PRING_BUFFER      Self,
+    _In_reads_bytes_(DataSize)
+          BYTE*             Data,
+    _In_  size_t            DataSize
+    )
+{
+    BYTE*                   span;
+    size_t                  spanSize;
 
-            //
-            // The second step of the copy ...
-            //
-            RtlCopyMemory(Self->Base, Data, bytesToCopy);
+    ASSERT(Data && (0 != DataSize));
 
-            //
-            // Advance the tail pointer
-            //
-            Self->Tail = Self->Base + bytesToCopy;
-        }
-        else
+    if (Self->Tail >= Self->End)
+    {
+        return STATUS_INTERNAL_ERROR;
+    }
+
+    //
+    // The free space is at most two contiguous spans, one up to the end of
+    // the buffer and one from its start. If there is not enough space to
+    // fit in all the data passed in by the caller then copy as much as
+    // possible and throw away the rest.
+    //
+    while (DataSize != 0)
+    {
+        RingBufferGetWriteSpan(Self, &span, &spanSize);
+        if (spanSize == 0)
         {
-            //
-            // Data does NOT wrap around the end of the buffer. Just copy it
-            // over in a single step
-            //
-            RtlCopyMemory(Self->Tail, Data, bytesToCopy);
+            break;
+        }
 
-            //
-            // Advance the tail pointer
-            //
-            Self->Tail += bytesToCopy;
-            if (Self->Tail == Self->End)
-            {
-                //
-                // We have exactly reached the end of the buffer. The next
-                // write should wrap around and start from the beginning.
-                //
-                Self->Tail = Self->Base;
-            }
+        if (spanSize > DataSize)
+        {
+            spanSize = DataSize;
         }
 
-        ASSERT(Self->Tail < Self->End);
+        RtlCopyMemory(span, Data, spanSize);
+        RingBufferCommitWrite(Self, spanSize);
+
+        Data += spanSize;
+        DataSize -= spanSize;
     }
 
+    ASSERT(Self->Tail < Self->End);
+
     return STATUS_SUCCESS;
 }
 
@@ -252,8 +317,8 @@ RingBufferRead(
     _Out_ size_t            *BytesCopied
     )
 {
-    size_t                  availableData;
-    size_t                  dataFromCurrToEnd;
+    BYTE*                   span;
+    size_t                  spanSize;
 
     ASSERT(Data && (DataSize != 0));
 
@@ -262,77 +327,34 @@ RingBufferRead(
         return STATUS_INTERNAL_ERROR;
     }
 
+    *BytesCopied = 0;
+
     //
-    // Get the amount of data available in the buffer
+    // The data is at most two contiguous spans, one up to the end of the
+    // buffer and one from its start.
     //
-    RingBufferGetAvailableData(Self, &availableData);
-
-    if (availableData == 0)
+    while (DataSize != 0)
     {
-        *BytesCopied = 0;
-        return STATUS_SUCCESS;
-    }
-
-    if (DataSize > availableData)
-    {
-        DataSize = availableData;
-    }
-
-    *BytesCopied = DataSize;
-
-    if ((Self->Head + DataSize) > Self->End)
-    {
-        //
-        // The data requested by the caller is wrapped around the end of the
-        // buffer. So we'll do the copy in two steps -
-        //    * Copy X bytes from the current position to the end buffer into
-        //      the caller's buffer
-        //    * Copy (DataSize - X) bytes from the beginning to the buffer into
-        //      the caller's buffer
-        //
-
-        //
-        // The first step of the copy ...
-        //
-        dataFromCurrToEnd = Self->End - Self->Head;
-        RtlCopyMemory(Data, Self->Head, dataFromCurrToEnd);
-        Data += dataFromCurrToEnd;
-        DataSize -= dataFromCurrToEnd;
-
-        //
-        // The second step of the copy ...
-        //
-        RtlCopyMemory(Data, Self->Base, DataSize);
-
-        //
-        // Advance the head pointer
-        //
-        Self->Head = Self->Base + DataSize;
-    }
-    else
-    {
-        //
-        // The data in the buffer is NOT wrapped around the end of the buffer.
-        // Simply copy the data over to the caller's buffer in a single step.
-        //
-        RtlCopyMemory(Data, Self->Head, DataSize);
+        RingBufferGetReadSpan(Self, &span, &spanSize);
+        if (spanSize == 0)
+        {
+            break;
+        }
 
-        //
-        // Advance the head pointer
-        //
-        Self->Head += DataSize;
-        if (Self->Head == Self->End)
+        if (spanSize > DataSize)
         {
-            //
-            // We have exactly reached the end of the buffer. The next
-            // read should wrap around and start from the beginning.
-            //
-            Self->Head = Self->Base;
+            spanSize = DataSize;
         }
+
+        RtlCopyMemory(Data, span, spanSize);
+        RingBufferConsume(Self, spanSize);
+
+        Data += spanSize;
+        DataSize -= spanSize;
+        *BytesCopied += spanSize;
     }
 
     ASSERT(Self->Head < Self->End);
 
     return STATUS_SUCCESS;
 }
-
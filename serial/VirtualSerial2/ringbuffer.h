@@ -104,6 +104,43 @@ RingBufferRead(
     _Out_ size_t            *BytesCopied
     );
 
+//
+// Span based access. A span is a contiguous part of the ring buffer which
+// the caller fills or drains in place, and then commits or consumes. The
+// free space or the data can be split in two at the end of the buffer, so
+// the caller should loop until the returned span is empty.
+//
+// As with RingBufferWrite and RingBufferRead, there must be a single
+// producer and a single consumer.
+//
+VOID
+RingBufferGetWriteSpan(
+    _In_  PRING_BUFFER      Self,
+    _Outptr_result_bytebuffer_(*SpanSize)
+          BYTE**            Span,
+    _Out_ size_t            *SpanSize
+    );
+
+VOID
+RingBufferCommitWrite(
+    _In_  PRING_BUFFER      Self,
+    _In_  size_t            DataSize
+    );
+
+VOID
+RingBufferGetReadSpan(
+    _In_  PRING_BUFFER      Self,
+    _Outptr_result_bytebuffer_(*SpanSize)
+          BYTE**            Span,
+    _Out_ size_t            *SpanSize
+    );
+
+VOID
+RingBufferConsume(
+    _In_  PRING_BUFFER      Self,
+    _In_  size_t            DataSize
+    );
+
 VOID
 RingBufferGetAvailableSpace(
     _In_  PRING_BUFFER      Self,
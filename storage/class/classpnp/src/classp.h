@@ -626,6 +626,13 @@ typedef struct _TRANSFER_PACKET {
 #define MAX_OUTSTANDING_IO_PER_LUN_DEFAULT                  16
 #define MAX_CLEANUP_TRANSFER_PACKETS_AT_ONCE                8192
 
+//
+// The per-node working set target decays towards the observed demand by
+// 1/2^WORKINGSET_TARGET_DECAY_SHIFT each time the node drains, and grows
+// immediately when demand exceeds it.
+//
+#define WORKINGSET_TARGET_DECAY_SHIFT                       4
+
 
 
 typedef struct _PNL_SLIST_HEADER {
@@ -633,6 +640,18 @@ typedef struct _PNL_SLIST_HEADER {
     DECLSPEC_CACHEALIGN ULONG NumFreeTransferPackets;
     ULONG NumTotalTransferPackets;
     ULONG DbgPeakNumTransferPackets;
+
+    //
+    // Adaptive working set for this node. WorkingSetTarget replaces
+    // LocalMinWorkingSetTransferPackets as the lazy trim floor and moves
+    // between the local minimum and maximum according to the in-flight
+    // depth and on-demand allocations observed since the last retune.
+    //
+    ULONG WorkingSetTarget;
+    ULONG PeakInUseTransferPackets;
+    ULONG StressAllocations;
+    ULONG AllocationFailures;
+    ULONG CrossNodeSteals;
 } PNL_SLIST_HEADER, *PPNL_SLIST_HEADER;
 
 //
@@ -1219,6 +1238,20 @@ __inline BOOLEAN SimpleIsSlistEmpty(SINGLE_LIST_ENTRY *SListHdr)
     return (SListHdr->Next == NULL);
 }
 
+/*
+ *  Number of a node's transfer packets that are currently in flight.
+ *  The counters are updated without a lock, so take a single snapshot of
+ *  each and report 0 rather than wrapping when the free count momentarily
+ *  runs ahead of the total.
+ */
+__inline ULONG ClasspGetInUseTransferPackets(PPNL_SLIST_HEADER FreeList)
+{
+    ULONG numTotal = *((volatile ULONG *)&FreeList->NumTotalTransferPackets);
+    ULONG numFree = *((volatile ULONG *)&FreeList->NumFreeTransferPackets);
+
+    return (numFree < numTotal) ? (numTotal - numFree) : 0;
+}
+
 __inline
 BOOLEAN
 ClasspIsIdleRequestSupported(
@@ -1716,6 +1749,7 @@ VOID DestroyAllTransferPackets(PDEVICE_OBJECT Fdo);
 VOID InterpretCapacityData(PDEVICE_OBJECT Fdo, PREAD_CAPACITY_DATA_EX ReadCapacityData);
 IO_WORKITEM_ROUTINE_EX CleanupTransferPacketToWorkingSetSizeWorker;
 VOID CleanupTransferPacketToWorkingSetSize(_In_ PDEVICE_OBJECT Fdo, _In_ BOOLEAN LimitNumPktToDelete, _In_ ULONG Node);
+VOID RetuneTransferPacketWorkingSet(_In_ PCLASS_PRIVATE_FDO_DATA FdoData, _In_ ULONG Node);
 
 _IRQL_requires_max_(APC_LEVEL)
 _IRQL_requires_min_(PASSIVE_LEVEL)
@@ -3037,6 +3037,132 @@ Exit:
 }
 
 
+VOID
+ClasspSiftDownDataSetRange(
+    _Inout_updates_(Count) PDEVICE_DATA_SET_RANGE DataSetRanges,
+    _In_ ULONG Root,
+    _In_ ULONG Count
+    )
+/*++
+
+Routine Description:
+
+    Moves DataSetRanges[Root] down the heap until it is not smaller than its
+    children.  The heap is ordered by StartingOffset, largest at the root.
+
+--*/
+{
+    DEVICE_DATA_SET_RANGE temp;
+    ULONG child;
+
+    while ((child = Root * 2 + 1) < Count) {
+
+        if ((child + 1 < Count) &&
+            (DataSetRanges[child + 1].StartingOffset > DataSetRanges[child].StartingOffset)) {
+            child++;
+        }
+
+        if (DataSetRanges[Root].StartingOffset >= DataSetRanges[child].StartingOffset) {
+            break;
+        }
+
+        temp = DataSetRanges[Root];
+        DataSetRanges[Root] = DataSetRanges[child];
+        DataSetRanges[child] = temp;
+
+        Root = child;
+    }
+}
+
+
+ULONG
+ClasspCoalesceDataSetRanges(
+    _Inout_updates_(DataSetRangesCount) PDEVICE_DATA_SET_RANGE DataSetRanges,
+    _In_ ULONG DataSetRangesCount
+    )
+/*++
+
+Routine Description:
+
+    Sorts the given DEVICE_DATA_SET_RANGE entries by starting offset and
+    merges the ones that overlap or are adjacent.
+
+    A file system frees clusters in the order they were released, so a TRIM
+    request often carries many small ranges that are next to each other on
+    the disk.  Merging them first means fewer UNMAP block descriptors and
+    fewer UNMAP commands.
+
+Arguments:
+    All arguments must be validated by the caller.
+
+    DataSetRanges - The ranges to coalesce.  They are sorted and merged in
+        place.
+    DataSetRangesCount - The number of ranges.
+
+Return Value:
+
+    Count of DEVICE_DATA_SET_RANGE entries after merging.
+
+--*/
+{
+    DEVICE_DATA_SET_RANGE temp;
+    ULONGLONG currentEnd;
+    ULONGLONG nextEnd;
+    ULONG mergedCount;
+    ULONG i;
+
+    if (DataSetRangesCount < 2) {
+        return DataSetRangesCount;
+    }
+
+    //
+    // Heap sort by starting offset.  It needs no extra memory and is
+    // O(n log n) whatever order the ranges come in.
+    //
+    for (i = DataSetRangesCount / 2; i > 0; i--) {
+        ClasspSiftDownDataSetRange(DataSetRanges, i - 1, DataSetRangesCount);
+    }
+
+    for (i = DataSetRangesCount - 1; i > 0; i--) {
+        temp = DataSetRanges[0];
+        DataSetRanges[0] = DataSetRanges[i];
+        DataSetRanges[i] = temp;
+
+        ClasspSiftDownDataSetRange(DataSetRanges, 0, i);
+    }
+
+    //
+    // Merge in one pass.  The ranges are block-aligned and within the
+    // partition, so the ends can't overflow.
+    //
+    mergedCount = 0;
+    currentEnd = (ULONGLONG)DataSetRanges[0].StartingOffset + DataSetRanges[0].LengthInBytes;
+
+    for (i = 1; i < DataSetRangesCount; i++) {
+
+        nextEnd = (ULONGLONG)DataSetRanges[i].StartingOffset + DataSetRanges[i].LengthInBytes;
+
+        if ((ULONGLONG)DataSetRanges[i].StartingOffset <= currentEnd) {
+
+            currentEnd = max(currentEnd, nextEnd);
+
+        } else {
+
+            DataSetRanges[mergedCount].LengthInBytes = currentEnd - (ULONGLONG)DataSetRanges[mergedCount].StartingOffset;
+            mergedCount++;
+
+            DataSetRanges[mergedCount].StartingOffset = DataSetRanges[i].StartingOffset;
+            currentEnd = nextEnd;
+        }
+    }
+
+    DataSetRanges[mergedCount].LengthInBytes = currentEnd - (ULONGLONG)DataSetRanges[mergedCount].StartingOffset;
+    mergedCount++;
+
+    return mergedCount;
+}
+
+
 VOID
 ConvertDataSetRangeToUnmapBlockDescr(
     _In_    PFUNCTIONAL_DEVICE_EXTENSION FdoExtension,
@@ -3208,10 +3334,39 @@ Return Value:
     ULONGLONG               maxLbaCount;
     ULONGLONG               maxParameterListLength;
 
+    PDEVICE_DATA_SET_RANGE  coalescedDataSetRanges = NULL;
+
 
     UNREFERENCED_PARAMETER(UnmapGranularity);    
     UNREFERENCED_PARAMETER(ActivityId);
     UNREFERENCED_PARAMETER(Irp);
+
+    //
+    // Sort and merge a copy of the ranges, so that adjacent ranges go down as
+    // one block descriptor.  If we can't get the memory, just send the ranges
+    // as they are.
+    //
+    if (DataSetRangesCount > 1) {
+        coalescedDataSetRanges = (PDEVICE_DATA_SET_RANGE)
+                                 ExAllocatePoolZero(NonPagedPoolNx,
+                                                    DataSetRangesCount * sizeof(DEVICE_DATA_SET_RANGE),
+                                                    CLASS_TAG_LB_PROVISIONING);
+
+        if (coalescedDataSetRanges != NULL) {
+            RtlCopyMemory(coalescedDataSetRanges,
+                          DataSetRanges,
+                          DataSetRangesCount * sizeof(DEVICE_DATA_SET_RANGE));
+
+            TracePrint((TRACE_LEVEL_INFORMATION,
+                        TRACE_FLAG_IOCTL,
+                        "DeviceProcessDsmTrimRequest (%p): Coalescing %u DataSetRanges.\n",
+                        FdoExtension->DeviceObject,
+                        DataSetRangesCount));
+
+            DataSetRangesCount = ClasspCoalesceDataSetRanges(coalescedDataSetRanges, DataSetRangesCount);
+            DataSetRanges = coalescedDataSetRanges;
+        }
+    }
     
     //
     // The given LBA ranges are in DEVICE_DATA_SET_RANGE format and need to be converted into UNMAP Block Descriptors.
@@ -3467,6 +3622,7 @@ Return Value:
 Exit:
 
     FREE_POOL(buffer);
+    FREE_POOL(coalescedDataSetRanges);
 
     return status;
 }
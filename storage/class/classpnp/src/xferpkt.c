@@ -204,6 +204,7 @@ NTSTATUS InitializeTransferPackets(PDEVICE_OBJECT Fdo)
     } // end working set size special code
 
     for (index = 0; index < arraySize; index++) {
+        fdoData->FreeTransferPacketsLists[index].WorkingSetTarget = fdoData->LocalMinWorkingSetTransferPackets;
         while (fdoData->FreeTransferPacketsLists[index].NumFreeTransferPackets < MIN_INITIAL_TRANSFER_PACKETS){
             PTRANSFER_PACKET pkt = NewTransferPacket(Fdo);
             if (pkt) {
@@ -607,10 +608,15 @@ VOID EnqueueFreeTransferPacket(PDEVICE_OBJECT Fdo, __drv_aliasesMem PTRANSFER_PA
         }
 
         /*
-         *  2.  Lazily work down to our LOWER threshold (by only freeing one packet at a time).
+         *  2.  Lazily work down to this node's working set target (by only freeing one
+         *      packet at a time).  The target is retuned from the demand seen since the
+         *      node last drained, so a node under bursty load keeps the packets it keeps
+         *      needing instead of freeing and reallocating them on every burst.
          */
+        RetuneTransferPacketWorkingSet(fdoData, allocateNode);
+
         if (fdoData->FreeTransferPacketsLists[allocateNode].NumTotalTransferPackets >
-            fdoData->LocalMinWorkingSetTransferPackets){
+            fdoData->FreeTransferPacketsLists[allocateNode].WorkingSetTarget){
             /*
              *  Check the counter again with lock held.  This eliminates a race condition
              *  while still allowing us to not grab the spinlock in the common codepath.
@@ -624,14 +630,14 @@ VOID EnqueueFreeTransferPacket(PDEVICE_OBJECT Fdo, __drv_aliasesMem PTRANSFER_PA
 
             TracePrint((TRACE_LEVEL_INFORMATION, TRACE_FLAG_RW, "Exiting stress, lazily freeing one of %d/%d packets from node %d.",
                 fdoData->FreeTransferPacketsLists[allocateNode].NumTotalTransferPackets,
-                fdoData->LocalMinWorkingSetTransferPackets,
+                fdoData->FreeTransferPacketsLists[allocateNode].WorkingSetTarget,
                 allocateNode));
 
             KeAcquireSpinLock(&fdoData->SpinLock, &oldIrql);
             if ((fdoData->FreeTransferPacketsLists[allocateNode].NumFreeTransferPackets >=
                 fdoData->FreeTransferPacketsLists[allocateNode].NumTotalTransferPackets) &&
                 (fdoData->FreeTransferPacketsLists[allocateNode].NumTotalTransferPackets >
-                fdoData->LocalMinWorkingSetTransferPackets)){
+                fdoData->FreeTransferPacketsLists[allocateNode].WorkingSetTarget)){
 
                 pktToDelete = DequeueFreeTransferPacketEx(Fdo, FALSE, allocateNode);
                 if (pktToDelete) {
@@ -639,7 +645,7 @@ VOID EnqueueFreeTransferPacket(PDEVICE_OBJECT Fdo, __drv_aliasesMem PTRANSFER_PA
                 } else {
                     TracePrint((TRACE_LEVEL_INFORMATION, TRACE_FLAG_RW,
                         "Extremely unlikely condition (non-fatal): %d packets dequeued at once for Fdo %p. NumTotalTransferPackets=%d (2). Node=%d",
-                        fdoData->LocalMinWorkingSetTransferPackets,
+                        fdoData->FreeTransferPacketsLists[allocateNode].WorkingSetTarget,
                         Fdo,
                         fdoData->FreeTransferPacketsLists[allocateNode].NumTotalTransferPackets,
                         allocateNode));
@@ -668,8 +674,10 @@ PTRANSFER_PACKET DequeueFreeTransferPacketEx(
 {
     PFUNCTIONAL_DEVICE_EXTENSION fdoExt = Fdo->DeviceExtension;
     PCLASS_PRIVATE_FDO_DATA fdoData = fdoExt->PrivateFdoData;
+    PPNL_SLIST_HEADER freeList = &fdoData->FreeTransferPacketsLists[Node];
     PTRANSFER_PACKET pkt;
     PSLIST_ENTRY slistEntry;
+    ULONG numInUse;
 
     slistEntry = InterlockedPopEntrySList(&(fdoData->FreeTransferPacketsLists[Node].SListHeader));
 
@@ -678,6 +686,15 @@ PTRANSFER_PACKET DequeueFreeTransferPacketEx(
         pkt = CONTAINING_RECORD(slistEntry, TRANSFER_PACKET, SlistEntry);
         InterlockedDecrement((volatile LONG *)&(fdoData->FreeTransferPacketsLists[Node].NumFreeTransferPackets));
 
+        /*
+         *  Track the in-flight depth for the working set controller.
+         *  The counters are sampled without a lock; an occasional stale
+         *  value only nudges the target, which is clamped anyway.
+         */
+        numInUse = ClasspGetInUseTransferPackets(freeList);
+        freeList->PeakInUseTransferPackets =
+            max(freeList->PeakInUseTransferPackets, numInUse);
+
         // when dequeuing the packet, also reset the history data
         HISTORYINITIALIZERETRYLOGS(pkt);
 
@@ -692,11 +709,36 @@ PTRANSFER_PACKET DequeueFreeTransferPacketEx(
             pkt = NewTransferPacket(Fdo);
             if (pkt) {
                 InterlockedIncrement((volatile LONG *)&fdoData->FreeTransferPacketsLists[Node].NumTotalTransferPackets);
+                InterlockedIncrement((volatile LONG *)&freeList->StressAllocations);
                 fdoData->FreeTransferPacketsLists[Node].DbgPeakNumTransferPackets =
                     max(fdoData->FreeTransferPacketsLists[Node].DbgPeakNumTransferPackets,
                         fdoData->FreeTransferPacketsLists[Node].NumTotalTransferPackets);
+                numInUse = ClasspGetInUseTransferPackets(freeList);
+                freeList->PeakInUseTransferPackets =
+                    max(freeList->PeakInUseTransferPackets, numInUse);
             } else {
+                ULONG numNodes = KeQueryHighestNodeNumber() + 1;
+                ULONG i;
+
                 TracePrint((TRACE_LEVEL_WARNING, TRACE_FLAG_RW, "DequeueFreeTransferPacket: packet allocation failed"));
+                InterlockedIncrement((volatile LONG *)&freeList->AllocationFailures);
+
+                /*
+                 *  Rather than fail the transfer, borrow a free packet from
+                 *  another node.  It goes back to its own node's list when
+                 *  it completes, since the list is chosen by AllocateNode.
+                 */
+                for (i = 1; i < numNodes; i++) {
+                    pkt = DequeueFreeTransferPacketEx(Fdo, FALSE, (Node + i) % numNodes);
+                    if (pkt) {
+                        InterlockedIncrement((volatile LONG *)&freeList->CrossNodeSteals);
+                        TracePrint((TRACE_LEVEL_INFORMATION, TRACE_FLAG_RW,
+                                    "DequeueFreeTransferPacket: borrowed packet from node %d for node %d",
+                                    pkt->AllocateNode,
+                                    Node));
+                        break;
+                    }
+                }
             }
         } else {
             pkt = NULL;
@@ -1602,6 +1644,61 @@ CleanupTransferPacketToWorkingSetSizeWorker(
 }
 
 
+VOID
+RetuneTransferPacketWorkingSet(
+    _In_ PCLASS_PRIVATE_FDO_DATA FdoData,
+    _In_ ULONG Node
+    )
+
+/*
+Routine Description:
+
+    This function recomputes the working set target of one node's free
+    transfer packet list from the demand observed since the last retune.
+    It is called when all of the node's packets are back on the free list.
+
+    Demand is the peak number of packets in flight.  If the node had to
+    allocate packets on demand, or failed to, the peak understated what the
+    device wanted, so half again is added as headroom.  The target follows
+    demand up immediately and decays towards it slowly, and always stays
+    within [LocalMinWorkingSetTransferPackets, LocalMaxWorkingSetTransferPackets].
+
+Arguments:
+    FdoData: The private FDO data holding the free packet lists.
+    Node: NUMA node whose working set is retuned.
+
+--*/
+
+{
+    PPNL_SLIST_HEADER freeList = &FdoData->FreeTransferPacketsLists[Node];
+    ULONG demand;
+    ULONG stressAllocations;
+    ULONG allocationFailures;
+    ULONG target;
+
+    demand = InterlockedExchange((volatile LONG *)&freeList->PeakInUseTransferPackets, 0);
+    stressAllocations = InterlockedExchange((volatile LONG *)&freeList->StressAllocations, 0);
+    allocationFailures = InterlockedExchange((volatile LONG *)&freeList->AllocationFailures, 0);
+
+    if ((stressAllocations != 0) || (allocationFailures != 0)) {
+        demand += demand / 2;
+    }
+
+    target = freeList->WorkingSetTarget;
+
+    if (demand >= target) {
+        target = demand;
+    } else {
+        target -= MAX((target - demand) >> WORKINGSET_TARGET_DECAY_SHIFT, 1);
+    }
+
+    target = MAX(target, FdoData->LocalMinWorkingSetTransferPackets);
+    target = MIN(target, FdoData->LocalMaxWorkingSetTransferPackets);
+
+    freeList->WorkingSetTarget = target;
+}
+
+
 VOID
 CleanupTransferPacketToWorkingSetSize(
     _In_ PDEVICE_OBJECT Fdo,
@@ -2871,6 +2871,155 @@ AtaPassThroughRequest (
     return STOR_STATUS_SUCCESS;
 }
 
+VOID
+__inline
+SiftDownUnmapBlockDescr(
+    _Inout_updates_(Count) PUNMAP_BLOCK_DESCRIPTOR BlockDescr,
+    _In_ ULONG  Root,
+    _In_ ULONG  Count
+    )
+/*
+    Move BlockDescr[Root] down the heap until it is not smaller than its children.
+    The heap is ordered by StartingLba, largest at the root.
+*/
+{
+    UNMAP_BLOCK_DESCRIPTOR  temp;
+    ULONGLONG               parentLba;
+    ULONGLONG               childLba;
+    ULONGLONG               siblingLba;
+    ULONG                   child;
+
+    while ((child = Root * 2 + 1) < Count) {
+
+        REVERSE_BYTES_QUAD(&childLba, BlockDescr[child].StartingLba);
+
+        if (child + 1 < Count) {
+            REVERSE_BYTES_QUAD(&siblingLba, BlockDescr[child + 1].StartingLba);
+
+            if (siblingLba > childLba) {
+                child++;
+                childLba = siblingLba;
+            }
+        }
+
+        REVERSE_BYTES_QUAD(&parentLba, BlockDescr[Root].StartingLba);
+
+        if (parentLba >= childLba) {
+            break;
+        }
+
+        StorPortCopyMemory(&temp, &BlockDescr[Root], sizeof(UNMAP_BLOCK_DESCRIPTOR));
+        StorPortCopyMemory(&BlockDescr[Root], &BlockDescr[child], sizeof(UNMAP_BLOCK_DESCRIPTOR));
+        StorPortCopyMemory(&BlockDescr[child], &temp, sizeof(UNMAP_BLOCK_DESCRIPTOR));
+
+        Root = child;
+    }
+}
+
+ULONG
+CoalesceUnmapBlockDescriptors(
+    _Inout_updates_(Count) PUNMAP_BLOCK_DESCRIPTOR BlockDescr,
+    _In_ ULONG  Count
+    )
+/*++
+
+Routine Description:
+
+    Sort UNMAP_BLOCK_DESCRIPTOR entries by StartingLba and merge the ones that overlap or are adjacent,
+    dropping entries with zero LbaCount.
+
+    File systems free space in whatever order it was released, so an UNMAP request often has many
+    small entries that are next to each other on the disk. After merging them, fewer ATA_LBA_RANGE entries
+    are needed and the request goes down in fewer DSM commands.
+
+    A merged entry is limited to 0xFFFFFFFF blocks, as LbaCount is 32 bits.
+
+Arguments:
+
+    BlockDescr - the UNMAP_BLOCK_DESCRIPTOR entries, sorted and merged in place
+    Count - count of entries
+
+Return Value:
+
+    Count of UNMAP_BLOCK_DESCRIPTOR entries after merging.
+
+--*/
+{
+    UNMAP_BLOCK_DESCRIPTOR  temp;
+    ULONGLONG               currentLba = 0;
+    ULONGLONG               currentEnd = 0;
+    ULONGLONG               nextLba;
+    ULONGLONG               nextEnd;
+    ULONG                   lbaCount;
+    ULONG                   mergedCount = 0;
+    ULONG                   i;
+
+    if (Count == 0) {
+        return 0;
+    }
+
+    // 1. heap sort the entries by StartingLba, it needs no extra memory and is O(n log n) for any input.
+    for (i = Count / 2; i > 0; i--) {
+        SiftDownUnmapBlockDescr(BlockDescr, i - 1, Count);
+    }
+
+    for (i = Count - 1; i > 0; i--) {
+        StorPortCopyMemory(&temp, &BlockDescr[0], sizeof(UNMAP_BLOCK_DESCRIPTOR));
+        StorPortCopyMemory(&BlockDescr[0], &BlockDescr[i], sizeof(UNMAP_BLOCK_DESCRIPTOR));
+        StorPortCopyMemory(&BlockDescr[i], &temp, sizeof(UNMAP_BLOCK_DESCRIPTOR));
+
+        SiftDownUnmapBlockDescr(BlockDescr, 0, i);
+    }
+
+    // 2. merge entries in one pass. [currentLba, currentEnd) is the entry being built.
+    for (i = 0; i < Count; i++) {
+
+        REVERSE_BYTES_QUAD(&nextLba, BlockDescr[i].StartingLba);
+        REVERSE_BYTES(&lbaCount, BlockDescr[i].LbaCount);
+
+        if (lbaCount == 0) {
+            continue;
+        }
+
+        nextEnd = nextLba + lbaCount;
+
+        if ((currentEnd > currentLba) && (nextLba <= currentEnd)) {
+            // 2.1 overlapping or adjacent, extend the current entry.
+            if (nextEnd <= currentEnd) {
+                continue;
+            }
+
+            if (nextEnd - currentLba <= MAXULONG) {
+                currentEnd = nextEnd;
+                continue;
+            }
+
+            // 2.2 the merged entry would be too long, start a new one where the current one ends.
+            nextLba = currentEnd;
+        }
+
+        // 2.3 write out the current entry and start a new one.
+        if (currentEnd > currentLba) {
+            lbaCount = (ULONG)(currentEnd - currentLba);
+            REVERSE_BYTES_QUAD(BlockDescr[mergedCount].StartingLba, &currentLba);
+            REVERSE_BYTES(BlockDescr[mergedCount].LbaCount, &lbaCount);
+            mergedCount++;
+        }
+
+        currentLba = nextLba;
+        currentEnd = nextEnd;
+    }
+
+    if (currentEnd > currentLba) {
+        lbaCount = (ULONG)(currentEnd - currentLba);
+        REVERSE_BYTES_QUAD(BlockDescr[mergedCount].StartingLba, &currentLba);
+        REVERSE_BYTES(BlockDescr[mergedCount].LbaCount, &lbaCount);
+        mergedCount++;
+    }
+
+    return mergedCount;
+}
+
 ULONG
 ConvertUnmapBlockDescrToAtaLbaRanges(
     _Inout_ PUNMAP_BLOCK_DESCRIPTOR BlockDescr,
@@ -3139,8 +3288,13 @@ AtaUnmapRequest (
     } else {
         // some preparation work before actually starting to process the request
         ULONG                 i = 0;
+        ULONG                 blockDescrCount = blockDescrDataLength / sizeof(UNMAP_BLOCK_DESCRIPTOR);
 
-        status = StorPortAllocatePool(ChannelExtension->AdapterExtension, sizeof(ATA_TRIM_CONTEXT), AHCI_POOL_TAG, (PVOID*)&trimContext);
+        // the context is followed by a copy of the Block Descriptors, so that they can be coalesced without touching the caller's buffer.
+        status = StorPortAllocatePool(ChannelExtension->AdapterExtension,
+                                      sizeof(ATA_TRIM_CONTEXT) + blockDescrCount * sizeof(UNMAP_BLOCK_DESCRIPTOR),
+                                      AHCI_POOL_TAG,
+                                      (PVOID*)&trimContext);
         if ( (status != STOR_STATUS_SUCCESS) || (trimContext == NULL) ) {
             Srb->SrbStatus = SRB_STATUS_INVALID_REQUEST;
             if (status == STOR_STATUS_SUCCESS) {
@@ -3150,8 +3304,11 @@ AtaUnmapRequest (
         }
         AhciZeroMemory((PCHAR)trimContext, sizeof(ATA_TRIM_CONTEXT));
 
-        trimContext->BlockDescriptors = (PUNMAP_BLOCK_DESCRIPTOR)((PCHAR)srbDataBuffer + 8);
-        trimContext->BlockDescrCount = blockDescrDataLength / sizeof(UNMAP_BLOCK_DESCRIPTOR);
+        trimContext->BlockDescriptors = (PUNMAP_BLOCK_DESCRIPTOR)(trimContext + 1);
+        StorPortCopyMemory(trimContext->BlockDescriptors, (PCHAR)srbDataBuffer + 8, blockDescrCount * sizeof(UNMAP_BLOCK_DESCRIPTOR));
+
+        // sort the Block Descriptors and merge the adjacent ones, so that they are packed into as few DSM commands as possible.
+        trimContext->BlockDescrCount = CoalesceUnmapBlockDescriptors(trimContext->BlockDescriptors, blockDescrCount);
 
         // 1.1 calculate how many ATA Lba entries can be sent per DSM command
         //     every device LBA entry takes 8 bytes. not worry about multiply overflow as max of DsmCapBlockCount is 0xFFFF
@@ -246,7 +246,8 @@ typedef struct _ATA_LBA_RANGE {
 } ATA_LBA_RANGE, *PATA_LBA_RANGE;
 
 typedef struct _ATA_TRIM_CONTEXT {
-    // Block Descriptor for UNMAP request
+    // Block Descriptor for UNMAP request, sorted and coalesced.
+    // points to the copy that follows this structure in the same allocation.
     PUNMAP_BLOCK_DESCRIPTOR BlockDescriptors;
 
     // Block Descriptor count for UNMAP request
@@ -37,19 +37,25 @@ Called by:
     Activate Queue
 
 It performs:
+    1 Count free device queue entries
+    2 Split the target slots at the last active slot
+    3 Take slots circularly starting at the last active slot, whole masks at a time when they fit
 
 Affected Variables/Registers:
     none
 
 Return Value:
+    Bit mask of the slots to activate
 --*/
 {
     UCHAR activeCount = 0;
     UCHAR emptyCount;
-    UCHAR requestCount;
     UCHAR lastActiveSlot;
+    ULONG slotsInRange;
+    ULONG upperSlots;
+    ULONG lowerSlots;
     ULONG slotToActivate = 0;
-    UCHAR i;
+    ULONG slot;
 
     // 1. Device's queue depth is smaller than Controller's
 
@@ -66,39 +72,50 @@ Return Value:
         return 0;
     }
 
-    // 2. Look for any entry from last active slot
-    requestCount = NumberOfSetBits(TargetSlots);
-    lastActiveSlot = ChannelExtension->LastActiveSlot;
     emptyCount = ChannelExtension->DeviceExtension[0].DeviceParameters.MaxDeviceQueueDepth - activeCount;
 
-    // 3.1 Look for any entry from last active slot
-    for (i = lastActiveSlot; i <= ChannelExtension->AdapterExtension->CAP.NCS; i++) {
-        if ((TargetSlots & (1 << i)) > 0) {
-            slotToActivate |= (1 << i);
-            emptyCount--;
-            requestCount--;
-            if (emptyCount == 0 || requestCount == 0) {
-                ChannelExtension->LastActiveSlot = i;
-                return slotToActivate;
-            }
-        }
+    // 2. Split the requests at the last active slot.
+    //    Upper: slots from last active slot to NCS. Lower: slots 1 up to the last active slot.
+    //    Slot 0 is reserved for internal command, it is only picked up when the scan starts there.
+    lastActiveSlot = ChannelExtension->LastActiveSlot;
+
+    if (ChannelExtension->AdapterExtension->CAP.NCS >= 31) {
+        slotsInRange = TargetSlots;
+    } else {
+        slotsInRange = TargetSlots & ((1 << (ChannelExtension->AdapterExtension->CAP.NCS + 1)) - 1);
     }
 
-    // 3.2 Look for any entry from beginning to last active slot
-    // Slot 0 is reserved for internal command
-    for (i = 1 ; i <= lastActiveSlot; i++) {
-        if ((TargetSlots & (1 << i)) > 0) {
-            slotToActivate |= (1 << i);
-            emptyCount--;
-            requestCount--;
-            if (emptyCount == 0 || requestCount == 0) {
-                ChannelExtension->LastActiveSlot = i;
-                return slotToActivate;
-            }
+    upperSlots = slotsInRange & ~(((ULONG)1 << lastActiveSlot) - 1);
+    lowerSlots = slotsInRange & ~upperSlots & ~1;
+
+    if ((upperSlots | lowerSlots) == 0) {
+        NT_ASSERT(FALSE);
+        return 0;
+    }
+
+    // 3.1 If everything fits, take it all at once.
+    //     The last active slot becomes the highest slot taken in circular order.
+    if (NumberOfSetBits(upperSlots | lowerSlots) <= emptyCount) {
+        _BitScanReverse(&slot, (lowerSlots != 0) ? lowerSlots : upperSlots);
+        ChannelExtension->LastActiveSlot = (UCHAR)slot;
+        return upperSlots | lowerSlots;
+    }
+
+    // 3.2 Otherwise take the lowest slots circularly, one bit scan per slot, until the device queue is full.
+    while (emptyCount > 0) {
+        if (upperSlots != 0) {
+            _BitScanForward(&slot, upperSlots);
+            upperSlots &= upperSlots - 1;
+        } else {
+            _BitScanForward(&slot, lowerSlots);
+            lowerSlots &= lowerSlots - 1;
         }
+        slotToActivate |= (1 << slot);
+        emptyCount--;
     }
 
-    NT_ASSERT(FALSE);
+    ChannelExtension->LastActiveSlot = (UCHAR)slot;
+
     return slotToActivate;
 }
 
@@ -134,29 +151,31 @@ Return Value:
 --*/
 {
     UCHAR limit;
-    UCHAR i;
+    ULONG slices;
+    ULONG slot;
 
     PAHCI_ADAPTER_EXTENSION adapterExtension = ChannelExtension->AdapterExtension;
 
     // 1.1 Initialize variables
     limit = ChannelExtension->CurrentCommandSlot;
+    slices = ChannelExtension->SlotManager.SingleIoSlice;
 
     // if there is internal request pending, always get it first.
-    if ((ChannelExtension->SlotManager.SingleIoSlice & 1) > 0) {
+    if ((slices & 1) > 0) {
         return 0;
     }
 
+    if (adapterExtension->CAP.NCS < 31) {
+        slices &= (1 << (adapterExtension->CAP.NCS + 1)) - 1;
+    }
+
     // 2.1 Chose the slot circularly starting with CCS
-    for (i = limit; i <= adapterExtension->CAP.NCS; i++) {
-        if ((ChannelExtension->SlotManager.SingleIoSlice & (1 << i)) > 0) {
-            return i;
-        }
+    if (_BitScanForward(&slot, slices & ~(((ULONG)1 << limit) - 1))) {
+        return (UCHAR)slot;
     }
 
-    for (i = 0; i < limit; i++) {
-        if ((ChannelExtension->SlotManager.SingleIoSlice & (1 << i)) > 0) {
-            return i;
-        }
+    if (_BitScanForward(&slot, slices & (((ULONG)1 << limit) - 1))) {
+        return (UCHAR)slot;
     }
 
     return 0xff;
@@ -472,21 +491,20 @@ Return Values:
         if (adapterExtension->TracingEnabled) {
             LARGE_INTEGER perfCounter = {0};
             ULONG pendingProgrammingCommands = slotsToActivate;
-
-            i = 0;
+            ULONG slot;
 
             StorPortQueryPerformanceCounter((PVOID)adapterExtension, NULL, &perfCounter);
 
-            while (pendingProgrammingCommands) {
+            // Visit only the slots being programmed
+            while (_BitScanForward(&slot, pendingProgrammingCommands)) {
                 // TODO: there is potential race condition that causes slot flags mismatch and Srb is NULL here.
-                if ((pendingProgrammingCommands & 1) && (ChannelExtension->Slot[i].Srb != NULL)) {
-                    PAHCI_SRB_EXTENSION srbExtension = GetSrbExtension(ChannelExtension->Slot[i].Srb);
+                if (ChannelExtension->Slot[slot].Srb != NULL) {
+                    PAHCI_SRB_EXTENSION srbExtension = GetSrbExtension(ChannelExtension->Slot[slot].Srb);
                     srbExtension->StartTime = perfCounter.QuadPart;
 
                 }
 
-                i++;
-                pendingProgrammingCommands >>= 1;
+                pendingProgrammingCommands &= pendingProgrammingCommands - 1;
             }
         }
 
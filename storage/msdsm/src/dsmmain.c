@@ -3302,6 +3302,77 @@ DsmpDecrementCounters(
 }
 
 
+VOID
+DsmpUpdateServiceTime(
+    _In_ PDSM_FAILOVER_GROUP FailGroup,
+    _In_ PIO_STACK_LOCATION IrpStack
+    )
+/*++
+
+Routine Description:
+
+    This routine folds the service time of a completed request into the
+    moving average kept for the path that serviced it.
+
+    The issue time is saved in Argument4 by DsmSetCompletion. Only the low
+    bits fit in a pointer on 32-bit systems, which is fine since the unsigned
+    difference is still correct for any request that takes less than ~7 min.
+
+Arguments:
+
+    FailGroup - The path that serviced the request.
+    IrpStack - The stack location in which the issue time was saved.
+
+Return Value:
+
+    None
+
+--*/
+{
+    ULONG_PTR issueTime = (ULONG_PTR)IrpStack->Parameters.Others.Argument4;
+    LONGLONG now;
+    LONGLONG lastUpdate;
+    LONGLONG sample;
+    LONGLONG average;
+
+    if (issueTime == 0) {
+
+        return;
+    }
+
+    now = (LONGLONG)KeQueryInterruptTime();
+    sample = (LONGLONG)((ULONG_PTR)now - issueTime);
+
+    //
+    // The average is a hint for path selection, so an occasional lost update
+    // from a concurrent completion on the same path is harmless.
+    //
+    average = InterlockedCompareExchange64(&FailGroup->AverageServiceTime, 0, 0);
+    lastUpdate = InterlockedCompareExchange64(&FailGroup->LastServiceTimeUpdate, 0, 0);
+
+    //
+    // A stale average says little about the path as it is now, so let the
+    // new sample replace it rather than slowly pulling it along.
+    //
+    if (average == 0 || now - lastUpdate > DSM_SERVICE_TIME_STALE_INTERVAL) {
+
+        average = sample;
+
+    } else {
+
+        average += (sample - average) >> DSM_SERVICE_TIME_WEIGHT_SHIFT;
+    }
+
+    //
+    // Never let a path look free, otherwise it would attract all the IO.
+    //
+    InterlockedExchange64(&FailGroup->AverageServiceTime, max(average, 1));
+    InterlockedExchange64(&FailGroup->LastServiceTimeUpdate, now);
+
+    return;
+}
+
+
 PDSM_FAILOVER_GROUP
 DsmpGetPath(
     _In_ IN PDSM_CONTEXT DsmContext,
@@ -3660,7 +3731,8 @@ Return Value:
             break;
         }
 
-        case DSM_LB_LEAST_BLOCKS: {
+        case DSM_LB_LEAST_BLOCKS:
+        case DSM_LB_LEAST_SERVICE_TIME: {
 
             ULONG bytes = 0;
             PCDB cdb = NULL;
@@ -3669,6 +3741,11 @@ Return Value:
             BOOLEAN isWrite = FALSE;
             PDSM_FAILOVER_GROUP lastPathUsed = groupEntry->PathToBeUsed;
             ULONGLONG leastOutstandingIO = MAXULONGLONG;
+            ULONGLONG leastServiceTime = MAXULONGLONG;
+            ULONGLONG serviceTime = 0;
+            ULONGLONG minAverageServiceTime = MAXULONGLONG;
+            ULONGLONG averageServiceTime = 0;
+            LONGLONG now = 0;
             ULONGLONG startLba = 0;
 
             //
@@ -3741,6 +3818,89 @@ Return Value:
                 failGroup = groupEntry->PathToBeUsed;
             }
 
+            if (!failGroup && groupEntry->LoadBalanceType == DSM_LB_LEAST_SERVICE_TIME) {
+
+                now = (LONGLONG)KeQueryInterruptTime();
+
+                //
+                // Find the smallest fresh average among the Active/Optimized
+                // paths. It stands in for the average of any path that has
+                // not completed anything yet, or whose average has gone stale.
+                //
+                for (inx = 0; inx < DsmList->Count; inx++) {
+
+                    deviceInfo = DsmList->IdList[inx];
+
+                    if (!(deviceInfo && DsmpIsDeviceInitialized(deviceInfo) && DsmpIsDeviceUsable(deviceInfo) && DsmpIsDeviceUsablePR(deviceInfo))) {
+
+                        continue;
+                    }
+
+                    if (deviceInfo->State != DSM_DEV_ACTIVE_OPTIMIZED) {
+
+                        continue;
+                    }
+
+                    averageServiceTime = (ULONGLONG)deviceInfo->FailGroup->AverageServiceTime;
+
+                    if (averageServiceTime != 0 &&
+                        now - deviceInfo->FailGroup->LastServiceTimeUpdate <= DSM_SERVICE_TIME_STALE_INTERVAL &&
+                        averageServiceTime < minAverageServiceTime) {
+
+                        minAverageServiceTime = averageServiceTime;
+                    }
+                }
+
+                if (minAverageServiceTime == MAXULONGLONG) {
+
+                    minAverageServiceTime = 1;
+                }
+
+                //
+                // Choose whichever Active/Optimized path is expected to complete
+                // this request first, i.e. the one with the least queued work
+                // weighed by how long it takes to service a request. An
+                // unmeasured or stale path is costed at the smallest fresh
+                // average, so it still pays for its queue depth but gets
+                // probed again once its queue is no deeper than the others'.
+                // Ties go to the path with the least outstanding bytes.
+                //
+                for (inx = 0; inx < DsmList->Count; inx++) {
+
+                    deviceInfo = DsmList->IdList[inx];
+
+                    if (!(deviceInfo && DsmpIsDeviceInitialized(deviceInfo) && DsmpIsDeviceUsable(deviceInfo) && DsmpIsDeviceUsablePR(deviceInfo))) {
+
+                        continue;
+                    }
+
+                    if (deviceInfo->State != DSM_DEV_ACTIVE_OPTIMIZED) {
+
+                        continue;
+                    }
+
+                    averageServiceTime = (ULONGLONG)deviceInfo->FailGroup->AverageServiceTime;
+
+                    if (averageServiceTime == 0 ||
+                        now - deviceInfo->FailGroup->LastServiceTimeUpdate > DSM_SERVICE_TIME_STALE_INTERVAL) {
+
+                        averageServiceTime = minAverageServiceTime;
+                    }
+
+                    serviceTime = (ULONGLONG)(deviceInfo->FailGroup->NumberOfRequestsInFlight + 1) *
+                                  averageServiceTime;
+
+                    if (serviceTime < leastServiceTime ||
+                        (serviceTime == leastServiceTime &&
+                         deviceInfo->FailGroup->OutstandingBytesOfIO < leastOutstandingIO)) {
+
+                        leastServiceTime = serviceTime;
+                        leastOutstandingIO = deviceInfo->FailGroup->OutstandingBytesOfIO;
+                        failGroup = deviceInfo->FailGroup;
+                    }
+                }
+            }
+
             if (!failGroup) {
 
                 //
@@ -4432,6 +4592,8 @@ Return Value:
 
     if (failGroup) {
 
+        DsmpUpdateServiceTime(failGroup, irpStack);
+
         if (DsmpDecrementCounters(failGroup, Srb)) {
 
             //
@@ -5088,6 +5250,7 @@ Return Value:
     switch (Group->LoadBalanceType) {
 
         case DSM_LB_LEAST_BLOCKS:
+        case DSM_LB_LEAST_SERVICE_TIME:
         case DSM_LB_DYN_LEAST_QUEUE_DEPTH: {
 
             //
@@ -6169,6 +6332,7 @@ Return Value:
         }
 
         case DSM_LB_LEAST_BLOCKS:
+        case DSM_LB_LEAST_SERVICE_TIME:
         case DSM_LB_ROUND_ROBIN:
         case DSM_LB_DYN_LEAST_QUEUE_DEPTH:
         case DSM_LB_WEIGHTED_PATHS: {
@@ -6594,6 +6758,7 @@ Return Value:
         }
 
         case DSM_LB_LEAST_BLOCKS:
+        case DSM_LB_LEAST_SERVICE_TIME:
         case DSM_LB_ROUND_ROBIN:
         case DSM_LB_WEIGHTED_PATHS:
         case DSM_LB_DYN_LEAST_QUEUE_DEPTH: {
@@ -6734,7 +6899,7 @@ Return Value:
     }
 
     if (group->LoadBalanceType < DSM_LB_FAILOVER ||
-        group->LoadBalanceType > DSM_LB_LEAST_BLOCKS) {
+        group->LoadBalanceType > DSM_LB_LEAST_SERVICE_TIME) {
 
         status = STATUS_INVALID_PARAMETER;
 
@@ -6999,7 +7164,7 @@ Return Value:
     group = FailingDeviceInfo->Group;
 
     if (group->LoadBalanceType < DSM_LB_FAILOVER ||
-        group->LoadBalanceType > DSM_LB_LEAST_BLOCKS) {
+        group->LoadBalanceType > DSM_LB_LEAST_SERVICE_TIME) {
 
         status = STATUS_INVALID_PARAMETER;
 
@@ -7378,7 +7543,7 @@ Return Value:
 
 
     if (group->LoadBalanceType < DSM_LB_FAILOVER ||
-        group->LoadBalanceType > DSM_LB_LEAST_BLOCKS) {
+        group->LoadBalanceType > DSM_LB_LEAST_SERVICE_TIME) {
 
         status = STATUS_INVALID_PARAMETER;
 
@@ -3771,6 +3771,7 @@ Return Value:
                 }
 
                 irpStack->Parameters.Others.Argument3 = failGroup;
+                irpStack->Parameters.Others.Argument4 = (PVOID)(ULONG_PTR)KeQueryInterruptTime();
 
                 DsmpIncrementCounters(failGroup, Srb);
             }
@@ -4165,9 +4166,11 @@ Return Value:
                 DsmId));
 
     //
-    // Save off the path that was selected to service this request in Argument3.
+    // Save off the path that was selected to service this request in Argument3
+    // and the time it was issued in Argument4, for the LST load balance policy.
     //
     irpStack->Parameters.Others.Argument3 = failGroup;
+    irpStack->Parameters.Others.Argument4 = (PVOID)(ULONG_PTR)KeQueryInterruptTime();
 
     DsmpIncrementCounters(failGroup, Srb);
 
@@ -99,7 +99,13 @@ Notes:
 //
 // Number of LB Policies that are supported by this driver.
 //
-#define DSM_NUMBER_OF_LB_POLICIES 6
+#define DSM_NUMBER_OF_LB_POLICIES 7
+
+//
+// Least Service Time load balance policy. It is reported through the
+// vendor specific slot since LBPolicy.h has no value for it.
+//
+#define DSM_LB_LEAST_SERVICE_TIME DSM_LB_VENDOR_SPECIFIC
 
 //
 // Size of the buffer passed to read in Persistent Reserve keys.
@@ -112,6 +118,20 @@ Notes:
 //
 #define DSM_LEAST_BLOCKS_DEFAULT_THRESHOLD 0x00100000
 
+//
+// Weight (as a shift) given to a new sample in the per-path average service
+// time used by the Least Service Time policy, i.e. 1/8.
+//
+#define DSM_SERVICE_TIME_WEIGHT_SHIFT 3
+
+//
+// Age (in 100ns units) after which a path's average service time is no
+// longer trusted by the Least Service Time policy, i.e. 2 seconds. A path
+// whose average is this old gets probed again and its next sample replaces
+// the average outright.
+//
+#define DSM_SERVICE_TIME_STALE_INTERVAL 20000000
+
 //
 // Initialization data structure that needs to be filled in for MPIO
 //
@@ -1025,6 +1045,17 @@ typedef struct _DSM_FAILOVER_GROUP {
     //
     volatile LONG NumberOfRequestsInFlight;
 
+    //
+    // Moving average of the time (in 100ns units) it takes this path to
+    // complete a request. This will be used in LST load balance policy.
+    //
+    volatile LONGLONG AverageServiceTime;
+
+    //
+    // Interrupt time at which AverageServiceTime was last updated.
+    //
+    volatile LONGLONG LastServiceTimeUpdate;
+
     //
     // Number of devices in this FOG.
     //
@@ -500,6 +500,12 @@ DsmpDecrementCounters(
     _In_ PSCSI_REQUEST_BLOCK Srb
     );
 
+VOID
+DsmpUpdateServiceTime(
+    _In_ PDSM_FAILOVER_GROUP FailGroup,
+    _In_ PIO_STACK_LOCATION IrpStack
+    );
+
 PDSM_FAILOVER_GROUP
 DsmpGetPath(
     _In_ IN PDSM_CONTEXT DsmContext,
@@ -495,7 +495,7 @@ Return Value:
                     continue;
                 }
 
-                if (targetPolicyInfo->LoadBalancePolicy >= DSM_LB_VENDOR_SPECIFIC) {
+                if (targetPolicyInfo->LoadBalancePolicy > DSM_LB_LEAST_SERVICE_TIME) {
 
                     errorStatus = STATUS_INVALID_PARAMETER;
 
@@ -571,7 +571,7 @@ Return Value:
             //
             // First ensure that the values make sense.
             //
-            if (loadBalancePolicy >= DSM_LB_VENDOR_SPECIFIC) {
+            if (loadBalancePolicy > DSM_LB_LEAST_SERVICE_TIME) {
 
                 status = STATUS_INVALID_PARAMETER;
                 TracePrint((TRACE_LEVEL_ERROR,
@@ -1175,7 +1175,8 @@ Return Value:
             NT_ASSERT(groupEntry->LoadBalanceType != DSM_LB_ROUND_ROBIN &&
                    groupEntry->LoadBalanceType != DSM_LB_WEIGHTED_PATHS &&
                    groupEntry->LoadBalanceType != DSM_LB_DYN_LEAST_QUEUE_DEPTH &&
-                   groupEntry->LoadBalanceType != DSM_LB_LEAST_BLOCKS);
+                   groupEntry->LoadBalanceType != DSM_LB_LEAST_BLOCKS &&
+                   groupEntry->LoadBalanceType != DSM_LB_LEAST_SERVICE_TIME);
         }
 #endif
 
@@ -2034,7 +2035,8 @@ Return Value:
                     if (loadBalancePolicy == DSM_LB_ROUND_ROBIN ||
                         loadBalancePolicy == DSM_LB_WEIGHTED_PATHS ||
                         loadBalancePolicy == DSM_LB_DYN_LEAST_QUEUE_DEPTH ||
-                        loadBalancePolicy == DSM_LB_LEAST_BLOCKS) {
+                        loadBalancePolicy == DSM_LB_LEAST_BLOCKS ||
+                        loadBalancePolicy == DSM_LB_LEAST_SERVICE_TIME) {
 
                         if (devInfo->TargetPortGroup && devInfo->ALUAState != DSM_DEV_ACTIVE_UNOPTIMIZED) {
 
@@ -2077,7 +2079,8 @@ Return Value:
                 if (loadBalancePolicy == DSM_LB_ROUND_ROBIN ||
                     loadBalancePolicy == DSM_LB_WEIGHTED_PATHS ||
                     loadBalancePolicy == DSM_LB_DYN_LEAST_QUEUE_DEPTH ||
-                    loadBalancePolicy == DSM_LB_LEAST_BLOCKS) {
+                    loadBalancePolicy == DSM_LB_LEAST_BLOCKS ||
+                    loadBalancePolicy == DSM_LB_LEAST_SERVICE_TIME) {
 
                     if ((!devInfo->TargetPortGroup) ||
                         (devInfo->TargetPortGroup && devInfo->State != devInfo->ALUAState)) {
@@ -2575,7 +2578,7 @@ Return Value:
     }
 
     if ((supportedLBPolicies->LoadBalancePolicy < DSM_LB_FAILOVER) ||
-        (supportedLBPolicies->LoadBalancePolicy > DSM_LB_LEAST_BLOCKS)) {
+        (supportedLBPolicies->LoadBalancePolicy > DSM_LB_LEAST_SERVICE_TIME)) {
 
         TracePrint((TRACE_LEVEL_ERROR,
                     TRACE_FLAG_WMI,
@@ -53,6 +53,10 @@ _Analysis_mode_(_Analysis_code_type_user_code_)
 #define NOISY(_x_) printf _x_ ;
 #define MAX_LENGTH 256
 
+#define MAX_PERF_THREADS      32  // per direction, so both fit in one wait
+#define MAX_PERF_QUEUE_DEPTH  64
+#define LATENCY_BUCKETS       20  // bucket n counts latencies below 2^n us
+
 char inPipe[MAX_LENGTH] = "PIPE00";     // pipe name for bulk input pipe on our test board
 char outPipe[MAX_LENGTH] = "PIPE01";    // pipe name for bulk output pipe on our test board
 char completeDeviceName[MAX_LENGTH] = "";  //generated from the GUID registered by the driver itself
@@ -62,12 +66,28 @@ BOOL fDumpReadData = FALSE;
 BOOL fRead = FALSE;
 BOOL fWrite = FALSE;
 BOOL fCompareData = TRUE;
+BOOL fPerf = FALSE;
 
 int gDebugLevel = 1;      // higher == more verbose, default is 1, 0 turns off all
 
 ULONG IterationCount = 1; //count of iterations of the test we are to perform
 int WriteLen = 0;         // #bytes to write
 int ReadLen = 0;          // #bytes to read
+ULONG ThreadCount = 0;    // #threads per direction for the throughput test
+ULONG QueueDepth = 4;     // #requests each throughput test thread keeps pending
+
+//
+// State of one throughput test thread
+//
+typedef struct _PERF_THREAD {
+    HANDLE    Thread;
+    HANDLE    hDev;
+    BOOL      Read;
+    int       Length;
+    ULONGLONG Bytes;
+    ULONG     Errors;
+    ULONG     Histogram[LATENCY_BUCKETS];
+} PERF_THREAD, *PPERF_THREAD;
 
 // functions
 
@@ -350,7 +370,8 @@ Return Value:
 
 HANDLE
 open_file(
-    _In_ PSTR filename
+    _In_ PSTR filename,
+    _In_ DWORD flags
     )
 /*++
 Routine Description:
@@ -359,7 +380,9 @@ Routine Description:
 
 Arguments:
 
-    None
+    filename - pipe name to append to the device name
+
+    flags - flags and attributes passed to CreateFile
 
 Return Value:
 
@@ -392,7 +415,7 @@ Return Value:
             FILE_SHARE_WRITE | FILE_SHARE_READ,
             NULL,
             OPEN_EXISTING,
-            0,
+            flags,
             NULL);
 
     if (h == INVALID_HANDLE_VALUE) {
@@ -434,6 +457,9 @@ Return Value:
         printf("-o [s] where s is the output pipe\n");
         printf("-v verbose -- dumps read data\n");
         printf("-x to skip validation of read and write data\n");
+        printf("-t [n] where n is number of threads per pipe for an overlapped\n");
+        printf("       throughput test (reports MB/s and a latency histogram)\n");
+        printf("-q [n] where n is number of requests each thread keeps pending (default = 4)\n");
 
         printf("\nUsage for USB and Endpoint info:\n");
         printf("-u to dump USB configuration and pipe info \n");
@@ -545,6 +571,37 @@ Return Value:
                 fCompareData = FALSE;
                 i++;
                 break;
+            case 't':
+            case 'T':
+                if (i+1 >= argc) {
+                    usage();
+                    exit(1);
+                }
+                else {
+                    ThreadCount = atoi(&argv[i+1][0]);
+                    if (ThreadCount == 0 || ThreadCount > MAX_PERF_THREADS) {
+                        usage();
+                        exit(1);
+                    }
+                    fPerf = TRUE;
+                }
+                i++;
+                break;
+            case 'q':
+            case 'Q':
+                if (i+1 >= argc) {
+                    usage();
+                    exit(1);
+                }
+                else {
+                    QueueDepth = atoi(&argv[i+1][0]);
+                    if (QueueDepth == 0 || QueueDepth > MAX_PERF_QUEUE_DEPTH) {
+                        usage();
+                        exit(1);
+                    }
+                }
+                i++;
+                break;
              case 'o':
              case 'O':
                  if (i+1 >= argc) {
@@ -1154,6 +1211,298 @@ Return Value:
 
 
 
+DWORD
+WINAPI
+perf_thread(
+    _In_ LPVOID Parameter
+    )
+/*++
+Routine Description:
+
+    Throughput test thread. Keeps QueueDepth overlapped reads or writes
+    pending on its pipe handle until IterationCount requests have completed,
+    and records the latency of each request.
+
+Arguments:
+
+    Parameter - the PERF_THREAD describing this thread
+
+Return Value:
+
+    Zero
+
+--*/
+{
+    PPERF_THREAD  perf = (PPERF_THREAD) Parameter;
+    OVERLAPPED    ov[MAX_PERF_QUEUE_DEPTH];
+    LARGE_INTEGER start[MAX_PERF_QUEUE_DEPTH];
+    BOOL          pending[MAX_PERF_QUEUE_DEPTH];
+    char *        buf = NULL;
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER now;
+    ULONGLONG     latency;
+    ULONG         bucket;
+    ULONG         slot;
+    ULONG         i;
+    DWORD         nBytes;
+    BOOL          success;
+
+    ZeroMemory(ov, sizeof(ov));
+    ZeroMemory(pending, sizeof(pending));
+    QueryPerformanceFrequency(&frequency);
+
+    buf = (char*) malloc((size_t) perf->Length * QueueDepth);
+    if (buf == NULL) {
+        perf->Errors = IterationCount;
+        return 0;
+    }
+
+    for (slot = 0; slot < QueueDepth; slot++) {
+        ov[slot].hEvent = CreateEvent(NULL, TRUE, FALSE, NULL);
+        if (ov[slot].hEvent == NULL) {
+            perf->Errors = IterationCount;
+            goto Exit;
+        }
+    }
+
+    if (!perf->Read) {
+        for (i = 0; i < (ULONG) perf->Length * QueueDepth; i++) {
+            buf[i] = (char) i;
+        }
+    }
+
+    //
+    // Request i is issued on slot i % QueueDepth. The pipe completes
+    // requests in order, so waiting on the oldest slot keeps the queue full.
+    //
+    for (i = 0; i < IterationCount + QueueDepth; i++) {
+
+        slot = i % QueueDepth;
+
+        if (i >= QueueDepth) {
+
+            if (pending[slot]) {
+                success = GetOverlappedResult(perf->hDev, &ov[slot], &nBytes, TRUE);
+                QueryPerformanceCounter(&now);
+
+                if (success) {
+                    perf->Bytes += nBytes;
+                }
+                else {
+                    perf->Errors++;
+                }
+
+                latency = ((now.QuadPart - start[slot].QuadPart) * 1000000) /
+                          frequency.QuadPart;
+
+                for (bucket = 0; bucket < LATENCY_BUCKETS - 1; bucket++) {
+                    if (latency < (1ULL << bucket)) {
+                        break;
+                    }
+                }
+                perf->Histogram[bucket]++;
+                pending[slot] = FALSE;
+            }
+        }
+
+        if (i >= IterationCount) {
+            continue;
+        }
+
+        ResetEvent(ov[slot].hEvent);
+        QueryPerformanceCounter(&start[slot]);
+
+        if (perf->Read) {
+            success = ReadFile(perf->hDev, buf + (size_t) slot * perf->Length,
+                               perf->Length, NULL, &ov[slot]);
+        }
+        else {
+            success = WriteFile(perf->hDev, buf + (size_t) slot * perf->Length,
+                                perf->Length, NULL, &ov[slot]);
+        }
+
+        if (success || GetLastError() == ERROR_IO_PENDING) {
+            pending[slot] = TRUE;
+        }
+        else {
+            perf->Errors++;
+        }
+    }
+
+Exit:
+    for (slot = 0; slot < QueueDepth; slot++) {
+        if (ov[slot].hEvent != NULL) {
+            CloseHandle(ov[slot].hEvent);
+        }
+    }
+
+    free(buf);
+
+    return 0;
+}
+
+void
+perf_report(
+    _In_ PSTR pipe,
+    _In_ BOOL read,
+    _In_reads_(count) PPERF_THREAD perf,
+    _In_ ULONG count,
+    _In_ double seconds
+    )
+/*++
+Routine Description:
+
+    Called by perf_test() to print the throughput and the merged latency
+    histogram of the threads that used one pipe
+
+Arguments:
+
+    pipe - pipe name
+    read - TRUE for the read threads
+    perf - array of thread states
+    count - number of threads
+    seconds - duration of the test
+
+Return Value:
+
+    None
+
+--*/
+{
+    ULONGLONG bytes = 0;
+    ULONG     errors = 0;
+    ULONG     histogram[LATENCY_BUCKETS] = {0};
+    ULONG     i;
+    ULONG     j;
+
+    for (i = 0; i < count; i++) {
+        bytes += perf[i].Bytes;
+        errors += perf[i].Errors;
+        for (j = 0; j < LATENCY_BUCKETS; j++) {
+            histogram[j] += perf[i].Histogram[j];
+        }
+    }
+
+    printf("<%s> %s : %u threads x %u pending -- %I64u bytes, %u errors, %.2f MB/s\n",
+           pipe, read ? "R" : "W", count, QueueDepth, bytes, errors,
+           seconds > 0 ? (bytes / (1024.0 * 1024.0)) / seconds : 0);
+
+    printf("  latency (us)    requests\n");
+
+    for (j = 0; j < LATENCY_BUCKETS; j++) {
+        if (histogram[j] == 0) {
+            continue;
+        }
+        if (j == LATENCY_BUCKETS - 1) {
+            printf("  >= %-10u  %u\n", 1u << (j - 1), histogram[j]);
+        }
+        else {
+            printf("  <  %-10u  %u\n", 1u << j, histogram[j]);
+        }
+    }
+}
+
+void
+perf_test()
+/*++
+Routine Description:
+
+    Called by main() to run the overlapped throughput test (Cmdline "-t").
+    Each thread opens its own overlapped handle to the pipe and keeps
+    QueueDepth requests pending, so the driver always has several requests
+    to work on. Data is not validated.
+
+Arguments:
+
+    None
+
+Return Value:
+
+    None
+
+--*/
+{
+    PERF_THREAD   readPerf[MAX_PERF_THREADS] = {0};
+    PERF_THREAD   writePerf[MAX_PERF_THREADS] = {0};
+    HANDLE        threads[2 * MAX_PERF_THREADS];
+    ULONG         nThreads = 0;
+    ULONG         i;
+    LARGE_INTEGER frequency;
+    LARGE_INTEGER begin;
+    LARGE_INTEGER end;
+    double        seconds;
+
+    QueryPerformanceFrequency(&frequency);
+
+    for (i = 0; i < ThreadCount; i++) {
+        if (fRead) {
+            readPerf[i].Read = TRUE;
+            readPerf[i].Length = ReadLen;
+            readPerf[i].hDev = open_file(inPipe, FILE_FLAG_OVERLAPPED);
+            if (readPerf[i].hDev == INVALID_HANDLE_VALUE) {
+                goto Exit;
+            }
+        }
+        if (fWrite) {
+            writePerf[i].Read = FALSE;
+            writePerf[i].Length = WriteLen;
+            writePerf[i].hDev = open_file(outPipe, FILE_FLAG_OVERLAPPED);
+            if (writePerf[i].hDev == INVALID_HANDLE_VALUE) {
+                goto Exit;
+            }
+        }
+    }
+
+    QueryPerformanceCounter(&begin);
+
+    for (i = 0; i < ThreadCount; i++) {
+        if (fWrite) {
+            writePerf[i].Thread = CreateThread(NULL, 0, perf_thread, &writePerf[i], 0, NULL);
+            if (writePerf[i].Thread != NULL) {
+                threads[nThreads++] = writePerf[i].Thread;
+            }
+        }
+        if (fRead) {
+            readPerf[i].Thread = CreateThread(NULL, 0, perf_thread, &readPerf[i], 0, NULL);
+            if (readPerf[i].Thread != NULL) {
+                threads[nThreads++] = readPerf[i].Thread;
+            }
+        }
+    }
+
+    if (nThreads != 0) {
+        WaitForMultipleObjects(nThreads, threads, TRUE, INFINITE);
+    }
+
+    QueryPerformanceCounter(&end);
+
+    seconds = (double) (end.QuadPart - begin.QuadPart) / frequency.QuadPart;
+
+    if (fWrite) {
+        perf_report(outPipe, FALSE, writePerf, ThreadCount, seconds);
+    }
+    if (fRead) {
+        perf_report(inPipe, TRUE, readPerf, ThreadCount, seconds);
+    }
+
+Exit:
+    for (i = 0; i < ThreadCount; i++) {
+        if (readPerf[i].Thread != NULL) {
+            CloseHandle(readPerf[i].Thread);
+        }
+        if (writePerf[i].Thread != NULL) {
+            CloseHandle(writePerf[i].Thread);
+        }
+        if (readPerf[i].hDev != NULL && readPerf[i].hDev != INVALID_HANDLE_VALUE) {
+            CloseHandle(readPerf[i].hDev);
+        }
+        if (writePerf[i].hDev != NULL && writePerf[i].hDev != INVALID_HANDLE_VALUE) {
+            CloseHandle(writePerf[i].hDev);
+        }
+    }
+}
+
+
 int
 _cdecl
 main(
@@ -1196,6 +1545,12 @@ Return Value:
             dumpUsbConfig();
     }
 
+    // overlapped throughput test
+    if (fPerf && ((fRead) || (fWrite))) {
+        perf_test();
+        return 0;
+    }
+
     // doing a read, write, or both test
     if ((fRead) || (fWrite)) {
 
@@ -1210,7 +1565,7 @@ Return Value:
                 }
             }
 
-            hRead = open_file( inPipe);
+            hRead = open_file( inPipe, 0);
             pinBuf = (char*) malloc(ReadLen);
             if (pinBuf == NULL) {
                 return 0;
@@ -1225,7 +1580,7 @@ Return Value:
                 }
             }
 
-            hWrite = open_file( outPipe);
+            hWrite = open_file( outPipe, 0);
             poutBuf = (char*)malloc(WriteLen);
             if (poutBuf == NULL) {
                 return 0;
@@ -39,9 +39,11 @@ Routine Description:
 
     This callback is invoked when the framework received  WdfRequestTypeRead or
     WdfRequestTypeWrite request. This read/write is performed in stages of
-    maximum transfer size. Once a stage of transfer is complete, then the
-    request is circulated again, until the requested length of transfer is
-    performed.
+    maximum transfer size. For writes, if the pipeline depth allows it, up
+    to BulkPipelineDepth stages are sent at the same time on driver created
+    requests (see StartPipelinedBulkTransfer). Otherwise, once a stage of
+    transfer is complete, the request is circulated again, until the
+    requested length of transfer is performed.
 
 Arguments:
 
@@ -115,6 +117,7 @@ Return Value:
     }
 
     rwContext = GetRequestContext(Request);
+    rwContext->Pipelined = FALSE;
 
     if (RequestType == WdfRequestTypeRead) {
 
@@ -157,6 +160,46 @@ Return Value:
         stageLength = totalLength;
     }
 
+#if (NTDDI_VERSION >= NTDDI_WIN8)
+    if(WdfUsbPipeTypeBulk == pipeInfo.PipeType &&
+        pipeContext->StreamConfigured == TRUE) {
+        //
+        // For super speed bulk pipe with streams, we specify one of its associated
+        // usbd pipe handles to format an URB for sending or receiving data.
+        // The usbd pipe handle is returned by the HCD via successful open-streams request
+        //
+        usbdPipeHandle = GetStreamPipeHandleFromBulkPipe(pipe);
+    }
+    else {
+        usbdPipeHandle = WdfUsbTargetPipeWdmGetPipeHandle(pipe);
+    }
+#else
+    usbdPipeHandle = WdfUsbTargetPipeWdmGetPipeHandle(pipe);
+#endif
+
+    //
+    // If a write takes more than one stage, keep several stages in flight
+    // so the bus is not left idle while each completion is processed.
+    //
+    // Reads are not pipelined. A short packet ends a read, and the stages
+    // already queued behind it would consume the packets the device sends
+    // next, which the caller never sees. One stage at a time leaves that
+    // data for the next read.
+    //
+    if (RequestType == WdfRequestTypeWrite &&
+        deviceContext->BulkPipelineDepth > 1 &&
+        totalLength > stageLength) {
+        status = StartPipelinedBulkTransfer(deviceContext,
+                                            Request,
+                                            pipe,
+                                            usbdPipeHandle,
+                                            requestMdl,
+                                            urbFlags,
+                                            totalLength,
+                                            stageLength);
+        goto Exit;
+    }
+
     newMdl = IoAllocateMdl((PVOID) virtualAddress,
                            totalLength,
                            FALSE,
@@ -190,23 +233,6 @@ Return Value:
         goto Exit;
     }
 
-#if (NTDDI_VERSION >= NTDDI_WIN8)
-    if(WdfUsbPipeTypeBulk == pipeInfo.PipeType &&
-        pipeContext->StreamConfigured == TRUE) {
-        //
-        // For super speed bulk pipe with streams, we specify one of its associated
-        // usbd pipe handles to format an URB for sending or receiving data.
-        // The usbd pipe handle is returned by the HCD via successful open-streams request
-        //
-        usbdPipeHandle = GetStreamPipeHandleFromBulkPipe(pipe);
-    }
-    else {
-        usbdPipeHandle = WdfUsbTargetPipeWdmGetPipeHandle(pipe);
-    }
-#else
-    usbdPipeHandle = WdfUsbTargetPipeWdmGetPipeHandle(pipe);
-#endif
-
     UsbBuildInterruptOrBulkTransferRequest(urb,
                                            sizeof(struct _URB_BULK_OR_INTERRUPT_TRANSFER),
                                            usbdPipeHandle,
@@ -429,6 +455,711 @@ End:
     return;
 }
 
+
+NTSTATUS
+StartPipelinedBulkTransfer(
+    _In_ PDEVICE_CONTEXT  DeviceContext,
+    _In_ WDFREQUEST       Request,
+    _In_ WDFUSBPIPE       Pipe,
+    _In_ USBD_PIPE_HANDLE UsbdPipeHandle,
+    _In_ PMDL             RequestMdl,
+    _In_ ULONG            UrbFlags,
+    _In_ ULONG            TotalLength,
+    _In_ ULONG            StageLength
+    )
+/*++
+
+Routine Description:
+
+    This routine splits a bulk write into stages of StageLength bytes
+    and keeps up to BulkPipelineDepth of them in flight. Each stage is sent
+    on its own driver created request with its own URB and partial MDL.
+    When a stage completes, its request is reused for the next unclaimed
+    range of the user buffer, so the parent request is completed only once,
+    after the last stage retires.
+
+Arguments:
+
+    DeviceContext - Device context of the target device.
+
+    Request - The read/write request received from the framework.
+
+    Pipe - Bulk or interrupt pipe the transfer is performed on.
+
+    UsbdPipeHandle - Pipe handle used to build the stage URBs.
+
+    RequestMdl - MDL describing the user buffer.
+
+    UrbFlags - Transfer flags used to build the stage URBs.
+
+    TotalLength - Length of the transfer.
+
+    StageLength - Maximum length of a single stage.
+
+Return Value:
+
+    If the routine fails, the caller is responsible for completing the
+    request. Otherwise the request is completed when the last stage retires.
+
+--*/
+{
+    NTSTATUS                status = STATUS_SUCCESS;
+    PREQUEST_CONTEXT        rwContext;
+    PSTAGE_CONTEXT          stageContext;
+    WDF_OBJECT_ATTRIBUTES   objectAttribs;
+    WDFREQUEST              stage;
+    ULONG                   stageCount;
+    ULONG                   i;
+
+    rwContext = GetRequestContext(Request);
+
+    stageCount = (TotalLength + StageLength - 1) / StageLength;
+    if (stageCount > DeviceContext->BulkPipelineDepth) {
+        stageCount = DeviceContext->BulkPipelineDepth;
+    }
+
+    rwContext->UrbMemory       = NULL;
+    rwContext->Mdl             = NULL;
+    rwContext->Length          = TotalLength;
+    rwContext->Numxfer         = 0;
+    rwContext->VirtualAddress  = (ULONG_PTR) MmGetMdlVirtualAddress(RequestMdl);
+    rwContext->StopStaging     = FALSE;
+    rwContext->Status          = STATUS_SUCCESS;
+    rwContext->TotalLength     = TotalLength;
+    rwContext->NextOffset      = 0;
+    rwContext->ValidLength     = TotalLength;
+    rwContext->StageLength     = StageLength;
+    rwContext->UrbFlags        = UrbFlags;
+    rwContext->UsbdPipeHandle  = UsbdPipeHandle;
+    rwContext->RequestMdl      = RequestMdl;
+    rwContext->StageCount      = 0;
+    rwContext->Sending         = FALSE;
+    rwContext->ReadyHead       = 0;
+    rwContext->ReadyCount      = 0;
+
+    WDF_OBJECT_ATTRIBUTES_INIT(&objectAttribs);
+    objectAttribs.ParentObject = Request;
+
+    status = WdfSpinLockCreate(&objectAttribs, &rwContext->StageLock);
+    if (!NT_SUCCESS(status)) {
+        UsbSamp_DbgPrint(1, ("WdfSpinLockCreate for stages failed %x\n", status));
+        return status;
+    }
+
+    //
+    // Create all the stage requests up front. They are parented to the
+    // request, so they are deleted along with it when it completes.
+    //
+    for (i = 0; i < stageCount; i++) {
+
+        WDF_OBJECT_ATTRIBUTES_INIT_CONTEXT_TYPE(&objectAttribs, STAGE_CONTEXT);
+        objectAttribs.ParentObject = Request;
+        objectAttribs.EvtCleanupCallback = UsbSamp_EvtBulkStageContextCleanup;
+
+        status = WdfRequestCreate(&objectAttribs,
+                                  WdfUsbTargetPipeGetIoTarget(Pipe),
+                                  &stage);
+        if (!NT_SUCCESS(status)) {
+            UsbSamp_DbgPrint(1, ("WdfRequestCreate for stage failed %x\n", status));
+            break;
+        }
+
+        stageContext = GetStageContext(stage);
+        stageContext->ParentRequest = Request;
+
+        //
+        // The MDL is large enough to describe any range of the user buffer.
+        //
+        stageContext->Mdl = IoAllocateMdl((PVOID) rwContext->VirtualAddress,
+                                          TotalLength,
+                                          FALSE,
+                                          FALSE,
+                                          NULL);
+        if (stageContext->Mdl == NULL) {
+            UsbSamp_DbgPrint(1, ("Failed to alloc mem for stage mdl\n"));
+            status = STATUS_INSUFFICIENT_RESOURCES;
+            WdfObjectDelete(stage);
+            break;
+        }
+
+        WDF_OBJECT_ATTRIBUTES_INIT(&objectAttribs);
+        objectAttribs.ParentObject = stage;
+
+        status = WdfUsbTargetDeviceCreateUrb(DeviceContext->WdfUsbTargetDevice,
+                                             &objectAttribs,
+                                             &stageContext->UrbMemory,
+                                             NULL);
+        if (!NT_SUCCESS(status)) {
+            UsbSamp_DbgPrint(1, ("WdfUsbTargetDeviceCreateUrb for stage failed %x\n", status));
+            WdfObjectDelete(stage);
+            break;
+        }
+
+        rwContext->StageRequests[rwContext->StageCount++] = stage;
+    }
+
+    //
+    // Run with fewer stages if we could not create all of them.
+    //
+    if (rwContext->StageCount == 0) {
+        return status;
+    }
+
+    //
+    // One reference per stage plus one held until all the stages have been
+    // sent. The cancel routine and the last stage each drop one of the
+    // cancel references; whichever drops the last one completes the request.
+    //
+    rwContext->StagesPending    = rwContext->StageCount + 1;
+    rwContext->CancelReferences = 2;
+    rwContext->Pipelined        = TRUE;
+
+    status = WdfRequestMarkCancelableEx(Request, UsbSamp_EvtPipelinedRequestCancel);
+    if (!NT_SUCCESS(status)) {
+        UsbSamp_DbgPrint(1, ("WdfRequestMarkCancelableEx failed %x\n", status));
+        rwContext->Pipelined = FALSE;
+        return status;
+    }
+
+    for (i = 0; i < rwContext->StageCount; i++) {
+
+        status = SubmitBulkStage(rwContext->StageRequests[i], Pipe);
+        if (!NT_SUCCESS(status)) {
+
+            if (status != STATUS_NO_MORE_ENTRIES) {
+                UsbSamp_DbgPrint(1, ("Failed to submit stage %d 0x%x\n", i, status));
+
+                InterlockedCompareExchange(&rwContext->Status, status, STATUS_SUCCESS);
+                InterlockedExchange(&rwContext->StopStaging, TRUE);
+            }
+
+            DereferencePipelinedRequest(Request);
+        }
+    }
+
+    DereferencePipelinedRequest(Request);
+
+    return STATUS_SUCCESS;
+}
+
+NTSTATUS
+SubmitBulkStage(
+    _In_ WDFREQUEST       Stage,
+    _In_ WDFUSBPIPE       Pipe
+    )
+/*++
+
+Routine Description:
+
+    This routine claims the next unassigned range of the user buffer for
+    a stage request, formats the stage for it and queues it to be sent.
+
+    The claim and the queueing are done under StageLock, so the ready queue
+    is in offset order. If no other thread is sending, this thread becomes
+    the sender and sends the queue in order. The lock is not held across
+    WdfRequestSend, because a stage that completes synchronously reenters
+    this routine from its completion routine.
+
+Arguments:
+
+    Stage - Stage request created by StartPipelinedBulkTransfer.
+
+    Pipe - Pipe the transfer is performed on.
+
+Return Value:
+
+    STATUS_NO_MORE_ENTRIES if there is nothing left for this stage to
+    transfer, a failure status if the stage could not be formatted, and
+    STATUS_SUCCESS once the stage is queued. A stage that fails to send
+    after it was queued is retired by the sender.
+
+--*/
+{
+    NTSTATUS                status;
+    PSTAGE_CONTEXT          stageContext;
+    PREQUEST_CONTEXT        rwContext;
+    WDF_REQUEST_REUSE_PARAMS reuseParams;
+    PURB                    urb;
+    ULONG                   offset;
+    ULONG                   stageLength;
+    BOOLEAN                 sender;
+
+    stageContext = GetStageContext(Stage);
+    rwContext = GetRequestContext(stageContext->ParentRequest);
+
+    WdfSpinLockAcquire(rwContext->StageLock);
+
+    //
+    // Stages complete in any order, so claim the range under the lock and
+    // queue the stage before another stage can claim the next range.
+    //
+    if (rwContext->StopStaging) {
+        WdfSpinLockRelease(rwContext->StageLock);
+        return STATUS_NO_MORE_ENTRIES;
+    }
+
+    offset = rwContext->NextOffset;
+    if (offset >= rwContext->TotalLength) {
+        WdfSpinLockRelease(rwContext->StageLock);
+        return STATUS_NO_MORE_ENTRIES;
+    }
+
+    stageLength = rwContext->TotalLength - offset;
+    if (stageLength > rwContext->StageLength) {
+        stageLength = rwContext->StageLength;
+    }
+
+    rwContext->NextOffset = offset + stageLength;
+
+    stageContext->Offset = offset;
+    stageContext->Length = stageLength;
+
+    WDF_REQUEST_REUSE_PARAMS_INIT(&reuseParams, WDF_REQUEST_REUSE_NO_FLAGS, STATUS_SUCCESS);
+
+    status = WdfRequestReuse(Stage, &reuseParams);
+    if (!NT_SUCCESS(status)) {
+        WdfSpinLockRelease(rwContext->StageLock);
+        return status;
+    }
+
+    //
+    // Following call is required to free any mapping made on the partial MDL
+    // and reset internal MDL state.
+    //
+    MmPrepareMdlForReuse(stageContext->Mdl);
+
+    IoBuildPartialMdl(rwContext->RequestMdl,
+                      stageContext->Mdl,
+                      (PVOID) (rwContext->VirtualAddress + offset),
+                      stageLength);
+
+    urb = (PURB) WdfMemoryGetBuffer(stageContext->UrbMemory, NULL);
+
+    UsbBuildInterruptOrBulkTransferRequest(urb,
+                                           sizeof(struct _URB_BULK_OR_INTERRUPT_TRANSFER),
+                                           rwContext->UsbdPipeHandle,
+                                           NULL,
+                                           stageContext->Mdl,
+                                           stageLength,
+                                           rwContext->UrbFlags,
+                                           NULL);
+
+    status = WdfUsbTargetPipeFormatRequestForUrb(Pipe, Stage, stageContext->UrbMemory, NULL);
+    if (!NT_SUCCESS(status)) {
+        WdfSpinLockRelease(rwContext->StageLock);
+        UsbSamp_DbgPrint(1, ("Failed to format stage request for urb\n"));
+        return status;
+    }
+
+    WdfRequestSetCompletionRoutine(Stage, UsbSamp_EvtBulkStageCompletion, WDF_NO_CONTEXT);
+
+    //
+    // Each stage is queued at most once at a time, so the queue cannot
+    // hold more than StageCount entries.
+    //
+    NT_ASSERT(rwContext->ReadyCount < rwContext->StageCount);
+
+    rwContext->ReadyStages[(rwContext->ReadyHead + rwContext->ReadyCount) %
+                           MAX_BULK_PIPELINE_DEPTH] = Stage;
+    rwContext->ReadyCount++;
+
+    sender = !rwContext->Sending;
+    if (sender) {
+        rwContext->Sending = TRUE;
+
+        //
+        // Once sent, a stage can complete and retire on another processor,
+        // which may complete the parent request and delete the stages. Hold
+        // a stage reference on the parent while we are sending.
+        //
+        InterlockedIncrement(&rwContext->StagesPending);
+    }
+
+    WdfSpinLockRelease(rwContext->StageLock);
+
+    if (sender) {
+        SendReadyBulkStages(stageContext->ParentRequest, Pipe);
+        DereferencePipelinedRequest(stageContext->ParentRequest);
+    }
+
+    return STATUS_SUCCESS;
+}
+
+VOID
+SendReadyBulkStages(
+    _In_ WDFREQUEST       Request,
+    _In_ WDFUSBPIPE       Pipe
+    )
+/*++
+
+Routine Description:
+
+    This routine sends the queued stages of a pipelined request in the
+    order they were queued, until the queue is empty. Only the thread that
+    set Sending calls it, so no two stages are sent concurrently.
+
+Arguments:
+
+    Request - The pipelined read/write request.
+
+    Pipe - Pipe the transfer is performed on.
+
+Return Value:
+
+    None
+
+--*/
+{
+    NTSTATUS                status;
+    PREQUEST_CONTEXT        rwContext;
+    WDFREQUEST              stage;
+
+    rwContext = GetRequestContext(Request);
+
+    WdfSpinLockAcquire(rwContext->StageLock);
+
+    while (rwContext->ReadyCount != 0) {
+
+        stage = rwContext->ReadyStages[rwContext->ReadyHead];
+        rwContext->ReadyHead = (rwContext->ReadyHead + 1) % MAX_BULK_PIPELINE_DEPTH;
+        rwContext->ReadyCount--;
+
+        WdfSpinLockRelease(rwContext->StageLock);
+
+        if (rwContext->StopStaging) {
+            //
+            // The request is being torn down, so retire the stage unsent.
+            //
+            DereferencePipelinedRequest(Request);
+        }
+        else if (!WdfRequestSend(stage, WdfUsbTargetPipeGetIoTarget(Pipe), WDF_NO_SEND_OPTIONS)) {
+            status = WdfRequestGetStatus(stage);
+            NT_ASSERT(!NT_SUCCESS(status));
+
+            UsbSamp_DbgPrint(1, ("Failed to send stage 0x%x\n", status));
+
+            InterlockedCompareExchange(&rwContext->Status, status, STATUS_SUCCESS);
+            InterlockedExchange(&rwContext->StopStaging, TRUE);
+
+            DereferencePipelinedRequest(Request);
+        }
+        else {
+            //
+            // The cancel routine and CancelBulkStages set StopStaging before
+            // they cancel the stages. If that happened after the check above,
+            // they may have tried to cancel this stage before it was sent, so
+            // cancel it ourselves.
+            //
+            KeMemoryBarrier();
+
+            if (rwContext->StopStaging) {
+                WdfRequestCancelSentRequest(stage);
+            }
+        }
+
+        WdfSpinLockAcquire(rwContext->StageLock);
+    }
+
+    rwContext->Sending = FALSE;
+
+    WdfSpinLockRelease(rwContext->StageLock);
+}
+
+VOID
+UsbSamp_EvtBulkStageCompletion(
+    _In_ WDFREQUEST                  Request,
+    _In_ WDFIOTARGET                 Target,
+    PWDF_REQUEST_COMPLETION_PARAMS CompletionParams,
+    _In_ WDFCONTEXT                  Context
+    )
+/*++
+
+Routine Description:
+
+    This is the completion routine for a stage of a pipelined read/write.
+    If the stage completes with success, the stage request is resent for
+    the next unclaimed range. Otherwise the stage retires, and the last
+    stage to retire completes the parent request.
+
+Arguments:
+
+    Request - Stage request handle
+    Target - Pipe the stage was sent to
+    CompletionParams - request completion params
+    Context - Not used
+
+Return Value:
+    None
+
+--*/
+{
+    WDFUSBPIPE              pipe;
+    NTSTATUS                status;
+    PSTAGE_CONTEXT          stageContext;
+    PREQUEST_CONTEXT        rwContext;
+    PURB                    urb;
+    ULONG                   bytesReadWritten;
+    ULONG                   stageEnd;
+    ULONG                   validLength;
+
+    UNREFERENCED_PARAMETER(Context);
+
+    stageContext = GetStageContext(Request);
+    rwContext = GetRequestContext(stageContext->ParentRequest);
+
+    pipe = (WDFUSBPIPE) Target;
+    status = CompletionParams->IoStatus.Status;
+
+    if (!NT_SUCCESS(status)){
+        InterlockedExchange(&rwContext->StopStaging, TRUE);
+
+        //
+        // Only the first failing stage queues the pipe reset. The workitem
+        // is needed because the completion could be running at DISPATCH_LEVEL.
+        //
+        if (InterlockedCompareExchange(&rwContext->Status,
+                                       status,
+                                       STATUS_SUCCESS) == STATUS_SUCCESS) {
+            QueuePassiveLevelCallback(WdfIoTargetGetDevice(Target), pipe);
+        }
+        goto Retire;
+    }
+
+    urb = (PURB) WdfMemoryGetBuffer(stageContext->UrbMemory, NULL);
+    bytesReadWritten = urb->UrbBulkOrInterruptTransfer.TransferBufferLength;
+    InterlockedExchangeAdd((PLONG) &rwContext->Numxfer, (LONG) bytesReadWritten);
+
+    if (bytesReadWritten < stageContext->Length) {
+        //
+        // A short transfer ends the request. Stages already in flight past
+        // this point may still send data, but only the contiguous part of
+        // the buffer is reported back to the caller. Only writes are
+        // pipelined, so no data from the device is lost this way.
+        //
+        stageEnd = stageContext->Offset + bytesReadWritten;
+
+        do {
+            validLength = rwContext->ValidLength;
+            if (stageEnd >= validLength) {
+                break;
+            }
+        } while ((ULONG) InterlockedCompareExchange((PLONG) &rwContext->ValidLength,
+                                                    (LONG) stageEnd,
+                                                    (LONG) validLength) != validLength);
+
+        InterlockedExchange(&rwContext->StopStaging, TRUE);
+        goto Retire;
+    }
+
+    status = SubmitBulkStage(Request, pipe);
+    if (NT_SUCCESS(status)) {
+        //
+        // When the request completes, this completion routine will be
+        // called again.
+        //
+        return;
+    }
+
+    if (status != STATUS_NO_MORE_ENTRIES) {
+        UsbSamp_DbgPrint(1, ("Failed to resubmit stage 0x%x\n", status));
+
+        InterlockedCompareExchange(&rwContext->Status, status, STATUS_SUCCESS);
+        InterlockedExchange(&rwContext->StopStaging, TRUE);
+    }
+
+Retire:
+    DereferencePipelinedRequest(stageContext->ParentRequest);
+
+    return;
+}
+
+VOID
+DereferencePipelinedRequest(
+    _In_ WDFREQUEST       Request
+    )
+/*++
+
+Routine Description:
+
+    This routine drops a stage reference on a pipelined request and
+    completes the request once nothing is left in flight.
+
+Arguments:
+
+    Request - The read/write request received from the framework.
+
+Return Value:
+    None
+
+--*/
+{
+    PREQUEST_CONTEXT        rwContext;
+    NTSTATUS                status;
+    ULONG_PTR               information;
+
+    rwContext = GetRequestContext(Request);
+
+    if (InterlockedDecrement(&rwContext->StagesPending) != 0) {
+        return;
+    }
+
+    //
+    // If the cancel routine has run or is about to run, let whichever of
+    // us finishes last complete the request, since it still walks the
+    // stage requests.
+    //
+    if (WdfRequestUnmarkCancelable(Request) == STATUS_CANCELLED) {
+        if (InterlockedDecrement(&rwContext->CancelReferences) != 0) {
+            return;
+        }
+    }
+
+    status = rwContext->Status;
+    information = NT_SUCCESS(status) ? rwContext->ValidLength : 0;
+
+    DbgPrintRWContext(rwContext);
+
+    UsbSamp_DbgPrint(3, ("%s request completed with status 0x%x\n",
+                         rwContext->Read ? "Read" : "Write", status));
+
+    WdfRequestCompleteWithInformation(Request, status, information);
+
+    return;
+}
+
+VOID
+CancelBulkStages(
+    _In_ WDFREQUEST       Request
+    )
+/*++
+
+Routine Description:
+
+    This routine is called from EvtIoStop to stop a pipelined request from
+    submitting more stages and to cancel the stages that are in flight.
+    The last stage to retire completes the request.
+
+Arguments:
+
+    Request - The read/write request received from the framework.
+
+Return Value:
+    None
+
+--*/
+{
+    PREQUEST_CONTEXT        rwContext;
+    LONG                    stagesPending;
+    ULONG                   i;
+
+    rwContext = GetRequestContext(Request);
+
+    //
+    // Hold a stage reference so the request, and the stage requests
+    // parented to it, are not deleted while we walk them. If nothing is
+    // left in flight, the request is already being completed.
+    //
+    do {
+        stagesPending = rwContext->StagesPending;
+        if (stagesPending == 0) {
+            return;
+        }
+    } while (InterlockedCompareExchange(&rwContext->StagesPending,
+                                        stagesPending + 1,
+                                        stagesPending) != stagesPending);
+
+    InterlockedExchange(&rwContext->StopStaging, TRUE);
+
+    for (i = 0; i < rwContext->StageCount; i++) {
+        WdfRequestCancelSentRequest(rwContext->StageRequests[i]);
+    }
+
+    DereferencePipelinedRequest(Request);
+
+    return;
+}
+
+VOID
+UsbSamp_EvtPipelinedRequestCancel(
+    _In_ WDFREQUEST       Request
+    )
+/*++
+
+Routine Description:
+
+    This is the cancel routine for pipelined read/write requests.
+    The request is not completed here unless the last stage has already
+    retired; otherwise the last stage completes it.
+
+Arguments:
+
+    Request - The read/write request received from the framework.
+
+Return Value:
+    None
+
+--*/
+{
+    PREQUEST_CONTEXT        rwContext;
+    ULONG                   i;
+
+    rwContext = GetRequestContext(Request);
+
+    UsbSamp_DbgPrint(3, ("Pipelined request %p cancelled\n", Request));
+
+    InterlockedCompareExchange(&rwContext->Status, STATUS_CANCELLED, STATUS_SUCCESS);
+    InterlockedExchange(&rwContext->StopStaging, TRUE);
+
+    //
+    // The request cannot be completed before we drop our cancel reference,
+    // so the stage requests stay valid while we walk them.
+    //
+    for (i = 0; i < rwContext->StageCount; i++) {
+        WdfRequestCancelSentRequest(rwContext->StageRequests[i]);
+    }
+
+    if (InterlockedDecrement(&rwContext->CancelReferences) == 0) {
+
+        DbgPrintRWContext(rwContext);
+
+        WdfRequestCompleteWithInformation(Request, rwContext->Status, 0);
+    }
+
+    return;
+}
+
+VOID
+UsbSamp_EvtBulkStageContextCleanup(
+    _In_ WDFOBJECT        Object
+    )
+/*++
+
+Routine Description:
+
+    This routine frees the partial MDL of a stage request when the
+    stage request is deleted.
+
+Arguments:
+
+    Object - Stage request handle
+
+Return Value:
+    None
+
+--*/
+{
+    PSTAGE_CONTEXT          stageContext;
+
+    stageContext = GetStageContext(Object);
+
+    if (stageContext->Mdl != NULL) {
+        IoFreeMdl(stageContext->Mdl);
+        stageContext->Mdl = NULL;
+    }
+
+    return;
+}
+
 #else
 
 VOID
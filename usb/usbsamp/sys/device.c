@@ -79,6 +79,7 @@ Return Value:
     PDEVICE_CONTEXT                     pDevContext;
     WDFQUEUE                            queue;
     ULONG                               maximumTransferSize;
+    ULONG                               bulkPipelineDepth;
 
     UNREFERENCED_PARAMETER(Driver);
 
@@ -186,6 +187,25 @@ Return Value:
         pDevContext->MaximumTransferSize = DEFAULT_REGISTRY_TRANSFER_SIZE;
     }
 
+    //
+    //Get BulkPipelineDepth from registry
+    //
+    bulkPipelineDepth = 0;
+
+    ReadFdoRegistryKeyValue(Driver,
+                              L"BulkPipelineDepth",
+                              &bulkPipelineDepth);
+
+    if (bulkPipelineDepth == 0){
+        pDevContext->BulkPipelineDepth = DEFAULT_BULK_PIPELINE_DEPTH;
+    }
+    else if (bulkPipelineDepth > MAX_BULK_PIPELINE_DEPTH) {
+        pDevContext->BulkPipelineDepth = MAX_BULK_PIPELINE_DEPTH;
+    }
+    else {
+        pDevContext->BulkPipelineDepth = bulkPipelineDepth;
+    }
+
     //
     // Tell the framework to set the SurpriseRemovalOK in the DeviceCaps so
     // that you don't get the popup in usermode (on Win2K) when you surprise
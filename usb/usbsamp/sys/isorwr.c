@@ -558,6 +558,15 @@ Return Value:
         WdfRequestStopAcknowledge(Request, FALSE); // Don't requeue
     } 
     else if (ActionFlags & WdfRequestStopActionPurge) {
+#if !defined(BUFFERED_READ_WRITE)
+        //
+        // Pipelined bulk requests are not sent themselves; their stages are.
+        //
+        if (GetRequestContext(Request)->Pipelined) {
+            CancelBulkStages(Request);
+            return;
+        }
+#endif
         WdfRequestCancelSentRequest(Request);
     }
 
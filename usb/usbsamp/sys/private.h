@@ -78,6 +78,15 @@ Environment:
 
 #define DEFAULT_REGISTRY_TRANSFER_SIZE 65536
 
+//
+// Number of bulk stages kept in flight per write request. Can be
+// overridden with the BulkPipelineDepth registry value; a depth of 1
+// recirculates the request one stage at a time. Reads always use one stage
+// at a time.
+//
+#define DEFAULT_BULK_PIPELINE_DEPTH 4
+#define MAX_BULK_PIPELINE_DEPTH     16
+
 #define IDLE_CAPS_TYPE IdleUsbSelectiveSuspend
 
 
@@ -108,6 +117,8 @@ typedef struct _DEVICE_CONTEXT {
 
     ULONG                           MaximumTransferSize;
 
+    ULONG                           BulkPipelineDepth;
+
     WDFQUEUE                        IsochReadQueue;
 
     WDFQUEUE                        IsochWriteQueue;
@@ -183,10 +194,55 @@ typedef struct _REQUEST_CONTEXT {
     ULONG             Numxfer;
     ULONG_PTR         VirtualAddress; // va for next segment of xfer.
     BOOLEAN           Read; // TRUE if Read
+
+    //
+    // The fields below are used only when a bulk transfer is split across
+    // several stage requests that are in flight at the same time.
+    //
+    BOOLEAN           Pipelined;
+    LONG              StopStaging;    // no more stages are submitted once set
+    LONG              StagesPending;  // stages in flight + 1 held by dispatch
+    LONG              CancelReferences;
+    NTSTATUS          Status;         // first failure reported by a stage
+    ULONG             TotalLength;
+    ULONG             NextOffset;     // first byte not yet claimed by a stage
+    ULONG             ValidLength;    // contiguous bytes transferred
+    ULONG             StageLength;
+    ULONG             UrbFlags;
+    USBD_PIPE_HANDLE  UsbdPipeHandle;
+    PMDL              RequestMdl;
+    ULONG             StageCount;
+    WDFREQUEST        StageRequests[MAX_BULK_PIPELINE_DEPTH];
+
+    //
+    // Stages are queued in the order they claim their range and sent in
+    // that order by a single sender, so bulk OUT data reaches the device
+    // in order. StageLock protects the claim and the ready queue.
+    //
+    WDFSPINLOCK       StageLock;
+    BOOLEAN           Sending;        // a thread is draining ReadyStages
+    ULONG             ReadyHead;
+    ULONG             ReadyCount;
+    WDFREQUEST        ReadyStages[MAX_BULK_PIPELINE_DEPTH];
 } REQUEST_CONTEXT, * PREQUEST_CONTEXT;
 
 WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(REQUEST_CONTEXT, GetRequestContext)
 
+//
+// This context is associated with every driver created request that
+// carries one stage of a pipelined bulk transfer.
+//
+typedef struct _STAGE_CONTEXT {
+
+    WDFREQUEST        ParentRequest;
+    WDFMEMORY         UrbMemory;
+    PMDL              Mdl;
+    ULONG             Offset;         // offset of this stage in the user buffer
+    ULONG             Length;
+} STAGE_CONTEXT, *PSTAGE_CONTEXT;
+
+WDF_DECLARE_CONTEXT_TYPE_WITH_NAME(STAGE_CONTEXT, GetStageContext)
+
 typedef struct _WORKITEM_CONTEXT {
     WDFDEVICE       Device;
     WDFUSBPIPE      Pipe;
@@ -215,6 +271,12 @@ EVT_WDF_IO_QUEUE_IO_DEVICE_CONTROL UsbSamp_EvtIoDeviceControl;
 EVT_WDF_REQUEST_COMPLETION_ROUTINE UsbSamp_EvtReadWriteCompletion;
 EVT_WDF_REQUEST_COMPLETION_ROUTINE UsbSamp_EvtIsoRequestCompletionRoutine;
 
+#if !defined(BUFFERED_READ_WRITE)
+EVT_WDF_REQUEST_COMPLETION_ROUTINE UsbSamp_EvtBulkStageCompletion;
+EVT_WDF_REQUEST_CANCEL UsbSamp_EvtPipelinedRequestCancel;
+EVT_WDF_OBJECT_CONTEXT_CLEANUP UsbSamp_EvtBulkStageContextCleanup;
+#endif
+
 EVT_WDF_IO_QUEUE_IO_STOP UsbSamp_EvtIoStop;
 
 EVT_WDF_IO_QUEUE_STATE   UsbSamp_EvtIoQueueReadyNotification;
@@ -243,6 +305,42 @@ ReadWriteBulkEndPoints(
     _In_ WDF_REQUEST_TYPE RequestType
     );
 
+#if !defined(BUFFERED_READ_WRITE)
+NTSTATUS
+StartPipelinedBulkTransfer(
+    _In_ PDEVICE_CONTEXT  DeviceContext,
+    _In_ WDFREQUEST       Request,
+    _In_ WDFUSBPIPE       Pipe,
+    _In_ USBD_PIPE_HANDLE UsbdPipeHandle,
+    _In_ PMDL             RequestMdl,
+    _In_ ULONG            UrbFlags,
+    _In_ ULONG            TotalLength,
+    _In_ ULONG            StageLength
+    );
+
+NTSTATUS
+SubmitBulkStage(
+    _In_ WDFREQUEST       Stage,
+    _In_ WDFUSBPIPE       Pipe
+    );
+
+VOID
+SendReadyBulkStages(
+    _In_ WDFREQUEST       Request,
+    _In_ WDFUSBPIPE       Pipe
+    );
+
+VOID
+DereferencePipelinedRequest(
+    _In_ WDFREQUEST       Request
+    );
+
+VOID
+CancelBulkStages(
+    _In_ WDFREQUEST       Request
+    );
+#endif
+
 NTSTATUS
 ResetPipe(
     _In_ WDFUSBPIPE             Pipe
@@ -5123,6 +5123,10 @@ idVendor - USB Vendor ID
 Return Value - Vendor name string associated with idVendor, or NULL if
 no vendor name string is found which is associated with idVendor.
 
+USBVendorIDs[] is sorted by Vendor ID, so the list is binary searched
+rather than walked.  The terminating 0x0000 entry is not part of the
+search and supplies the string for unlisted vendors.
+
 *****************************************************************************/
 
 PCHAR
@@ -5130,25 +5134,35 @@ GetVendorString (
     USHORT     idVendor
     )
 {
-    PVENDOR_ID vendorID = NULL;
+    ULONG low = 0;
+    ULONG high = sizeof(USBVendorIDs) / sizeof(USBVendorIDs[0]) - 1;
+    ULONG mid = 0;
 
     if (idVendor == 0x0000)
     {
         return NULL;
     }
 
-    vendorID = USBVendorIDs;
-
-    while (vendorID->usVendorID != 0x0000)
+    while (low < high)
     {
-        if (vendorID->usVendorID == idVendor)
+        mid = low + (high - low) / 2;
+
+        if (USBVendorIDs[mid].usVendorID == idVendor)
         {
-            break;
+            return (USBVendorIDs[mid].szVendor);
+        }
+
+        if (USBVendorIDs[mid].usVendorID < idVendor)
+        {
+            low = mid + 1;
+        }
+        else
+        {
+            high = mid;
         }
-        vendorID++;
     }
 
-    return (vendorID->szVendor);
+    return (USBVendorIDs[sizeof(USBVendorIDs) / sizeof(USBVendorIDs[0]) - 1].szVendor);
 }
 
 /*****************************************************************************
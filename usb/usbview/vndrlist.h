@@ -47,6 +47,9 @@ typedef struct _VENDOR_ID {
 // This information has not been independently verified and no claims
 // are made here as to its accuracy.
 //
+// The list must stay sorted by Vendor ID, GetVendorString() binary searches
+// it.  The 0x0000 entry terminates the list and must remain last.
+//
 // 10978 total
 //
 VENDOR_ID USBVendorIDs[] =
@@ -195,6 +195,119 @@ BYTE* GetRowStart(_In_ CONST BLT_INFO* pBltInfo, CONST RECT* pRect)
     return pRet;
 }
 
+/****************************Internal*Routine******************************\
+ * CopyRow*
+ *
+ *
+ * Row copiers for CopyBitsGeneric, one per supported dst/src bpp pair, so
+ * the format is decided once per blt rather than once per pixel. The pixel
+ * pitches come from GetPitches and may be negative or a row pitch for the
+ * rotated cases.
+ *
+\**************************************************************************/
+
+typedef VOID (*PFN_COPY_ROW)(
+    BYTE* pDstPixel,
+    LONG DstPixelPitch,
+    CONST BYTE* pSrcPixel,
+    LONG SrcPixelPitch,
+    UINT NumPixels);
+
+VOID CopyRow32_32(BYTE* pDstPixel, LONG DstPixelPitch, CONST BYTE* pSrcPixel, LONG SrcPixelPitch, UINT NumPixels)
+{
+    for (UINT x = 0; x < NumPixels; x++)
+    {
+        *(UINT32*)pDstPixel = *(CONST UINT32*)pSrcPixel;
+        pDstPixel += DstPixelPitch;
+        pSrcPixel += SrcPixelPitch;
+    }
+}
+
+// Used whenever either of dst/src is 24bpp. pPixel[3] is the alpha channel and is ignored for whichever of Src/Dst is 32bpp
+VOID CopyRow24(BYTE* pDstPixel, LONG DstPixelPitch, CONST BYTE* pSrcPixel, LONG SrcPixelPitch, UINT NumPixels)
+{
+    for (UINT x = 0; x < NumPixels; x++)
+    {
+        pDstPixel[0] = pSrcPixel[0];
+        pDstPixel[1] = pSrcPixel[1];
+        pDstPixel[2] = pSrcPixel[2];
+        pDstPixel += DstPixelPitch;
+        pSrcPixel += SrcPixelPitch;
+    }
+}
+
+VOID CopyRow32_16(BYTE* pDstPixel, LONG DstPixelPitch, CONST BYTE* pSrcPixel, LONG SrcPixelPitch, UINT NumPixels)
+{
+    for (UINT x = 0; x < NumPixels; x++)
+    {
+        *(UINT32*)pDstPixel = CONVERT_16BPP_TO_32BPP(*(CONST UINT16*)pSrcPixel);
+        pDstPixel += DstPixelPitch;
+        pSrcPixel += SrcPixelPitch;
+    }
+}
+
+VOID CopyRow16_32(BYTE* pDstPixel, LONG DstPixelPitch, CONST BYTE* pSrcPixel, LONG SrcPixelPitch, UINT NumPixels)
+{
+    for (UINT x = 0; x < NumPixels; x++)
+    {
+        *(UINT16*)pDstPixel = (UINT16)CONVERT_32BPP_TO_16BPP(pSrcPixel);
+        pDstPixel += DstPixelPitch;
+        pSrcPixel += SrcPixelPitch;
+    }
+}
+
+VOID CopyRow8_32(BYTE* pDstPixel, LONG DstPixelPitch, CONST BYTE* pSrcPixel, LONG SrcPixelPitch, UINT NumPixels)
+{
+    for (UINT x = 0; x < NumPixels; x++)
+    {
+        *pDstPixel = (BYTE)CONVERT_32BPP_TO_8BPP(pSrcPixel);
+        pDstPixel += DstPixelPitch;
+        pSrcPixel += SrcPixelPitch;
+    }
+}
+
+PFN_COPY_ROW GetCopyRow(UINT DstBitsPerPel, UINT SrcBitsPerPel)
+{
+    if ((DstBitsPerPel == 24) ||
+        (SrcBitsPerPel == 24))
+    {
+        return CopyRow24;
+    }
+    else if (DstBitsPerPel == 32)
+    {
+        if (SrcBitsPerPel == 32)
+        {
+            return CopyRow32_32;
+        }
+        else if (SrcBitsPerPel == 16)
+        {
+            return CopyRow32_16;
+        }
+        else
+        {
+            // Invalid SrcBitsPerPel on a DstBitsPerPel of 32
+            NT_ASSERT(FALSE);
+        }
+    }
+    else if (DstBitsPerPel == 16)
+    {
+        NT_ASSERT(SrcBitsPerPel == 32);
+        return CopyRow16_32;
+    }
+    else if (DstBitsPerPel == 8)
+    {
+        NT_ASSERT(SrcBitsPerPel == 32);
+        return CopyRow8_32;
+    }
+    else
+    {
+        // Invalid DstBitsPerPel
+        NT_ASSERT(FALSE);
+    }
+
+    return NULL;
+}
+
 /****************************Internal*Routine******************************\
  * CopyBitsGeneric
  *
@@ -210,6 +323,10 @@ BYTE* GetRowStart(_In_ CONST BLT_INFO* pBltInfo, CONST RECT* pRect)
  *     8 | 32
  *    24 | 24   // untested
  *
+ * When dst and src have the same bpp and walk their rows in the same
+ * direction (e.g. both are rotated by 180), every row is a contiguous span
+ * in both surfaces and is copied with RtlCopyMemory.
+ *
 \**************************************************************************/
 
 VOID CopyBitsGeneric(
@@ -226,6 +343,17 @@ VOID CopyBitsGeneric(
     GetPitches(pDst, &DstPixelPitch, &DstRowPitch);
     GetPitches(pSrc, &SrcPixelPitch, &SrcRowPitch);
 
+    PFN_COPY_ROW pfnCopyRow = GetCopyRow(pDst->BitsPerPel, pSrc->BitsPerPel);
+    if (pfnCopyRow == NULL)
+    {
+        return;
+    }
+
+    LONG BytesPerPixel = (LONG)(pSrc->BitsPerPel / BITS_PER_BYTE);
+    BOOLEAN ContiguousRows = (pDst->BitsPerPel == pSrc->BitsPerPel) &&
+                             (DstPixelPitch == SrcPixelPitch) &&
+                             ((DstPixelPitch == BytesPerPixel) || (DstPixelPitch == -BytesPerPixel));
+
     for (UINT iRect = 0; iRect < NumRects; iRect++)
     {
         CONST RECT* pRect = &pRects[iRect];
@@ -239,64 +367,28 @@ VOID CopyBitsGeneric(
         BYTE* pDstRow = GetRowStart(pDst, pRect);
         CONST BYTE* pSrcRow = GetRowStart(pSrc, pRect);
 
-        for (UINT y=0; y < NumRows; y++)
+        if (ContiguousRows && (NumPixels > 0))
         {
-            BYTE* pDstPixel = pDstRow;
-            CONST BYTE* pSrcPixel = pSrcRow;
+            SIZE_T BytesToCopy = (SIZE_T)NumPixels * BytesPerPixel;
+
+            // For a negative pixel pitch the row starts at its last pixel in memory
+            LONG_PTR SpanOffset = (DstPixelPitch < 0) ? -(LONG_PTR)(NumPixels - 1) * BytesPerPixel : 0;
 
-            for (UINT x=0; x < NumPixels; x++)
+            for (UINT y=0; y < NumRows; y++)
             {
-                if ((pDst->BitsPerPel == 24) ||
-                    (pSrc->BitsPerPel == 24))
-                {
-                    pDstPixel[0] = pSrcPixel[0];
-                    pDstPixel[1] = pSrcPixel[1];
-                    pDstPixel[2] = pSrcPixel[2];
-                    // pPixel[3] is the alpha channel and is ignored for whichever of Src/Dst is 32bpp
-                }
-                else if (pDst->BitsPerPel == 32)
-                {
-                    if (pSrc->BitsPerPel == 32)
-                    {
-                        UINT32* pDstPixelAs32 = (UINT32*)pDstPixel;
-                        UINT32* pSrcPixelAs32 = (UINT32*)pSrcPixel;
-                        *pDstPixelAs32 = *pSrcPixelAs32;
-                    }
-                    else if (pSrc->BitsPerPel == 16)
-                    {
-                        UINT32* pDstPixelAs32 = (UINT32*)pDstPixel;
-                        UINT16* pSrcPixelAs16 = (UINT16*)pSrcPixel;
-
-                        *pDstPixelAs32 = CONVERT_16BPP_TO_32BPP(*pSrcPixelAs16);
-                    }
-                    else
-                    {
-                        // Invalid pSrc->BitsPerPel on a pDst->BitsPerPel of 32
-                        NT_ASSERT(FALSE);
-                    }
-                }
-                else if (pDst->BitsPerPel == 16)
-                {
-                    NT_ASSERT(pSrc->BitsPerPel == 32);
-
-                    UINT16* pDstPixelAs16 = (UINT16*)pDstPixel;
-                    *pDstPixelAs16 = CONVERT_32BPP_TO_16BPP(pSrcPixel);
-                }
-                else if (pDst->BitsPerPel == 8)
-                {
-                    NT_ASSERT(pSrc->BitsPerPel == 32);
-
-                    *pDstPixel = CONVERT_32BPP_TO_8BPP(pSrcPixel);
-                }
-                else
-                {
-                    // Invalid pDst->BitsPerPel
-                    NT_ASSERT(FALSE);
-                }
-                pDstPixel += DstPixelPitch;
-                pSrcPixel += SrcPixelPitch;
+                RtlCopyMemory(pDstRow + SpanOffset, pSrcRow + SpanOffset, BytesToCopy);
+
+                pDstRow += DstRowPitch;
+                pSrcRow += SrcRowPitch;
             }
 
+            continue;
+        }
+
+        for (UINT y=0; y < NumRows; y++)
+        {
+            pfnCopyRow(pDstRow, DstPixelPitch, pSrcRow, SrcPixelPitch, NumPixels);
+
             pDstRow += DstRowPitch;
             pSrcRow += SrcRowPitch;
         }